@@ -1,10 +1,96 @@
 {
+    "variables": {
+        "engine_sources": [
+            "./src/stft.c", 
+            "./src/xtime.c", 
+            "./src/biquad.c", 
+            "./src/threads.c",
+            "./src/wavFile.c", 
+            "./src/autosave.c", 
+            "./src/engine.c", 
+            "./src/simulator.c", 
+            "./src/generator.c",
+            "./src/resampler.c",
+            "./src/heterodyne.c",
+            "./src/frequencyDivider.c",
+            "./src/trigger.c",
+            "./src/prefilter.c",
+            "./src/timing.c",
+            "./src/timestamps.c",
+            "./src/schedule.c"
+        ]
+    },
     "targets": [{
         "target_name": "backstage",
         "include_dirs": [ 
             "./inc/", 
             "./miniaudio"
         ],
+        "sources": [ 
+            "<@(engine_sources)",
+            "./src/backstage.c"
+        ]
+    }, {
+        "target_name": "backstage_daemon",
+        "type": "executable",
+        "variables": {
+            "win_delay_load_hook": "false"
+        },
+        "include_dirs": [ 
+            "./inc/", 
+            "./miniaudio"
+        ],
+        "sources": [ 
+            "<@(engine_sources)",
+            "./src/daemon.c"
+        ],
+        "conditions": [
+            ["OS=='linux'", {
+                "libraries": [ "-lpthread", "-lm", "-ldl" ]
+            }],
+            ["OS=='mac'", {
+                "libraries": [ 
+                    "-framework CoreFoundation", 
+                    "-framework CoreAudio", 
+                    "-framework AudioToolbox" 
+                ]
+            }]
+        ]
+    }, {
+        "target_name": "backstage_test",
+        "type": "executable",
+        "variables": {
+            "win_delay_load_hook": "false"
+        },
+        "include_dirs": [ 
+            "./inc/", 
+            "./miniaudio"
+        ],
+        "sources": [ 
+            "<@(engine_sources)",
+            "./src/test.c"
+        ],
+        "conditions": [
+            ["OS=='linux'", {
+                "libraries": [ "-lpthread", "-lm", "-ldl" ]
+            }],
+            ["OS=='mac'", {
+                "libraries": [ 
+                    "-framework CoreFoundation", 
+                    "-framework CoreAudio", 
+                    "-framework AudioToolbox" 
+                ]
+            }]
+        ]
+    }, {
+        "target_name": "backstage_benchmark",
+        "type": "executable",
+        "variables": {
+            "win_delay_load_hook": "false"
+        },
+        "include_dirs": [ 
+            "./inc/"
+        ],
         "sources": [ 
             "./src/stft.c", 
             "./src/xtime.c", 
@@ -12,9 +98,16 @@
             "./src/threads.c",
             "./src/wavFile.c", 
             "./src/autosave.c", 
-            "./src/backstage.c", 
-            "./src/simulator.c", 
-            "./src/heterodyne.c"
+            "./src/resampler.c",
+            "./src/heterodyne.c",
+            "./src/frequencyDivider.c",
+            "./src/prefilter.c",
+            "./src/benchmark.c"
+        ],
+        "conditions": [
+            ["OS=='linux'", {
+                "libraries": [ "-lpthread", "-lm" ]
+            }]
         ]
     }]
 }
@@ -12,16 +12,17 @@
 
 #define DEVICE_NAME_SIZE    1024
 
-typedef enum {AS_START, AS_RESTART, AS_STOP, AS_SHUTDOWN} AS_event_type_t;
+typedef enum {AS_START, AS_RESTART, AS_STOP, AS_SHUTDOWN, AS_TRIGGER_START, AS_TRIGGER_STOP} AS_event_type_t;
 
 typedef struct {
     AS_event_type_t type;
     int32_t sampleRate;
     int32_t currentIndex;
+    int32_t deviceNameID;
     int64_t currentCount;
     int64_t startTime;
     int64_t startCount;
-    char inputDeviceCommentName[DEVICE_NAME_SIZE];
+    int64_t triggerStartCount;
 } AS_event_t;
 
 bool Autosave_initialise(int32_t number);
@@ -32,4 +33,8 @@ bool Autosave_getFirstEvent(AS_event_t *event);
 
 bool Autosave_addEvent(AS_event_t *event);
 
-#endif /* __AUTOSAVE_H */
\ No newline at end of file
+int32_t Autosave_internDeviceName(char *deviceName);
+
+bool Autosave_getDeviceName(int32_t deviceNameID, char *deviceName);
+
+#endif /* __AUTOSAVE_H */
@@ -8,6 +8,9 @@
 #define __BIQUAD_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#define BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS   8
 
 typedef struct {
     double xv[3];
@@ -22,6 +25,17 @@ typedef struct {
     double A2_A0;
 } BQ_filterCoefficients_t;
 
+typedef struct {
+    int32_t numberOfSections;
+    float b0[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+    float b1[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+    float b2[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+    float a1[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+    float a2[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+    float s1[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+    float s2[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+} BQ_cascade_t;
+
 /* Public functions */
 
 void Biquad_designLowPassFilter(BQ_filterCoefficients_t *coefficients, uint32_t sampleRate, uint32_t frequency, double bandwidth);
@@ -36,4 +50,14 @@ void Biquad_initialise(BQ_filter_t *filter);
 
 double Biquad_applyFilter(double sample, BQ_filter_t *filter, BQ_filterCoefficients_t *filterCoefficients);
 
+void Biquad_initialiseCascade(BQ_cascade_t *cascade);
+
+bool Biquad_addSection(BQ_cascade_t *cascade, BQ_filterCoefficients_t *filterCoefficients);
+
+void Biquad_resetCascade(BQ_cascade_t *cascade);
+
+void Biquad_applyCascade(BQ_cascade_t *cascade, const float *input, int32_t numberOfSamples, float *output);
+
+void Biquad_applyCascadeInt16(BQ_cascade_t *cascade, const int16_t *input, int32_t numberOfSamples, int16_t *output);
+
 #endif /* __BIQUAD_H */
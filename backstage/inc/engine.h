@@ -0,0 +1,167 @@
+/****************************************************************************
+ * engine.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __ENGINE_H
+#define __ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "generator.h"
+
+/* Buffer constants */
+
+#define AUDIO_BUFFER_SIZE                   (1 << 25)
+#define STFT_INPUT_OUTPUT_RATIO             2
+#define STFT_BUFFER_SIZE                    (AUDIO_BUFFER_SIZE / STFT_INPUT_OUTPUT_RATIO)
+
+#define FILEPATH_SIZE                       8192
+
+/* Autosave constants. Segments are limited to a minute at the highest sample rate so they fit well inside the audio buffer, and to at least one capture callback at that rate so each callback completes no more than one segment */
+
+#define MINIMUM_SEGMENT_LENGTH              (384000 / 100)
+#define MAXIMUM_SEGMENT_LENGTH              (60 * 384000)
+
+/* Trigger constants. Pre- and post-trigger periods are limited in milliseconds so a maximum length segment plus either period still fits in the audio buffer at the highest sample rate, with a second to spare for the STFT block and file writing */
+
+#define MAXIMUM_TRIGGER_PERIOD              (1000 * ((AUDIO_BUFFER_SIZE - MAXIMUM_SEGMENT_LENGTH) / 384000 - 1))
+
+/* Backend constants. The virtual backend replaces the audio devices with timer-paced null devices */
+
+#define BACKEND_SYSTEM                      0
+#define BACKEND_VIRTUAL                     1
+
+/* Monitor constants */
+
+#define MONITOR_OFF                         0
+#define MONITOR_PLAYTHROUGH                 1
+#define MONITOR_HETERODYNE                  2
+#define MONITOR_FREQUENCY_DIVISION          3
+
+#define DEFAULT_HETERODYNE_FREQUENCY        45000
+#define DEFAULT_FREQUENCY_DIVISION          10
+
+/* Schedule constants */
+
+#define SCHEDULE_OFF                        0
+#define SCHEDULE_DUTY_CYCLE                 1
+#define SCHEDULE_WINDOWS                    2
+
+/* Frame structure. The review position is negative when not reviewing */
+
+typedef struct {
+    bool redrawRequired;
+    bool simulationRunning;
+    bool offlineComplete;
+    bool oldAudioMothFound;
+    bool triggered;
+    bool processingSuspended;
+    double reviewPosition;
+    char *deviceName;
+    int32_t maximumSampleRate;
+    int32_t currentSampleRate;
+    int64_t audioTime;
+    int32_t audioIndex;
+    int64_t audioCount;
+} EN_frame_t;
+
+/* Pause structure. The audio details are only set while paused */
+
+typedef struct {
+    bool paused;
+    int64_t audioStartTime;
+    int32_t audioIndex;
+    int64_t audioCount;
+} EN_pause_t;
+
+/* Statistics structure. Latencies are negative until measured and the simulation figures are only valid while the matching mode is running */
+
+typedef struct {
+    bool lowLatency;
+    bool exclusiveMode;
+    double capturePeriod;
+    double playbackBuffer;
+    double playbackLag;
+    double targetPlaybackLag;
+    double driftAdjustment;
+    double clockDrift;
+    bool simulationJitterValid;
+    double simulationJitter;
+    double simulationMaximumJitter;
+    bool offlineThroughputValid;
+    double offlineThroughput;
+    int64_t offlineSamplesProcessed;
+    double estimatedLatency;
+    double loopbackLatency;
+    double monitorLatency;
+    double deviceRestartLatency;
+} EN_stats_t;
+
+/* Public functions */
+
+bool Engine_initialise(int16_t *audioBuffer, float *stftBuffer, int32_t backend);
+
+void Engine_changeSampleRate(int32_t sampleRate);
+
+void Engine_getFrame(EN_frame_t *frame);
+
+void Engine_clear(void);
+
+void Engine_capture(int32_t duration, void (*callback)(bool success));
+
+void Engine_setPause(bool enable, int32_t duration, EN_pause_t *pause);
+
+bool Engine_setReview(bool enable, int32_t expansion, double startTime, double stopTime);
+
+void Engine_setFileDestination(char *destination);
+
+void Engine_setAutoSaveCallback(void (*callback)(void));
+
+void Engine_setAutoSave(int32_t duration, int32_t segmentLength);
+
+void Engine_setTrigger(bool enable, int32_t minimumFrequency, int32_t maximumFrequency, double threshold, double hysteresis, int32_t preTrigger, int32_t postTrigger);
+
+void Engine_setDutyCycleSchedule(int32_t recordDuration, int32_t period, bool suspend);
+
+void Engine_setWindowSchedule(int32_t numberOfWindows, int32_t *startMinutes, int32_t *stopMinutes, bool suspend);
+
+void Engine_clearSchedule(void);
+
+void Engine_setFilter(int32_t type, int32_t frequency1, int32_t frequency2);
+
+void Engine_setSimulationPath(char *path);
+
+bool Engine_startSimulationExample(int32_t index);
+
+void Engine_clearSimulationPlaylist(void);
+
+bool Engine_addToSimulationPlaylist(char *filename);
+
+bool Engine_startSimulationPlaylist(bool offline, double startTime);
+
+bool Engine_startGenerator(GN_settings_t *settings, bool offline, double startTime);
+
+void Engine_stopSimulation(void);
+
+void Engine_setMonitor(int32_t mode, int32_t numberOfChannels, int32_t *frequencies, float *pans, int32_t division);
+
+void Engine_setHighDefaultSampleRate(bool enable);
+
+void Engine_setLocalTime(bool enable);
+
+void Engine_forceAutoSaveToStop(void);
+
+void Engine_setLowLatency(bool enable, bool exclusive);
+
+bool Engine_measureLatency(void);
+
+void Engine_getStats(EN_stats_t *stats);
+
+bool Engine_setVirtualAudioMoth(bool connected, int32_t sampleRate);
+
+bool Engine_writePlaybackSink(char *filename);
+
+#endif /* __ENGINE_H */
@@ -0,0 +1,16 @@
+/****************************************************************************
+ * frequencyDivider.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __FREQUENCY_DIVIDER_H
+#define __FREQUENCY_DIVIDER_H
+
+#include <stdint.h>
+
+void FrequencyDivider_initialise(void);
+
+void FrequencyDivider_processBlock(float *input, int32_t numberOfSamples, int32_t sampleRate, int32_t division, int32_t decimation, float *output);
+
+#endif /* __FREQUENCY_DIVIDER_H */
@@ -0,0 +1,49 @@
+/****************************************************************************
+ * generator.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __GENERATOR_H
+#define __GENERATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GN_SINE                         0
+#define GN_CHIRP                        1
+#define GN_BAT_CALL                     2
+#define GN_WHITE_NOISE                  3
+#define GN_PINK_NOISE                   4
+#define GN_IMPULSE                      5
+
+#define NUMBER_OF_GENERATOR_SIGNALS     6
+
+/* Generator settings. Frequencies of zero select the defaults for the signal and a duration of zero runs indefinitely */
+
+typedef struct {
+    int32_t signal;
+    int32_t sampleRate;
+    int32_t frequency1;
+    int32_t frequency2;
+    double level;
+    double duration;
+} GN_settings_t;
+
+char* Generator_getName(int32_t signal);
+
+bool Generator_findSignal(char *name, int32_t *signal);
+
+bool Generator_isValid(GN_settings_t *settings);
+
+void Generator_configure(GN_settings_t *settings);
+
+void Generator_restart(void);
+
+int32_t Generator_getSampleRate(void);
+
+bool Generator_isFinished(void);
+
+int32_t Generator_read(int16_t *destination, int32_t numberOfFrames);
+
+#endif /* __GENERATOR_H */
@@ -8,13 +8,20 @@
 #define __HETERO_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#define HETERODYNE_MAXIMUM_CHANNELS     4
 
 void Heterodyne_initialise(int32_t sampleRate, int32_t frequency);
 
 void Heterodyne_updateFrequencies(int32_t sampleRate, int32_t frequency);
 
+void Heterodyne_updateChannels(int32_t sampleRate, int32_t numberOfChannels, int32_t *frequencies);
+
 double Heterodyne_nextOutput(double sample);
 
 void Heterodyne_normalise(void);
 
+void Heterodyne_processBlock(float *input, int32_t numberOfSamples, int32_t decimation, float *output);
+
 #endif /* __HETERO_H */
\ No newline at end of file
@@ -0,0 +1,26 @@
+/****************************************************************************
+ * prefilter.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __PREFILTER_H
+#define __PREFILTER_H
+
+#include <stdint.h>
+
+#define PF_NONE                 0
+#define PF_LOW_PASS             1
+#define PF_HIGH_PASS            2
+#define PF_BAND_PASS            3
+#define PF_NOTCH                4
+
+void Prefilter_initialise(void);
+
+void Prefilter_configure(int32_t type, int32_t frequency1, int32_t frequency2);
+
+void Prefilter_reset(void);
+
+void Prefilter_processBlock(int16_t *samples, int32_t numberOfSamples, int32_t sampleRate);
+
+#endif /* __PREFILTER_H */
@@ -0,0 +1,60 @@
+/****************************************************************************
+ * resampler.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __RESAMPLER_H
+#define __RESAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MAXIMUM_NUMBER_OF_RESAMPLER_TAPS    256
+
+typedef struct {
+    int32_t inputSampleRate;
+    int32_t outputSampleRate;
+    int32_t upsample;
+    int32_t downsample;
+    int32_t numberOfTaps;
+    const float *bank;
+    int32_t position;
+    int32_t historyIndex;
+    double adjustment;
+    double fraction;
+    float history[2 * MAXIMUM_NUMBER_OF_RESAMPLER_TAPS];
+} RS_resampler_t;
+
+/* Capture resampler which linearly interpolates to a multiple of the output rate and averages each group of interpolated samples */
+
+typedef struct {
+    int32_t divider;
+    double step;
+    int32_t counter;
+    double position;
+    double currentSample;
+    double nextSample;
+    double accumulator;
+    bool advancePending;
+} RS_captureResampler_t;
+
+/* Public functions */
+
+bool Resampler_designFilterBanks(int32_t *inputSampleRates, int32_t numberOfInputSampleRates, int32_t outputSampleRate);
+
+bool Resampler_initialise(RS_resampler_t *resampler, int32_t inputSampleRate, int32_t outputSampleRate, bool adjustable);
+
+int32_t Resampler_getNumberOfInputSamples(RS_resampler_t *resampler, int32_t numberOfOutputSamples);
+
+void Resampler_setAdjustment(RS_resampler_t *resampler, double adjustment);
+
+void Resampler_process(RS_resampler_t *resampler, const float *input, int32_t numberOfOutputSamples, float *output);
+
+void Resampler_initialiseCapture(RS_captureResampler_t *resampler, int32_t inputSampleRate, int32_t outputSampleRate);
+
+void Resampler_setCaptureSampleRates(RS_captureResampler_t *resampler, int32_t inputSampleRate, int32_t outputSampleRate);
+
+int32_t Resampler_processCapture(RS_captureResampler_t *resampler, const int16_t *input, int32_t numberOfInputSamples, int32_t maximumNumberOfOutputSamples, int16_t *output, int32_t *numberOfInputSamplesUsed);
+
+#endif /* __RESAMPLER_H */
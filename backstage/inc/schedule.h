@@ -0,0 +1,29 @@
+/****************************************************************************
+ * schedule.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __SCHEDULE_H
+#define __SCHEDULE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MAXIMUM_NUMBER_OF_WINDOWS       8
+
+void Schedule_initialise(void);
+
+void Schedule_clear(void);
+
+void Schedule_setDutyCycle(int32_t recordDuration, int32_t period);
+
+void Schedule_setWindows(int32_t numberOfWindows, int32_t *startMinutes, int32_t *stopMinutes);
+
+bool Schedule_isEnabled(void);
+
+bool Schedule_isActive(int64_t time);
+
+int64_t Schedule_getSecondsUntilTransition(int64_t time);
+
+#endif /* __SCHEDULE_H */
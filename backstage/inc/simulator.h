@@ -10,17 +10,31 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "generator.h"
+
 #define NUMBER_OF_SIMULATION_EXAMPLES   1
 
-int32_t Simulator_getSampleRate(int32_t index);
+#define MAXIMUM_PLAYLIST_LENGTH         64
+
+int32_t Simulator_getSampleRate(void);
 
 char* Simulator_getDescription(int32_t index);
 
 bool Simulator_loadExample(int32_t index);
 
-void Simulator_initialiseExample();
+void Simulator_clearPlaylist(void);
+
+bool Simulator_addToPlaylist(char *filename);
+
+bool Simulator_loadGenerator(GN_settings_t *settings);
+
+void Simulator_setLooping(bool looping);
+
+bool Simulator_isFinished(void);
+
+void Simulator_initialiseExample(void);
 
-int16_t Simulator_nextSample(void);
+int32_t Simulator_read(int16_t *destination, int32_t numberOfFrames);
 
 void Simulator_setPath(char *path);
 
@@ -10,6 +10,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define STFT_INPUT_SAMPLES      512
+
 void STFT_initialise(void);
 
 void STFT_transform(int16_t *audio, int32_t audioOffset, float *stft, int32_t stftOffset);
@@ -7,14 +7,19 @@
 #ifndef __THREADS_H
 #define __THREADS_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #if defined(_WIN32) || defined(_WIN64)
 
     #include <stdlib.h>
     #include <windows.h>
 
     typedef CRITICAL_SECTION pthread_mutex_t;
+    typedef CONDITION_VARIABLE pthread_cond_t;
     typedef void pthread_attr_t;
     typedef void pthread_mutexattr_t;
+    typedef void pthread_condattr_t;
     typedef HANDLE pthread_t;
 
     int pthread_create(pthread_t *thread, pthread_attr_t *attr, void *(*start_routine)(void *), void *arg);
@@ -28,9 +33,71 @@
     int pthread_mutex_lock(pthread_mutex_t *mutex);
     int pthread_mutex_unlock(pthread_mutex_t *mutex);
 
+    int pthread_cond_init(pthread_cond_t *cond, pthread_condattr_t *attr);
+    int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+    int pthread_cond_signal(pthread_cond_t *cond);
+
+    static inline uint32_t Atomic_load32(volatile uint32_t *value) {
+        return (uint32_t)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+    }
+
+    static inline void Atomic_store32(volatile uint32_t *value, uint32_t newValue) {
+        InterlockedExchange((volatile LONG*)value, (LONG)newValue);
+    }
+
+    static inline bool Atomic_compareExchange32(volatile uint32_t *value, uint32_t expected, uint32_t newValue) {
+        return (uint32_t)InterlockedCompareExchange((volatile LONG*)value, (LONG)newValue, (LONG)expected) == expected;
+    }
+
+    static inline int64_t Atomic_load64(volatile int64_t *value) {
+        return InterlockedCompareExchange64(value, 0, 0);
+    }
+
+    static inline void Atomic_store64(volatile int64_t *value, int64_t newValue) {
+        InterlockedExchange64(value, newValue);
+    }
+
+    static inline void Atomic_releaseFence(void) {
+        MemoryBarrier();
+    }
+
+    static inline void Atomic_acquireFence(void) {
+        MemoryBarrier();
+    }
+
 #else
 
     #include <pthread.h>
+
+    static inline uint32_t Atomic_load32(volatile uint32_t *value) {
+        return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+    }
+
+    static inline void Atomic_store32(volatile uint32_t *value, uint32_t newValue) {
+        __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+    }
+
+    static inline bool Atomic_compareExchange32(volatile uint32_t *value, uint32_t expected, uint32_t newValue) {
+        return __atomic_compare_exchange_n(value, &expected, newValue, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+
+    static inline int64_t Atomic_load64(volatile int64_t *value) {
+        return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+    }
+
+    static inline void Atomic_store64(volatile int64_t *value, int64_t newValue) {
+        __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+    }
+
+    /* Fences order the plain data accesses on either side of a sequence counter update or check */
+
+    static inline void Atomic_releaseFence(void) {
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    static inline void Atomic_acquireFence(void) {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    }
     
 #endif
 
@@ -0,0 +1,21 @@
+/****************************************************************************
+ * timestamps.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __TIMESTAMPS_H
+#define __TIMESTAMPS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void Timestamps_initialise(void);
+
+void Timestamps_addBlock(int32_t bufferIndex, int64_t sampleCount, int32_t sampleRate, int64_t monotonicTime, int64_t utcTime);
+
+bool Timestamps_getTimeOfIndex(int32_t bufferIndex, int64_t *utcTime);
+
+bool Timestamps_getTimeOfCount(int64_t sampleCount, int64_t *utcTime);
+
+#endif /* __TIMESTAMPS_H */
@@ -0,0 +1,25 @@
+/****************************************************************************
+ * timing.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __TIMING_H
+#define __TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void Timing_reset(int32_t sampleRate);
+
+void Timing_addObservation(int32_t numberOfFrames, int64_t monotonicMicroseconds);
+
+bool Timing_getFrameTime(int32_t framesBeforeLatest, int64_t *monotonicMicroseconds);
+
+bool Timing_isDiscontinuous(void);
+
+double Timing_getRateError(void);
+
+int64_t Timing_samplesToMilliseconds(int64_t numberOfSamples, int32_t sampleRate);
+
+#endif /* __TIMING_H */
@@ -0,0 +1,34 @@
+/****************************************************************************
+ * trigger.h
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#ifndef __TRIGGER_H
+#define __TRIGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TR_NONE                 0
+#define TR_SEGMENT_STARTED      1
+#define TR_SEGMENT_STOPPED      2
+
+typedef struct {
+    int64_t startCount;
+    int64_t stopCount;
+} TR_segment_t;
+
+void Trigger_initialise(void);
+
+void Trigger_configure(bool enabled, int32_t minimumFrequency, int32_t maximumFrequency, double threshold, double hysteresis, int32_t preTrigger, int32_t postTrigger);
+
+bool Trigger_isEnabled(void);
+
+bool Trigger_isTriggered(void);
+
+int32_t Trigger_processFrame(float *stft, int32_t sampleRate, int64_t frameStopCount, TR_segment_t *segment);
+
+int32_t Trigger_flush(int64_t stopCount, TR_segment_t *segment);
+
+#endif /* __TRIGGER_H */
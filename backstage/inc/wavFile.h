@@ -59,6 +59,8 @@ void WavFile_initialiseHeader(WAV_header_t *header);
 
 void WavFile_setHeaderDetails(WAV_header_t *header, uint32_t sampleRate, uint32_t numberOfSamples);
 
+void WavFile_setHeaderChannels(WAV_header_t *header, uint16_t numberOfChannels);
+
 void WavFile_setHeaderComment(WAV_header_t *header, int32_t currentTime, int32_t milliseconds, int32_t timeOffset, char *deviceName);
 
 void WavFile_setFilename(char *filename, int32_t currentTime,int32_t milliseconds, char *fileDestination);
@@ -14,8 +14,18 @@ uint32_t Time_getMicroseconds(void);
 
 int64_t Time_getMillisecondUTC(void);
 
+int64_t Time_getMicrosecondUTC(void);
+
+int64_t Time_getMonotonicMicroseconds(void);
+
+int64_t Time_getMonotonicNanoseconds(void);
+
+void Time_sleepUntilMonotonicMicroseconds(int64_t deadline);
+
 void Time_gmTime(const time_t *timer, struct tm *buf);
 
 int32_t Time_getLocalTimeOffset(void);
 
+void Time_invalidateLocalTimeOffset(void);
+
 #endif /* __XTIME_H */
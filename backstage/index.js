@@ -2,6 +2,7 @@ const backstage = require('./build/Release/backstage');
 
 /**
  * Initialise backstage
+ * @param {boolean} virtualBackend Whether to replace the audio devices with timer-paced null devices, for running without a sound card
  * @returns {Int16Array} audioBuffer - Typed array containing audio samples
  * @returns {Float64Array} stftBuffer - Typed array containing STFT results
  * @returns {boolean} success - Did the initialisation succeed
@@ -9,6 +10,7 @@ const backstage = require('./build/Release/backstage');
 exports.initialise = backstage.initialise;
 
 /**
+ * Change the capture sample rate. The switch happens at the next frame boundary without restarting the input device
  * @param {number} sampleRate The sample rate in Hertz
  */
 exports.changeSampleRate = backstage.changeSampleRate;
@@ -23,6 +25,9 @@ exports.changeSampleRate = backstage.changeSampleRate;
  * @returns {number} audioTime - Local time in milliseconds of the last sample
  * @returns {number} audioIndex - Index of the next sample to be collected
  * @returns {number} audioCount - How many samples have been collected last start
+ * @returns {boolean} triggered - Whether the band level is currently above the trigger threshold
+ * @returns {boolean} processingSuspended - Whether analysis is suspended outside the recording schedule
+ * @returns {number} reviewPosition - Review playback position in milliseconds from the start of the paused audio, or null when not reviewing
  */
 exports.getFrame = backstage.getFrame;
 
@@ -48,6 +53,16 @@ exports.capture = backstage.capture;
  */
 exports.setPause = backstage.setPause;
 
+/**
+ * Play back a selection of the paused audio
+ * @param {boolean} enable Whether to start or stop review playback
+ * @param {number} expansion Time expansion factor (1, 10 or 20)
+ * @param {number} startTime Start of the selection in milliseconds from the start of the paused audio
+ * @param {number} stopTime End of the selection in milliseconds from the start of the paused audio, or zero for the end
+ * @returns {boolean} Success or failure
+ */
+exports.setReview = backstage.setReview;
+
 /**
  * Set the destination folder for WAV files
  * @param {string} destination The folder where capture and autosave WAV files will be saved
@@ -56,16 +71,56 @@ exports.setFileDestination = backstage.setFileDestination;
 
 /**
  * Set the callback for receiving failure alerts for auto saved WAV files
- * @param {function} callback Callback is called when a autosave error occurs
+ * @param {function} callback Callback is called when a autosave error occurs, including events lost because the autosave queue was full
  */
 exports.setAutoSaveCallback = backstage.setAutoSaveCallback;
 
 /**
  * Set the maximum duration of auto saved WAV files
  * @param {number} duration How many minutes to make each autosave file
+ * @param {number} segmentLength Optional number of samples in each autosave file. Files are cut at exact sample counts rather than on the minute and lengths are kept between 3840 and 23040000
  */
 exports.setAutoSave = backstage.setAutoSave;
 
+/**
+ * Set triggered recording. When enabled, autosave only writes segments where the band level exceeds the threshold
+ * @param {boolean} enable Whether triggered recording is enabled
+ * @param {number} minimumFrequency Lower edge of the trigger band in Hertz
+ * @param {number} maximumFrequency Upper edge of the trigger band in Hertz
+ * @param {number} threshold Band level in decibels which starts a segment
+ * @param {number} hysteresis How many decibels below the threshold the level must fall before the segment ends
+ * @param {number} preTrigger Milliseconds of audio to include before the trigger, kept between 0 and 26000
+ * @param {number} postTrigger Milliseconds of audio to include after the level falls, kept between 0 and 26000
+ */
+exports.setTrigger = backstage.setTrigger;
+
+/**
+ * Set the autosave recording schedule. Files are only written inside the schedule. Windows may cross midnight, a window which starts where it stops is empty and is ignored, and an empty array of windows clears the schedule
+ * @param {number} mode Which schedule to use (SCHEDULE_OFF, SCHEDULE_DUTY_CYCLE, SCHEDULE_WINDOWS)
+ * @param {number|array} recordDuration Seconds to record each period, or the start of each window in minutes after midnight
+ * @param {number|array} period Period in minutes, or the end of each window in minutes after midnight
+ * @param {boolean} suspendProcessing Whether to suspend STFT and rendering outside the schedule
+ */
+exports.setSchedule = backstage.setSchedule;
+
+exports.SCHEDULE_OFF = 0;
+exports.SCHEDULE_DUTY_CYCLE = 1;
+exports.SCHEDULE_WINDOWS = 2;
+
+/**
+ * Set the filter applied to captured audio before it is analysed, monitored or autosaved
+ * @param {number} type Which filter to use (FILTER_OFF, FILTER_LOW_PASS, FILTER_HIGH_PASS, FILTER_BAND_PASS, FILTER_NOTCH)
+ * @param {number} frequency1 Cut-off frequency in Hertz, or lower edge of the band for band pass and notch filters
+ * @param {number} frequency2 Upper edge of the band for band pass and notch filters
+ */
+exports.setFilter = backstage.setFilter;
+
+exports.FILTER_OFF = 0;
+exports.FILTER_LOW_PASS = 1;
+exports.FILTER_HIGH_PASS = 2;
+exports.FILTER_BAND_PASS = 3;
+exports.FILTER_NOTCH = 4;
+
 /**
  * Get information on the examples supported by the simulator
  * @returns {array} descriptions Description of each example
@@ -75,21 +130,25 @@ exports.getSimulationInfo = backstage.getSimulationInfo;
 /**
  * Set simulation mode
  * @param {boolean} enable Whether simulation is enabled
- * @param {number} index Which simulation to enable
+ * @param {number|array|object} index Which example to simulate, an array of paths to mono or stereo 16-bit WAV files to play in turn, or generator settings of the form { signal, sampleRate, frequency1, frequency2, level, duration } where signal is 'sine', 'chirp', 'bat-call', 'white-noise', 'pink-noise' or 'impulse' and sampleRate is one of the supported capture rates
+ * @param {boolean} offline Whether to process the playlist or generator once as fast as possible rather than in real time
+ * @param {number} startTime Time of the first sample in milliseconds since the epoch when processing offline, defaulting to now
  * @returns {boolean} Success or failure
  */
 exports.setSimulation = backstage.setSimulation;
 
 /**
  * Set monitor output mode
- * @param {number} mode Which mode to use (MONITOR_OFF, MONITOR_PLAYTHROUGH, MONITOR_HETERODYNE)
- * @param {number} frequency Mixing frequency for heterodyne output
+ * @param {number} mode Which mode to use (MONITOR_OFF, MONITOR_PLAYTHROUGH, MONITOR_HETERODYNE, MONITOR_FREQUENCY_DIVISION)
+ * @param {number|array} frequency Mixing frequency for heterodyne output, an array of up to four mixing frequencies for a heterodyne bank, or division ratio for frequency division output
+ * @param {array} pans Optional stereo position of each heterodyne channel from -1 (left) to 1 (right)
  */
 exports.setMonitor = backstage.setMonitor;
 
 exports.MONITOR_OFF = 0;
 exports.MONITOR_PLAYTHROUGH = 1;
 exports.MONITOR_HETERODYNE = 2;
+exports.MONITOR_FREQUENCY_DIVISION = 3;
 
 /**
  * Set 384kHz sampling for default input
@@ -103,6 +162,40 @@ exports.setHighDefaultSampleRate = backstage.setHighDefaultSampleRate;
  */
 exports.setLocalTime = backstage.setLocalTime;
 
+/**
+ * Set the low latency monitoring profile
+ * @param {boolean} enable Whether to use short device periods and a small playback lag target
+ * @param {boolean} exclusive Whether to request exclusive access to the audio devices where supported
+ */
+exports.setLowLatency = backstage.setLowLatency;
+
+/**
+ * Play a click while monitoring and time its return through a loopback connection
+ * @returns {boolean} Whether the measurement was started
+ */
+exports.measureLatency = backstage.measureLatency;
+
+/**
+ * Get monitoring latency statistics
+ * @returns {object} stats Device periods, playback lag and drift adjustment, capture clock drift in parts per million, simulation wakeup jitter, offline throughput in samples per second, plus estimated and measured latency and the last device restart time in milliseconds
+ */
+exports.getStats = backstage.getStats;
+
+/**
+ * Connect or disconnect a simulated AudioMoth USB Microphone when using the virtual backend. The change is picked up by the background device check as a real hotplug would be
+ * @param {boolean} connected Whether the simulated AudioMoth is connected
+ * @param {number} sampleRate Sample rate of the simulated AudioMoth in Hertz, defaulting to 384000
+ * @returns {boolean} Whether the virtual backend is in use
+ */
+exports.setVirtualAudioMoth = backstage.setVirtualAudioMoth;
+
+/**
+ * Write the most recent ten seconds of output which the virtual backend would have played to a stereo WAV file
+ * @param {string} filename Path of the WAV file to write
+ * @returns {boolean} Success or failure
+ */
+exports.writePlaybackSink = backstage.writePlaybackSink;
+
 /**
  * Shutdown
  */
@@ -12,113 +12,181 @@
 #include "threads.h"
 #include "autosave.h"
 
+/* Device name table constants. Names whose slot has been reused are reported as unknown */
+
+#define NUMBER_OF_DEVICE_NAMES          64
+
+#define UNKNOWN_DEVICE_NAME             "an unknown device"
+
+/* Queue cell structure */
+
+typedef struct {
+    volatile uint32_t sequence;
+    AS_event_t event;
+} AS_cell_t;
+
 /* Global queue variables */
 
-static int32_t readIndex;
+static AS_cell_t *cells;
+
+static uint32_t cellMask;
+
+static volatile uint32_t writePosition;
 
-static int32_t writeIndex;
+static uint32_t readPosition;
 
-static AS_event_t* events;
+/* Global device name variables */
 
-static pthread_mutex_t mutex;
+static pthread_mutex_t deviceNameMutex;
 
-static int32_t numberOfEvents;
+static uint32_t numberOfDeviceNames;
+
+static int32_t deviceNameGenerations[NUMBER_OF_DEVICE_NAMES];
+
+static char deviceNames[NUMBER_OF_DEVICE_NAMES][DEVICE_NAME_SIZE];
 
 /* Public functions */
 
 bool Autosave_initialise(int32_t number) {
 
-    pthread_mutex_init(&mutex, NULL);
+    pthread_mutex_init(&deviceNameMutex, NULL);
 
-    pthread_mutex_lock(&mutex);
-    
-    events = (AS_event_t*)calloc(number, sizeof(AS_event_t));
+    for (int32_t i = 0; i < NUMBER_OF_DEVICE_NAMES; i += 1) deviceNameGenerations[i] = -1;
 
-    numberOfEvents = number;
+    /* Round the queue size up to a power of two so positions can be masked */
 
-    writeIndex = 0;
+    uint32_t numberOfCells = 1;
 
-    readIndex = 0;
+    while (numberOfCells < (uint32_t)number) numberOfCells <<= 1;
 
-    pthread_mutex_unlock(&mutex);
+    cells = (AS_cell_t*)calloc(numberOfCells, sizeof(AS_cell_t));
 
-    return events != NULL;
+    if (cells == NULL) return false;
 
-}
+    for (uint32_t i = 0; i < numberOfCells; i += 1) cells[i].sequence = i;
 
-bool Autosave_hasEvents(void) {
+    cellMask = numberOfCells - 1;
+
+    readPosition = 0;
 
-    pthread_mutex_lock(&mutex);
+    Atomic_store32(&writePosition, 0);
 
-    bool hasEvents = readIndex != writeIndex;
+    return true;
+
+}
 
-    pthread_mutex_unlock(&mutex);
+bool Autosave_hasEvents(void) {
 
-    return hasEvents;
+    AS_cell_t *cell = cells + (readPosition & cellMask);
+
+    return Atomic_load32(&cell->sequence) == readPosition + 1;
     
 }
 
 bool Autosave_getFirstEvent(AS_event_t *event) {
 
-    pthread_mutex_lock(&mutex);
+    /* Only the autosave thread reads from the queue */
 
-    bool contents = readIndex != writeIndex;
+    AS_cell_t *cell = cells + (readPosition & cellMask);
 
-    if (contents) {
-        
-        memcpy(event, events + readIndex, sizeof(AS_event_t));
+    if (Atomic_load32(&cell->sequence) != readPosition + 1) return false;
 
-        readIndex = (readIndex + 1) % numberOfEvents;
-    }
+    memcpy(event, &cell->event, sizeof(AS_event_t));
 
-    pthread_mutex_unlock(&mutex);
+    Atomic_store32(&cell->sequence, readPosition + cellMask + 1);
 
-    return contents;
+    readPosition += 1;
+
+    return true;
 
 }
 
 bool Autosave_addEvent(AS_event_t *event) {
 
-    pthread_mutex_lock(&mutex);
+    /* Claim a cell without locking. Returns false rather than allocating if the queue is full */
+
+    AS_cell_t *cell;
+
+    uint32_t position = Atomic_load32(&writePosition);
+
+    while (true) {
+
+        cell = cells + (position & cellMask);
+
+        int32_t difference = (int32_t)(Atomic_load32(&cell->sequence) - position);
 
-    if ((writeIndex + 1) % numberOfEvents == readIndex) {
+        if (difference == 0) {
 
-        AS_event_t *newEvents = (AS_event_t*)calloc(2 * numberOfEvents, sizeof(AS_event_t));
+            if (Atomic_compareExchange32(&writePosition, position, position + 1)) break;
 
-        if (newEvents == NULL) {
-            
-            pthread_mutex_unlock(&mutex);
+        } else if (difference < 0) {
 
             return false;
 
         }
-        
-        memcpy(newEvents, events + readIndex, (numberOfEvents - readIndex) * sizeof(AS_event_t));
 
-        if (writeIndex < readIndex) {
+        position = Atomic_load32(&writePosition);
 
-            memcpy(newEvents + numberOfEvents - readIndex, events, (writeIndex + 1) * sizeof(AS_event_t));
+    }
 
-            writeIndex = numberOfEvents - 1;
+    memcpy(&cell->event, event, sizeof(AS_event_t));
 
-            readIndex = 0;
+    Atomic_store32(&cell->sequence, position + 1);
 
-        }
+    return true;
+
+}
+
+/* Device names are interned when a device starts so events only carry an ID. The ID is the generation of the slot so a reused slot is detected on lookup */
+
+int32_t Autosave_internDeviceName(char *deviceName) {
 
-        free(events);
+    pthread_mutex_lock(&deviceNameMutex);
 
-        events = newEvents;
+    for (int32_t i = 0; i < NUMBER_OF_DEVICE_NAMES; i += 1) {
 
-        numberOfEvents *= 2;
+        if (deviceNameGenerations[i] >= 0 && strcmp(deviceNames[i], deviceName) == 0) {
+
+            int32_t deviceNameID = deviceNameGenerations[i];
+
+            pthread_mutex_unlock(&deviceNameMutex);
+
+            return deviceNameID;
+
+        }
 
     }
 
-    memcpy(events + writeIndex, event, sizeof(AS_event_t));
+    int32_t deviceNameID = (int32_t)(numberOfDeviceNames & INT32_MAX);
 
-    writeIndex = (writeIndex + 1) % numberOfEvents;
+    int32_t slot = deviceNameID % NUMBER_OF_DEVICE_NAMES;
 
-    pthread_mutex_unlock(&mutex);
+    strncpy(deviceNames[slot], deviceName, DEVICE_NAME_SIZE - 1);
 
-    return true;
+    deviceNameGenerations[slot] = deviceNameID;
+
+    numberOfDeviceNames += 1;
+
+    pthread_mutex_unlock(&deviceNameMutex);
+
+    return deviceNameID;
+
+}
+
+bool Autosave_getDeviceName(int32_t deviceNameID, char *deviceName) {
+
+    /* Copy the name while holding the lock so the slot cannot be reused part way through */
+
+    pthread_mutex_lock(&deviceNameMutex);
+
+    bool found = deviceNameID >= 0 && deviceNameGenerations[deviceNameID % NUMBER_OF_DEVICE_NAMES] == deviceNameID;
+
+    strncpy(deviceName, found ? deviceNames[deviceNameID % NUMBER_OF_DEVICE_NAMES] : UNKNOWN_DEVICE_NAME, DEVICE_NAME_SIZE - 1);
+
+    deviceName[DEVICE_NAME_SIZE - 1] = 0;
+
+    pthread_mutex_unlock(&deviceNameMutex);
+
+    return found;
 
 }
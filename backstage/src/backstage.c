@@ -7,2256 +7,886 @@
 #include <stdio.h>
 #include <node_api.h>
 
-#ifdef __APPLE__
-    #define MA_NO_RUNTIME_LINKING
-#endif
-
-#define MINIAUDIO_IMPLEMENTATION
-
-#include "stft.h"
-#include "xtime.h"
+#include "engine.h"
 #include "macros.h"
-#include "threads.h"
 #include "wavFile.h"
-#include "autosave.h"
-#include "miniaudio.h"
+#include "generator.h"
 #include "simulator.h"
+#include "schedule.h"
+#include "prefilter.h"
 #include "heterodyne.h"
 
-/* Callback constants */
-
-#define CALLBACKS_PER_SECOND                100
-
-/* Capture constants */
+/* Buffer constants */
 
-#define NUMBER_OF_VALID_SAMPLE_RATES        8
-#define MAXIMUM_RECORD_DURATION             60
-#define DEFAULT_SAMPLE_RATE                 48000
-#define MAXIMUM_SAMPLE_RATE                 384000
+#define NUMBER_OF_BYTES_IN_FLOAT32          4
 
-#define AUDIO_BUFFER_SIZE                   (1 << 25)
-#define CAPTURE_BUFFER_SIZE                 (MAXIMUM_RECORD_DURATION * MAXIMUM_SAMPLE_RATE)
+/* NAPI variables */
 
-/* Buffer constants */
+static napi_value napi_value_null;
 
-#define FILE_TIME_BUFFER                    1024
-#define DEVICE_NAME_SIZE                    1024
-#define FILEPATH_SIZE                       8192
-#define FILENAME_SIZE                       8192
+static napi_value napi_value_true;
 
-/* Unit conversion constants */
+static napi_value napi_value_false;
 
-#define HERTZ_IN_KILOHERTZ                  1000
+static napi_value napi_value_undefined;
 
-#define SECONDS_IN_MINUTE                   60
-#define MINUTES_IN_HOUR                     60
-#define MILLISECONDS_IN_SECOND              1000
-#define MICROSECONDS_IN_SECOND              1000000
+static napi_value napi_audioArrayBuffer;
 
-/* STFT constants */
+static napi_value napi_audioTypedArray;
 
-#define STFT_INPUT_SAMPLES                  512
-#define NUMBER_OF_BYTES_IN_FLOAT32          4
-#define STFT_INPUT_OUTPUT_RATIO             2
+static napi_value napi_stftArrayBuffer;
 
-/* Frame timer constants */
+static napi_value napi_stftTypedArray;
 
-#define TIME_MISMATCH_LIMIT                 2000
+/* Thread safe function variables */
 
-/* Device check constant */
+static napi_threadsafe_function captureBufferThreadSafeCallback;
 
-#define DEVICE_STOP_START_TIMEOUT           2.0
-#define DEVICE_CHANGE_INTERVAL              1.0
-#define DEVICE_CHECK_INTERVAL               (MICROSECONDS_IN_SECOND / 4)
+static napi_threadsafe_function autosaveThreadSafeCallback;
 
-/* Monitor constants */
+static bool captureBufferSuccess;
 
-#define PLAYBACK_SAMPLE_RATE                48000
+/* Thread safe callback function */
 
-#if IS_WINDOWS
-    #define MAXIMUM_PLAYBACK_LAG            (CALLBACKS_PER_SECOND / 2)
-    #define TARGET_PLAYBACK_LAG             (CALLBACKS_PER_SECOND / 5)
-    #define TARGET_MINIMUM_PLAYBACK_LAG     (CALLBACKS_PER_SECOND / 10)
-#else
-    #define MAXIMUM_PLAYBACK_LAG            (CALLBACKS_PER_SECOND / 4)
-    #define TARGET_PLAYBACK_LAG             (CALLBACKS_PER_SECOND / 10)
-    #define TARGET_MINIMUM_PLAYBACK_LAG     (CALLBACKS_PER_SECOND / 20)
-#endif
+static void threadSafeNullCallback(napi_env env, napi_value callback, void *context, void *data) {
 
-#define MINIMUM_PLAYBACK_LAG                2
+    NAPI_CALL(env, "Failed to call function", napi_call_function(env, napi_value_undefined, callback, 1, &napi_value_null, NULL))
 
-#define MONITOR_OFF                         0
-#define MONITOR_PLAYTHROUGH                 1
-#define MONITOR_HETERODYNE                  2
+}
 
-/* Autosave constants */
+static void threadSafeBooleanCallback(napi_env env, napi_value callback, void *context, void *data) {
 
-#define AUTOSAVE_EVENT_QUEUE_SIZE           16
+    bool *result = (bool*)data;
 
-#define DEVICE_SHUTDOWN_TIMEOUT             2.0
+    NAPI_CALL(env, "Failed to call function", napi_call_function(env, napi_value_undefined, callback, 1, *result ? &napi_value_true : &napi_value_false, NULL))
 
-/* Audio buffer variables */
+}
 
-static int16_t *audioBuffer;
+/* Engine callbacks. These run on engine threads and hand over to the JavaScript thread */
 
-static int64_t audioBufferStartTime;
+static void captureCallback(bool success) {
 
-static int32_t audioBufferIndex;
+    captureBufferSuccess = success;
 
-static int32_t audioBufferWriteIndex;
+    napi_acquire_threadsafe_function(captureBufferThreadSafeCallback);
 
-static int64_t audioBufferSampleCount;
+    napi_call_threadsafe_function(captureBufferThreadSafeCallback, &captureBufferSuccess, napi_tsfn_nonblocking);
 
-static pthread_mutex_t audioBufferMutex;
+    napi_release_threadsafe_function(captureBufferThreadSafeCallback, napi_tsfn_release);
 
-/* Working STFT buffer */
+}
 
-static float* stftBuffer;
+static void autosaveCallback(void) {
 
-/* Capture buffer variables */
+    napi_acquire_threadsafe_function(autosaveThreadSafeCallback);
 
-static char captureBufferDeviceCommentName[DEVICE_NAME_SIZE];
+    napi_call_threadsafe_function(autosaveThreadSafeCallback, NULL, napi_tsfn_nonblocking);
 
-static int16_t captureBuffer[CAPTURE_BUFFER_SIZE];
+    napi_release_threadsafe_function(autosaveThreadSafeCallback, napi_tsfn_release);
 
-static int64_t captureBufferSampleCount;
+}
 
-static int32_t captureBufferWriteIndex;
+/* Value helpers */
 
-static int32_t captureBufferSampleRate;
+static void setBooleanProperty(napi_env env, napi_value jsObj, char *name, bool value) {
 
-static int64_t captureBufferStartTime;
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, name, value ? napi_value_true : napi_value_false))
 
-static int32_t captureBufferLength;
+}
 
-static int32_t captureBufferLocalTimeOffset;
+static void setDoubleProperty(napi_env env, napi_value jsObj, char *name, double value) {
 
-static napi_threadsafe_function captureBufferThreadSafeCallback;
+    napi_value napi_number;
 
-static pthread_t captureBufferThread;
+    NAPI_CALL(env, "Failed to create value", napi_create_double(env, value, &napi_number))
 
-static bool captureBufferSuccess;
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, name, napi_number))
 
-/* Playback variables */
+}
 
-static pthread_t startPlaybackThread;
+static void setNullableDoubleProperty(napi_env env, napi_value jsObj, char *name, bool valid, double value) {
 
-static pthread_t stopPlaybackThread;
+    if (valid) {
 
-/* Simulation variables */
+        setDoubleProperty(env, jsObj, name, value);
 
-static int32_t simulationIndex;
+    } else {
 
-static bool shouldStopSimulation;
+        NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, name, napi_value_null))
 
-static bool shouldStartSimulation;
+    }
 
-static pthread_t simulationThread;
+}
 
-static bool simulationRunning;
+static double getDoubleProperty(napi_env env, napi_value jsObj, char *name, double defaultValue) {
 
-static pthread_mutex_t simulationRunningMutex;
+    bool hasProperty = false;
 
-static int16_t simulationBuffer[MAXIMUM_SAMPLE_RATE / CALLBACKS_PER_SECOND];
+    double value = defaultValue;
 
-/* Frontend state variables */
+    NAPI_CALL(env, "Failed to check named property", napi_has_named_property(env, jsObj, name, &hasProperty))
 
-static double timeDeviceStarted;
+    if (hasProperty) {
 
-static bool heterodyneEnabled;
+        napi_value napi_number;
 
-static bool monitorEnabled;
+        NAPI_CALL(env, "Failed to get named property", napi_get_named_property(env, jsObj, name, &napi_number))
 
-static bool frontEndPaused;
+        NAPI_CALL(env, "Failed to parse number as a property", napi_get_value_double(env, napi_number, &value))
 
-static ma_timer timer;
+    }
 
-/* File destination variables */
+    return value;
 
-static bool fileDestinationSet;
+}
 
-static pthread_mutex_t fileDestinationMutex;
+static bool getGeneratorSettings(napi_env env, napi_value jsObj, GN_settings_t *settings) {
 
-static char fileDestination[FILEPATH_SIZE];
+    /* Signals are given by name, as in { signal: 'chirp', sampleRate: 384000, frequency1: 10000, frequency2: 120000 } */
 
-/* Local time variable */
+    napi_value napi_signal;
 
-static bool useLocalTime = true;
+    size_t length;
 
-static pthread_mutex_t localTimeMutex;
+    char name[32] = "";
 
-/* Background thread variables */
+    NAPI_CALL(env, "Failed to get named property", napi_get_named_property(env, jsObj, "signal", &napi_signal))
 
-static pthread_t backgroundThread;
+    NAPI_CALL(env, "Failed to parse string as a property", napi_get_value_string_utf8(env, napi_signal, name, sizeof(name), &length))
 
-static pthread_mutex_t backgroundMutex;
+    settings->sampleRate = (int32_t)getDoubleProperty(env, jsObj, "sampleRate", 0.0);
 
-static double backgroundDeviceCheckTime;
+    settings->frequency1 = (int32_t)getDoubleProperty(env, jsObj, "frequency1", 0.0);
 
-static pthread_mutex_t backgroundDeviceCheckMutex;
+    settings->frequency2 = (int32_t)getDoubleProperty(env, jsObj, "frequency2", 0.0);
 
-static bool backgroundDeviceCheckFoundAudioMoth;
+    settings->level = getDoubleProperty(env, jsObj, "level", 0.0);
 
-static bool backgroundDeviceCheckFoundOldAudioMoth;
+    settings->duration = getDoubleProperty(env, jsObj, "duration", 0.0);
 
-/* Autosave capture variables */
+    return Generator_findSignal(name, &settings->signal);
 
-static int32_t autosaveDuration;
+}
 
-static int64_t autosaveStartTime;
+/* Exported functions */
 
-static int64_t autosaveSampleCount;
+napi_value initialise(napi_env env, napi_callback_info info) {
 
-static int64_t autosaveStartSampleCount;
+    size_t argc = 1;
+    napi_value argv[1];
 
-/* Autosave file variables */
+    bool useVirtualBackend = false;
 
-static time_t autosaveFileStartTime;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-static int32_t autosaveFileStartIndex;
+    if (argc > 0) NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &useVirtualBackend))
 
-static int64_t autosaveFileStartCount;
+    /* Generate the NAPI components */
 
-static int32_t autosaveFileSampleRate;
+    NAPI_CALL(env, "Failed to create true value", napi_get_null(env, &napi_value_null))
 
-/* Autosave state variables */
+    NAPI_CALL(env, "Failed to create true value", napi_get_boolean(env, true, &napi_value_true))
 
-static bool autosaveShutdownCompleted;
+    NAPI_CALL(env, "Failed to create false value", napi_get_boolean(env, false, &napi_value_false))
 
-static pthread_mutex_t autosaveMutex;
+    NAPI_CALL(env, "Failed to create undefined value", napi_get_undefined(env, &napi_value_undefined))
 
-static int64_t autosaveTargetCount = INT64_MAX;
+    int16_t *audioBuffer;
 
-static bool autosaveWaitingForStartEvent = true;
+    float *stftBuffer;
 
-static char autosaveInputDeviceCommentName[DEVICE_NAME_SIZE];
+    NAPI_CALL(env, "Failed to create array buffer value", napi_create_arraybuffer(env, NUMBER_OF_BYTES_IN_SAMPLE * AUDIO_BUFFER_SIZE, (void**)&audioBuffer, &napi_audioArrayBuffer))
 
-static napi_threadsafe_function autosaveThreadSafeCallback;
+    NAPI_CALL(env, "Failed to create typed array value", napi_create_typedarray(env, napi_int16_array, AUDIO_BUFFER_SIZE, napi_audioArrayBuffer, 0, &napi_audioTypedArray))
 
-/* Playback start variables */
+    NAPI_CALL(env, "Failed to create array buffer value", napi_create_arraybuffer(env, NUMBER_OF_BYTES_IN_FLOAT32 * STFT_BUFFER_SIZE, (void**)&stftBuffer, &napi_stftArrayBuffer))
 
-static int32_t playbackReadIndex = 0;
+    NAPI_CALL(env, "Failed to create typed array value", napi_create_typedarray(env, napi_float32_array, STFT_BUFFER_SIZE, napi_stftArrayBuffer, 0, &napi_stftTypedArray))
 
-static int32_t playbackBufferCount = 1;
+    /* Start the engine */
 
-static int32_t minimumPlaybackBufferLag = INT32_MAX;
+    bool success = Engine_initialise(audioBuffer, stftBuffer, useVirtualBackend ? BACKEND_VIRTUAL : BACKEND_SYSTEM);
 
-static pthread_mutex_t playbackMutex;
+    /* Return typed array */
 
-/* Miniaudio contexts */
+    napi_value jsObj;
 
-static ma_context playbackContext;
+    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj));
 
-static ma_context deviceCheckContext;
+    setBooleanProperty(env, jsObj, "success", success);
 
-/* Stop and start variable */
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioBuffer", napi_audioTypedArray));
 
-static bool stopped;
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "stftBuffer", napi_stftTypedArray));
 
-static bool started;
+    return jsObj;
 
-static pthread_mutex_t stopStartMutex;
+}
 
-/* State variables */
+napi_value changeSampleRate(napi_env env, napi_callback_info info) {
 
-static bool usingAudioMoth;
+    size_t argc = 1;
+    napi_value argv[1];
 
-static ma_device captureDevice;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-static ma_device playbackDevice;
+    int32_t number;
 
-static ma_device_id audioMothDeviceID;
+    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &number))
 
-static bool shouldSetRedrawFlag = true;
+    Engine_changeSampleRate(number);
 
-static bool requestedSampleRateChanged = false;
+    /* Return null value */
 
-static int32_t requestedMaximumDefaultSampleRate;
+    return napi_value_null;
 
-static bool maximumDefaultSampleRateChanged = false;
+}
 
-/* Sample rate variables */
+napi_value getFrame(napi_env env, napi_callback_info info) {
 
-static int32_t currentSampleRate;
+    EN_frame_t frame;
 
-static int32_t audioMothSampleRate;
+    Engine_getFrame(&frame);
 
-static int32_t requestedSampleRate = DEFAULT_SAMPLE_RATE;
+    /* Generate return object */
 
-static int32_t maximumDefaultSampleRate = DEFAULT_SAMPLE_RATE;
+    napi_value jsObj;
 
-static int32_t validSampleRates[NUMBER_OF_VALID_SAMPLE_RATES] = {8000, 16000, 32000, 48000, 96000, 192000, 250000, 384000};
+    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj));
 
-/* Input device variables */
+    setBooleanProperty(env, jsObj, "redrawRequired", frame.redrawRequired);
 
-static int32_t inputDeviceSampleRate;
+    setBooleanProperty(env, jsObj, "simulationRunning", frame.simulationRunning);
 
-static char inputDeviceName[DEVICE_NAME_SIZE];
+    setBooleanProperty(env, jsObj, "offlineComplete", frame.offlineComplete);
 
-static char inputDeviceCommentName[DEVICE_NAME_SIZE];
+    setBooleanProperty(env, jsObj, "oldAudioMothFound", frame.oldAudioMothFound);
 
-/* NAPI variables */
+    setBooleanProperty(env, jsObj, "triggered", frame.triggered);
 
-static napi_value napi_value_null;
+    setBooleanProperty(env, jsObj, "processingSuspended", frame.processingSuspended);
 
-static napi_value napi_value_true;
+    setNullableDoubleProperty(env, jsObj, "reviewPosition", frame.reviewPosition >= 0.0, frame.reviewPosition);
 
-static napi_value napi_value_false;
+    napi_value napi_deviceName;
 
-static napi_value napi_value_undefined;
+    NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, frame.deviceName, NAPI_AUTO_LENGTH, &napi_deviceName))
 
-static napi_value napi_audioArrayBuffer;
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "deviceName", napi_deviceName))
 
-static napi_value napi_audioTypedArray;
+    napi_value napi_maximumSampleRate;
 
-static napi_value napi_stftArrayBuffer;
+    NAPI_CALL(env, "Failed to create value", napi_create_int32(env, frame.maximumSampleRate, &napi_maximumSampleRate))
 
-static napi_value napi_stftTypedArray;
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "maximumSampleRate", napi_maximumSampleRate))
 
-/* Structure for device check */
+    napi_value napi_currentSampleRate;
 
-typedef struct {
-    bool audioMothFound;
-    bool oldAudioMothFound;
-} device_check_t;
+    NAPI_CALL(env, "Failed to create value", napi_create_int32(env, frame.currentSampleRate, &napi_currentSampleRate))
 
-/* Structure for device enumeration */
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "currentSampleRate", napi_currentSampleRate))
 
-typedef struct {
-    bool updateAudioMothSettings;
-    device_check_t device_check;
-} enumerate_devices_t;
+    setDoubleProperty(env, jsObj, "audioTime", (double)frame.audioTime);
 
-/* Callbacks to handle capture and playback of audio samples */
+    setDoubleProperty(env, jsObj, "audioIndex", (double)frame.audioIndex);
 
-void capture_notification_callback(const ma_device_notification *pNotification) {
+    setDoubleProperty(env, jsObj, "audioCount", (double)frame.audioCount);
 
-    if (pNotification->type == ma_device_notification_type_started) { }
+    /* Return object */
 
-    if (pNotification->type == ma_device_notification_type_stopped) {
-        
-        pthread_mutex_lock(&stopStartMutex);
-        
-        stopped = true;
+    return jsObj;
 
-        pthread_mutex_unlock(&stopStartMutex);
+}
 
-    }
+napi_value clear(napi_env env, napi_callback_info info) {
 
-    if (pNotification->type == ma_device_notification_type_rerouted) { }
+    Engine_clear();
 
-    if (pNotification->type == ma_device_notification_type_interruption_began) { }
+    /* Return null value */
 
-    if (pNotification->type == ma_device_notification_type_interruption_ended) { }
+    return napi_value_null;
 
 }
 
-void playback_data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount) {
-
-    int16_t *outputBuffer = (int16_t*)pOutput;
+napi_value capture(napi_env env, napi_callback_info info) {
 
-    /* Static playback variables */
+    size_t argc = 2;
+    napi_value argv[2];
 
-    static double playbackPosition = 0;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    static double playbackNextSample = 0;
+    int32_t duration;
 
-    static double playbackCurrentSample = 0;
+    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &duration))
 
-    static bool playbackBufferWaiting = false;
+    /* Generate callback function */
 
-    /* Calculate the buffer lag */
+    napi_value callback = argv[1];
 
-    int32_t sampleLag = (AUDIO_BUFFER_SIZE + audioBufferWriteIndex - playbackReadIndex) % AUDIO_BUFFER_SIZE;
+    napi_value work_name;
 
-    int32_t bufferLag = sampleLag * CALLBACKS_PER_SECOND / currentSampleRate;
+    NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, "Capture Callback", NAPI_AUTO_LENGTH, &work_name))
 
-    /* Check minimum buffer lag */
+    NAPI_CALL(env, "Failed to create threadsafe function", napi_create_threadsafe_function(env, callback, NULL, work_name, 0, 1, NULL, NULL, NULL, threadSafeBooleanCallback, &captureBufferThreadSafeCallback))
 
-    if (bufferLag > MAXIMUM_PLAYBACK_LAG) {
-       
-        playbackReadIndex = audioBufferWriteIndex;
+    /* Start capture */
 
-        playbackBufferWaiting = true;
+    Engine_capture(duration, captureCallback);
 
-        sampleLag = 0;
+    /* Return null value */
 
-        bufferLag = 0;
+    return napi_value_null;
 
-    }
+}
 
-    /* Update shared global variables */
+napi_value setPause(napi_env env, napi_callback_info info) {
 
-    bool starvation = sampleLag < (int32_t)frameCount;
+    size_t argc = 2;
+    napi_value argv[2];
 
-    pthread_mutex_lock(&playbackMutex);
+    bool enable;
 
-    minimumPlaybackBufferLag = MIN(bufferLag, minimumPlaybackBufferLag);
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    playbackBufferCount += playbackBufferWaiting == false && (bufferLag < MINIMUM_PLAYBACK_LAG || starvation) ? 2 : 0;
+    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
 
-    pthread_mutex_unlock(&playbackMutex);
+    int32_t duration;
 
-    /* Provide samples to playback device */
+    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &duration))
 
-    if (playbackBufferWaiting || starvation) {
+    EN_pause_t pause;
 
-        for (ma_uint32 i = 0; i < frameCount; i += 1) outputBuffer[i] = 0;
+    Engine_setPause(enable, duration, &pause);
 
-    } else {
+    /* Generate return object */
 
-        if (heterodyneEnabled) Heterodyne_normalise();
+    napi_value jsObj;
 
-        int32_t sampleRateDivider = MAXIMUM_SAMPLE_RATE / PLAYBACK_SAMPLE_RATE;
+    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj));
 
-        double step = (double)currentSampleRate / (double)MAXIMUM_SAMPLE_RATE;
+    if (pause.paused) {
 
-        for (ma_uint32 i = 0; i < frameCount; i += 1) {
+        setDoubleProperty(env, jsObj, "audioStartTime", (double)pause.audioStartTime);
 
-            double playbackAccumulator = 0;
+        setDoubleProperty(env, jsObj, "audioIndex", (double)pause.audioIndex);
 
-            for (int32_t j = 0; j < sampleRateDivider; j += 1) {
+        setDoubleProperty(env, jsObj, "audioCount", (double)pause.audioCount);
 
-                double sample = playbackCurrentSample + playbackPosition * (playbackNextSample - playbackCurrentSample);
+    }
 
-                playbackAccumulator += heterodyneEnabled ? Heterodyne_nextOutput(sample) : sample;
+    /* Return object */
 
-                playbackPosition += step;
+    return jsObj;
 
-                if (playbackPosition >= 1.0) {
+}
 
-                    playbackCurrentSample = playbackNextSample;
+napi_value setReview(napi_env env, napi_callback_info info) {
 
-                    playbackNextSample = audioBuffer[playbackReadIndex];
+    size_t argc = 4;
+    napi_value argv[4];
 
-                    playbackReadIndex = (playbackReadIndex + 1) % AUDIO_BUFFER_SIZE;
+    bool enable;
 
-                    playbackPosition -= 1.0;
+    int32_t expansion = 1;
 
-                }
+    double startTime = 0.0;
 
-            }
+    double stopTime = 0.0;
 
-            double sample = MAX(INT16_MIN, MIN(INT16_MAX, round(playbackAccumulator / (double)sampleRateDivider)));
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-            outputBuffer[i] = (int16_t)sample;
+    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
 
-        }
+    if (argc > 1) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &expansion))
 
-    }
+    if (argc > 2) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_double(env, argv[2], &startTime))
 
-    if (bufferLag > TARGET_PLAYBACK_LAG) playbackBufferWaiting = false;
+    if (argc > 3) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_double(env, argv[3], &stopTime))
 
-}
+    bool success = Engine_setReview(enable, expansion, startTime, stopTime);
 
-void capture_data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount) {
+    /* Return success value */
 
-    int64_t startTime = 0;
+    return success ? napi_value_true : napi_value_false;
 
-    int32_t increment = 0;
+}
 
-    int16_t *inputBuffer = (int16_t*)pInput;
+napi_value setFileDestination(napi_env env, napi_callback_info info) {
 
-    int32_t sampleRateDivider = (int32_t)ceil(inputDeviceSampleRate / currentSampleRate);
+    size_t argc = 1;
+    napi_value argv[1];
 
-    int32_t interpolationSampleRate = sampleRateDivider * currentSampleRate;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    double step = (double)inputDeviceSampleRate / (double)interpolationSampleRate;
+    size_t length;
 
-    /* Static resample variables */
+    static char buffer[FILEPATH_SIZE];
 
-    static int32_t resampleCounter = 0;
+    NAPI_CALL(env, "Failed to parse string as an argument", napi_get_value_string_utf8(env, argv[0], buffer, FILEPATH_SIZE, &length))
 
-    static double resamplePosition = 0;
+    Engine_setFileDestination(buffer);
 
-    static double resampleNextSample = 0;
+    /* Return null value */
 
-    static double resampleAccumulator = 0;
+    return napi_value_null;
 
-    static double resampleCurrentSample = 0;
+}
 
-    /* Check for restart */
+napi_value setAutoSaveCallback(napi_env env, napi_callback_info info) {
 
-    pthread_mutex_lock(&stopStartMutex);
+    size_t argc = 1;
+    napi_value argv[1];
 
-    bool restart = started == false;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    pthread_mutex_unlock(&stopStartMutex);
+    /* Generate callback function */
 
-    if (restart) {
+    napi_value callback = argv[0];
 
-        /* Get start time */
+    napi_value work_name;
 
-        startTime = Time_getMillisecondUTC();
+    NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, "Autosave Callback", NAPI_AUTO_LENGTH, &work_name))
 
-        /* Reset resampler */
+    NAPI_CALL(env, "Failed to create threadsafe function", napi_create_threadsafe_function(env, callback, NULL, work_name, 0, 1, NULL, NULL, NULL, threadSafeNullCallback, &autosaveThreadSafeCallback))
 
-        resampleCounter = 0;
+    Engine_setAutoSaveCallback(autosaveCallback);
 
-        resamplePosition = 0;
+    /* Return null value */
 
-        resampleNextSample = 0;
+    return napi_value_null;
 
-        resampleAccumulator = 0;
+}
 
-        resampleCurrentSample = 0;
+napi_value setAutoSave(napi_env env, napi_callback_info info) {
 
-    }
+    size_t argc = 2;
+    napi_value argv[2];
 
-    /* Process samples */
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    for (ma_uint32 i = 0; i < frameCount; i += 1) {
+    int32_t duration;
 
-        resampleCurrentSample = resampleNextSample;
+    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &duration))
 
-        resampleNextSample = inputBuffer[i];
+    int32_t segmentLength = 0;
 
-        while (resamplePosition < 1.0) {
+    if (argc > 1) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &segmentLength))
 
-            resampleAccumulator += resampleCurrentSample + resamplePosition * (resampleNextSample - resampleCurrentSample);
+    Engine_setAutoSave(duration, segmentLength);
 
-            resampleCounter += 1;
+    /* Return null value */
 
-            if (resampleCounter == sampleRateDivider) {
+    return napi_value_null;
 
-                double sample = MAX(INT16_MIN, MIN(INT16_MAX, round(resampleAccumulator / (double)sampleRateDivider)));
+}
 
-                audioBuffer[audioBufferIndex] = (int16_t)sample;
+napi_value setTrigger(napi_env env, napi_callback_info info) {
 
-                if (audioBufferIndex % STFT_INPUT_SAMPLES == STFT_INPUT_SAMPLES - 1) {
+    size_t argc = 7;
+    napi_value argv[7];
 
-                    int32_t startIndex = audioBufferIndex - STFT_INPUT_SAMPLES + 1;
+    bool enable;
 
-                    STFT_transform(audioBuffer, startIndex, stftBuffer, startIndex / STFT_INPUT_OUTPUT_RATIO);
+    int32_t minimumFrequency = 0;
 
-                    increment += STFT_INPUT_SAMPLES;
+    int32_t maximumFrequency = 0;
 
-                }
+    double threshold = 0.0;
 
-                audioBufferIndex = (audioBufferIndex + 1) % AUDIO_BUFFER_SIZE;
+    double hysteresis = 0.0;
 
-                resampleAccumulator = 0;
+    int32_t preTrigger = 0;
 
-                resampleCounter = 0;
+    int32_t postTrigger = 0;
 
-            }
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-            resamplePosition += step;
+    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
 
-        }
+    if (enable) {
 
-        resamplePosition -= 1.0;
-    
-    }   
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &minimumFrequency))
 
-    pthread_mutex_lock(&audioBufferMutex);
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[2], &maximumFrequency))
 
-    audioBufferWriteIndex = (audioBufferWriteIndex + increment) % AUDIO_BUFFER_SIZE;
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_double(env, argv[3], &threshold))
 
-    if (restart) {
-        
-        autosaveStartTime = startTime;
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_double(env, argv[4], &hysteresis))
 
-        audioBufferStartTime = startTime;
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[5], &preTrigger))
 
-        autosaveStartSampleCount = autosaveSampleCount;
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[6], &postTrigger))
 
     }
 
-    audioBufferSampleCount += increment;
-
-    autosaveSampleCount += increment;
+    Engine_setTrigger(enable, minimumFrequency, maximumFrequency, threshold, hysteresis, preTrigger, postTrigger);
 
-    pthread_mutex_unlock(&audioBufferMutex);
+    /* Return null value */
 
-    if (restart) {
+    return napi_value_null;
 
-        pthread_mutex_lock(&stopStartMutex);
+}
 
-        started = true;
+napi_value setSchedule(napi_env env, napi_callback_info info) {
 
-        pthread_mutex_unlock(&stopStartMutex);
+    size_t argc = 4;
+    napi_value argv[4];
 
-    }
+    int32_t mode;
 
-}
+    bool suspend = false;
 
-/* Functions to check for AudioMoth */
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-ma_bool32 enumerate_devices_callback(ma_context *pContext, ma_device_type deviceType, const ma_device_info* deviceInfo, void *pUserData) {
+    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &mode))
 
-    enumerate_devices_t *enumerateDevices = (enumerate_devices_t*)pUserData;
+    if (argc > 3) NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[3], &suspend))
 
-    if (strstr(deviceInfo->name, "F32x USBXpress Device")) enumerateDevices->device_check.oldAudioMothFound = true;
+    if (mode == SCHEDULE_DUTY_CYCLE) {
 
-    if (strstr(deviceInfo->name, "AudioMoth")) {
+        int32_t recordDuration;
 
-        if (strstr(deviceInfo->name, "kHz AudioMoth") == NULL) enumerateDevices->device_check.oldAudioMothFound = true;
+        int32_t period;
 
-        enumerateDevices->device_check.audioMothFound = true;
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &recordDuration))
 
-        if (enumerateDevices->updateAudioMothSettings) { 
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[2], &period))
 
-            memcpy(&audioMothDeviceID, &(deviceInfo->id), sizeof(ma_device_id));
+        Engine_setDutyCycleSchedule(recordDuration, period, suspend);
 
-            char *digit = strstr(deviceInfo->name, "kHz") - 1;
+    } else if (mode == SCHEDULE_WINDOWS) {
 
-            if (digit == NULL) {
+        uint32_t numberOfWindows;
 
-                audioMothSampleRate = MAXIMUM_SAMPLE_RATE;
+        static int32_t startMinutes[MAXIMUM_NUMBER_OF_WINDOWS];
 
-            } else {
+        static int32_t stopMinutes[MAXIMUM_NUMBER_OF_WINDOWS];
 
-                int32_t multiplier = 1000;
+        NAPI_CALL(env, "Failed to parse array as an argument", napi_get_array_length(env, argv[1], &numberOfWindows))
 
-                audioMothSampleRate = 0;
+        numberOfWindows = MIN(MAXIMUM_NUMBER_OF_WINDOWS, numberOfWindows);
 
-                do {
+        for (uint32_t i = 0; i < numberOfWindows; i += 1) {
 
-                    audioMothSampleRate += multiplier * (*digit - '0');
+            napi_value element;
 
-                    multiplier *= 10;
+            NAPI_CALL(env, "Failed to get array element", napi_get_element(env, argv[1], i, &element))
 
-                    digit -= 1;
+            NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, element, startMinutes + i))
 
-                } while (*digit >= '0' && *digit <= '9');
+            NAPI_CALL(env, "Failed to get array element", napi_get_element(env, argv[2], i, &element))
 
-            }
+            NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, element, stopMinutes + i))
 
         }
 
-        return MA_FALSE;
-
-    }
-
-    return MA_TRUE;
+        Engine_setWindowSchedule(numberOfWindows, startMinutes, stopMinutes, suspend);
 
-}
+    } else {
 
-static device_check_t checkForAudioMoth(ma_context *context, bool updateAudioMothSettings) {
+        Engine_clearSchedule();
 
-    enumerate_devices_t info = {
-        .updateAudioMothSettings = updateAudioMothSettings,
-        .device_check.oldAudioMothFound = false,
-        .device_check.audioMothFound = false
-    };
+    }
 
-    ma_result result = ma_context_enumerate_devices(context, enumerate_devices_callback, (void*)&info);
+    /* Return null value */
 
-    if (result != MA_SUCCESS) {
+    return napi_value_null;
 
-        device_check_t device_check = {
-            .oldAudioMothFound = false,
-            .audioMothFound = false
-        };
+}
 
-        return device_check;
+napi_value setFilter(napi_env env, napi_callback_info info) {
 
-    }
+    size_t argc = 3;
+    napi_value argv[3];
 
-    return info.device_check;
-    
-}
+    int32_t type;
 
-/* Thread functions to start and stop capture device */
+    int32_t frequency1 = 0;
 
-static bool startMicrophone(ma_context *context, bool usingAudioMoth) {
+    int32_t frequency2 = 0;
 
-    /* Initialise capture device */
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    ma_device_config captureDeviceConfig = ma_device_config_init(ma_device_type_capture);
+    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &type))
 
-    captureDeviceConfig.capture.pDeviceID = usingAudioMoth ? &audioMothDeviceID : NULL;
-    captureDeviceConfig.capture.format = ma_format_s16;
-    captureDeviceConfig.capture.channels = 1;
-    captureDeviceConfig.capture.shareMode  = ma_share_mode_shared;
+    if (type == PF_LOW_PASS || type == PF_HIGH_PASS || type == PF_BAND_PASS || type == PF_NOTCH) {
 
-    inputDeviceSampleRate = usingAudioMoth ? audioMothSampleRate : maximumDefaultSampleRate;
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &frequency1))
 
-    sprintf(inputDeviceName, usingAudioMoth ? "%dkHz AudioMoth USB Microphone" : "%dkHz Default Input", inputDeviceSampleRate / HERTZ_IN_KILOHERTZ);
+    }
 
-    sprintf(inputDeviceCommentName, usingAudioMoth ? "a %dkHz AudioMoth USB Microphone" : "the %dkHz default input", inputDeviceSampleRate / HERTZ_IN_KILOHERTZ);
+    if (type == PF_BAND_PASS || type == PF_NOTCH) {
 
-    currentSampleRate = MIN(requestedSampleRate, inputDeviceSampleRate);
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[2], &frequency2))
 
-    requestedSampleRate = currentSampleRate;
+    }
 
-    captureDeviceConfig.sampleRate = inputDeviceSampleRate;
-    captureDeviceConfig.periodSizeInFrames = inputDeviceSampleRate / CALLBACKS_PER_SECOND;
-    captureDeviceConfig.dataCallback = capture_data_callback;
-    captureDeviceConfig.notificationCallback = capture_notification_callback;
+    Engine_setFilter(type, frequency1, frequency2);
 
-    ma_result result = ma_device_init(context, &captureDeviceConfig, &captureDevice);
+    /* Return null value */
 
-    if (result != MA_SUCCESS) return false;
+    return napi_value_null;
 
-    /* Start the capture device */
+}
 
-    result = ma_device_start(&captureDevice);
+napi_value getSimulationInfo(napi_env env, napi_callback_info info) {
 
-    if (result != MA_SUCCESS) return false;
+    size_t argc = 1;
+    napi_value argv[1];
 
-    return true;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-}
+    size_t length;
 
-void stopMicrophone(void) {
+    static char buffer[FILEPATH_SIZE];
 
-    ma_device_stop(&captureDevice);
+    NAPI_CALL(env, "Failed to parse string as an argument", napi_get_value_string_utf8(env, argv[0], buffer, FILEPATH_SIZE, &length))
 
-    ma_device_uninit(&captureDevice);
-        
-    memset(&captureDevice, 0, sizeof(ma_device));
+    Engine_setSimulationPath(buffer);
 
-}
+    napi_value jsObj;
 
-/* Static thread functions to start and stop playback device */
+    napi_value napi_description;
 
-static void *startPlaybackThreadBody(void *ptr) {
+    napi_value napi_description_array;
 
-    /* Initialise playback device */
+    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj))
 
-    ma_device_config playbackDeviceConfig = ma_device_config_init(ma_device_type_playback);
+    NAPI_CALL(env, "Failed to parse arguments", napi_create_array_with_length(env, NUMBER_OF_SIMULATION_EXAMPLES, &napi_description_array))
 
-    playbackDeviceConfig.playback.pDeviceID = NULL;
-    playbackDeviceConfig.playback.format = ma_format_s16;
-    playbackDeviceConfig.playback.channels = 1;
+    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "descriptions", napi_description_array))
 
-    playbackDeviceConfig.sampleRate = PLAYBACK_SAMPLE_RATE;
-    playbackDeviceConfig.periodSizeInFrames = PLAYBACK_SAMPLE_RATE / CALLBACKS_PER_SECOND;
-    playbackDeviceConfig.dataCallback = playback_data_callback;
-    playbackDeviceConfig.notificationCallback = NULL;
+    for (int32_t i = 0; i < NUMBER_OF_SIMULATION_EXAMPLES; i += 1) {
 
-    ma_result result = ma_device_init(&playbackContext, &playbackDeviceConfig, &playbackDevice);
+        char *description = Simulator_getDescription(i);
 
-    if (result != MA_SUCCESS) {
-        
-        puts("[BACKSTAGE] Failed to initialise playback device");
+        NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, description, NAPI_AUTO_LENGTH, &napi_description))
 
-        return NULL;
+        NAPI_CALL(env, "Failed to set array element", napi_set_element(env, napi_description_array, i, napi_description))
 
     }
 
-    /* Start the playback device */
-
-    result = ma_device_start(&playbackDevice);
-
-    if (result != MA_SUCCESS) puts("[BACKSTAGE] Failed to start playback device");
+    /* Return object */
 
-    return NULL;
+    return jsObj;
 
 }
 
-static void *stopPlaybackThreadBody(void *ptr) {
+napi_value setSimulation(napi_env env, napi_callback_info info) {
 
-    ma_device_stop(&playbackDevice);
+    size_t argc = 4;
+    napi_value argv[4];
 
-    ma_device_uninit(&playbackDevice);
-        
-    memset(&playbackDevice, 0, sizeof(ma_device));
+    bool enable;
 
-    return NULL;
-    
-}
+    bool isArray = false;
 
-/* Thread safe callback function */
+    napi_valuetype type = napi_undefined;
 
-static void threadSafeNullCallback(napi_env env, napi_value callback, void *context, void *data) {
+    bool offline = false;
 
-    NAPI_CALL(env, "Failed to call function", napi_call_function(env, napi_value_undefined, callback, 1, &napi_value_null, NULL))
+    double startTime = 0.0;
 
-}
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-static void threadSafeBooleanCallback(napi_env env, napi_value callback, void *context, void *data) {
- 
-    bool *result = (bool*)data;
+    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
 
-    NAPI_CALL(env, "Failed to call function", napi_call_function(env, napi_value_undefined, callback, 1, *result ? &napi_value_true : &napi_value_false, NULL))
+    if (enable) NAPI_CALL(env, "Failed to parse arguments", napi_is_array(env, argv[1], &isArray))
 
-}
+    if (enable) NAPI_CALL(env, "Failed to parse arguments", napi_typeof(env, argv[1], &type))
 
-/* Simulation thread */
+    if (enable && argc > 2) NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[2], &offline))
 
-static void *simulationThreadBody(void *ptr) {
+    if (offline && argc > 3) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_double(env, argv[3], &startTime))
 
-    int32_t counter = 0;
+    bool success = true;
+
+    if (enable && isArray) {
 
-    int32_t bufferLag = TARGET_MINIMUM_PLAYBACK_LAG;
+        /* Load a playlist of WAV files */
 
-    while (true) {
+        uint32_t numberOfFiles;
 
-        /* Prepare data and call audio capture function */
+        NAPI_CALL(env, "Failed to get array length", napi_get_array_length(env, argv[1], &numberOfFiles))
 
-        int32_t frameCount = inputDeviceSampleRate / CALLBACKS_PER_SECOND;
+        Engine_clearSimulationPlaylist();
 
-        pthread_mutex_lock(&playbackMutex);
+        for (uint32_t i = 0; i < numberOfFiles && success; i += 1) {
 
-        int32_t iterations = playbackBufferCount;
+            napi_value napi_filename;
 
-        playbackBufferCount = 1;
+            size_t length;
 
-        pthread_mutex_unlock(&playbackMutex);
+            static char filename[FILEPATH_SIZE];
 
-        for (int32_t j = 0; j < iterations; j += 1) {
+            NAPI_CALL(env, "Failed to get array element", napi_get_element(env, argv[1], i, &napi_filename))
 
-            for (int32_t i = 0; i < frameCount; i += 1) simulationBuffer[i] = Simulator_nextSample();
+            NAPI_CALL(env, "Failed to parse string as an array element", napi_get_value_string_utf8(env, napi_filename, filename, FILEPATH_SIZE, &length))
 
-            capture_data_callback(NULL, NULL, (void*)simulationBuffer, frameCount);
+            success = Engine_addToSimulationPlaylist(filename);
 
         }
 
-        /* Check flag */
+        if (success) success = Engine_startSimulationPlaylist(offline, startTime);
 
-        pthread_mutex_lock(&simulationRunningMutex);
+    } else if (enable && type == napi_object) {
 
-        bool running = simulationRunning;
+        /* Generate a synthetic signal */
 
-        pthread_mutex_unlock(&simulationRunningMutex);
+        GN_settings_t settings;
 
-        if (running == false) break;
+        success = getGeneratorSettings(env, argv[1], &settings);
 
-        /* Check the minimum buffer lag */
+        if (success == false) puts("[BACKSTAGE] Generator signal is not recognised");
 
-        counter += 1;
+        if (success) success = Engine_startGenerator(&settings, offline, startTime);
 
-        if (counter == CALLBACKS_PER_SECOND) {
+    } else if (enable && offline) {
 
-            pthread_mutex_lock(&playbackMutex);
+        puts("[BACKSTAGE] Offline processing requires a playlist of WAV files or a generator");
 
-            bufferLag = minimumPlaybackBufferLag;
+        success = false;
 
-            minimumPlaybackBufferLag = INT32_MAX;
+    } else if (enable) {
 
-            pthread_mutex_unlock(&playbackMutex);
+        int32_t index;
 
-            counter = 0;
+        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &index))
 
-        }
+        success = Engine_startSimulationExample(index);
 
-        /* Calculate delay period to wait for next update */
+    } else {
 
-        uint32_t interval;
+        Engine_stopSimulation();
 
-        uint32_t microseconds = Time_getMicroseconds();
+    }
 
-        if (bufferLag < MAXIMUM_PLAYBACK_LAG) {
+    /* Return boolean value */
 
-            interval = MICROSECONDS_IN_SECOND / (CALLBACKS_PER_SECOND + TARGET_MINIMUM_PLAYBACK_LAG - bufferLag);
+    return success ? napi_value_true : napi_value_false;
 
-        } else {
+}
 
-            interval = MICROSECONDS_IN_SECOND / CALLBACKS_PER_SECOND;
+napi_value setMonitor(napi_env env, napi_callback_info info) {
 
-        }
+    size_t argc = 3;
+    napi_value argv[3];
 
-        uint32_t delay = interval - microseconds % interval;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-        usleep(delay);
+    int32_t mode;
 
-    }
+    int32_t numberOfChannels = 1;
 
-    pthread_mutex_lock(&stopStartMutex);
+    int32_t frequencies[HETERODYNE_MAXIMUM_CHANNELS] = {0};
 
-    stopped = true;
+    float pans[HETERODYNE_MAXIMUM_CHANNELS] = {0};
 
-    pthread_mutex_unlock(&stopStartMutex);
+    int32_t division = DEFAULT_FREQUENCY_DIVISION;
 
-    return NULL;
-    
-}
-
-/* Static capture functions */
-
-static void captureAudioBuffer(int32_t duration) {
-
-    /* Read local time offset */
-
-    pthread_mutex_lock(&localTimeMutex);
-
-    captureBufferLocalTimeOffset = useLocalTime ? Time_getLocalTimeOffset() : 0;
-
-    pthread_mutex_unlock(&localTimeMutex);
-
-    /* Capture current parameters */
-
-    pthread_mutex_lock(&audioBufferMutex);
-
-    captureBufferWriteIndex = audioBufferWriteIndex;
-
-    captureBufferSampleCount = audioBufferSampleCount;
-
-    captureBufferStartTime = audioBufferStartTime + captureBufferLocalTimeOffset * MILLISECONDS_IN_SECOND;
-    
-    pthread_mutex_unlock(&audioBufferMutex);   
-
-    captureBufferSampleRate = currentSampleRate;
-
-    strncpy(captureBufferDeviceCommentName, inputDeviceCommentName, DEVICE_NAME_SIZE);
-
-    /* Calculate the capture duration and the start time */
-
-    int64_t requestedDurationInSamples = duration * captureBufferSampleRate;
-
-    int64_t capturedDurationInSamples = MIN(requestedDurationInSamples, captureBufferSampleCount);
-
-    captureBufferStartTime += ROUNDED_DIV(captureBufferSampleCount * MILLISECONDS_IN_SECOND, (int64_t)captureBufferSampleRate);
-
-    captureBufferStartTime -= ROUNDED_DIV(capturedDurationInSamples * MILLISECONDS_IN_SECOND, (int64_t)captureBufferSampleRate);
-
-    captureBufferLength = (int32_t)capturedDurationInSamples;
-
-    /* Copy the data into the capture buffer */
-
-    int32_t offset = captureBufferLength - captureBufferWriteIndex;
-
-    if (offset < 0) {
-
-        memcpy(captureBuffer, audioBuffer - offset, captureBufferLength * NUMBER_OF_BYTES_IN_SAMPLE);
-
-    } else {
-
-        int32_t remainder = captureBufferLength - offset;
-
-        memcpy(captureBuffer, audioBuffer + AUDIO_BUFFER_SIZE - offset, offset * NUMBER_OF_BYTES_IN_SAMPLE);
-
-        memcpy(captureBuffer + offset, audioBuffer, remainder * NUMBER_OF_BYTES_IN_SAMPLE);
-
-    }
-
-}
-
-static void *captureBufferThreadBody(void *ptr) {
-
-    static WAV_header_t captureHeader;
-
-    static char captureFilename[FILENAME_SIZE];
-
-    static char captureBufferFileDestination[FILEPATH_SIZE];
-
-    int32_t time = captureBufferStartTime / MILLISECONDS_IN_SECOND;
-
-    int32_t milliseconds = captureBufferStartTime % MILLISECONDS_IN_SECOND;
-
-    /* Get the file destination */
-
-    pthread_mutex_lock(&fileDestinationMutex);
-
-    bool destinationSet = fileDestinationSet;
-
-    memcpy(captureBufferFileDestination, fileDestination, FILEPATH_SIZE);
-
-    pthread_mutex_unlock(&fileDestinationMutex);
-
-    /* Write the output WAV file */
-
-    captureBufferSuccess = false;
-
-    if (captureBufferLength > 0 && destinationSet == true) {
-
-        WavFile_initialiseHeader(&captureHeader);
-
-        WavFile_setHeaderDetails(&captureHeader, captureBufferSampleRate, captureBufferLength);
-
-        WavFile_setHeaderComment(&captureHeader, time, milliseconds, captureBufferLocalTimeOffset, captureBufferDeviceCommentName);
-
-        WavFile_setFilename(captureFilename, time, milliseconds, captureBufferFileDestination);
-
-        captureBufferSuccess = WavFile_writeFile(&captureHeader, captureFilename, captureBuffer, captureBufferLength, NULL, 0);
-
-    }
-
-    /* Initialise the callback */
-
-    napi_acquire_threadsafe_function(captureBufferThreadSafeCallback);
-
-    napi_call_threadsafe_function(captureBufferThreadSafeCallback, &captureBufferSuccess, napi_tsfn_nonblocking);
-
-    napi_release_threadsafe_function(captureBufferThreadSafeCallback, napi_tsfn_release);
-
-    return NULL;
-
-}
-
-/* Background and autosave functions */
-
-static void addAutosaveEvent(AS_event_type_t eventType) {
-
-    AS_event_t event;
-
-    event.type = eventType;
-
-    event.sampleRate = currentSampleRate;
-
-    pthread_mutex_lock(&audioBufferMutex);
-
-    event.currentCount = autosaveSampleCount;
-    event.currentIndex = audioBufferWriteIndex;
- 
-    event.startTime = autosaveStartTime;
-    event.startCount = autosaveStartSampleCount;
-
-    pthread_mutex_unlock(&audioBufferMutex);
-
-    memcpy(event.inputDeviceCommentName, inputDeviceCommentName, DEVICE_NAME_SIZE);
-
-    Autosave_addEvent(&event);
-
-}
-
-/* Private function */
-
-static void formatFileTime(char *buffer, time_t start, time_t stop, int32_t timeOffset) {
-
-    struct tm time;
-
-    time_t rawTime = start + timeOffset;
-
-    Time_gmTime(&rawTime, &time);
-
-    buffer += sprintf(buffer, "%02d:%02d:%02d to ", time.tm_hour, time.tm_min, time.tm_sec);
-
-    rawTime = stop + timeOffset;
-
-    Time_gmTime(&rawTime, &time);
-
-    buffer += sprintf(buffer, "%02d:%02d:%02d (UTC", time.tm_hour, time.tm_min, time.tm_sec);
-
-    int32_t timeOffsetMinutes = timeOffset / SECONDS_IN_MINUTE;
-
-    int32_t timezoneHours = timeOffsetMinutes / MINUTES_IN_HOUR;
-
-    int32_t timezoneMinutes = timeOffsetMinutes % MINUTES_IN_HOUR;
-
-    if (timezoneHours < 0) {
-
-        buffer += sprintf(buffer, "%d", timezoneHours);
-
-    } else if (timezoneHours > 0) {
-
-        buffer += sprintf(buffer, "+%d", timezoneHours);
-
-    } else {
-
-        if (timezoneMinutes < 0) buffer += sprintf(buffer, "-0");
-
-        if (timezoneMinutes > 0) buffer += sprintf(buffer, "+0");
-
-    }
-
-    if (timezoneMinutes < 0) buffer += sprintf(buffer, ":%02d", -timezoneMinutes);
-
-    if (timezoneMinutes > 0) buffer += sprintf(buffer, ":%02d", timezoneMinutes);
-
-    sprintf(buffer, ")");
-
-}
-
-static bool writeAutosaveFile(int32_t duration) {
-
-    bool success = false;
-
-    static WAV_header_t autosaveHeader;
-
-    static int32_t previousLocalTimeOffset = 0;
-
-    static int32_t autosavePreviousDuration = 0;
-
-    static char autosaveFilename[FILENAME_SIZE];
-
-    static time_t autosaveFilePreviousStopTime = 0;
-
-    static char autosaveFileDestination[FILEPATH_SIZE];
-    
-    static char autosavePreviousFileDestination[FILEPATH_SIZE];
-
-    if (duration == 0) return true;
-
-    /* Get the file destination */
-
-    pthread_mutex_lock(&fileDestinationMutex);
-
-    bool destinationSet = fileDestinationSet;
-
-    memcpy(autosaveFileDestination, fileDestination, FILEPATH_SIZE);
-
-    pthread_mutex_unlock(&fileDestinationMutex);
-
-    if (destinationSet == false) return false;
-
-    /* Read local time offset */
-
-    pthread_mutex_lock(&localTimeMutex);
-
-    int32_t localTimeOffset = useLocalTime ? Time_getLocalTimeOffset() : 0;
-
-    pthread_mutex_unlock(&localTimeMutex);
-
-    /* Get current autosave duration */
-
-    pthread_mutex_lock(&autosaveMutex);
-
-    if (autosaveDuration > 0) autosavePreviousDuration = autosaveDuration;
-
-    pthread_mutex_unlock(&autosaveMutex);
-
-    /* Determine whether file should be appended */
-
-    struct tm timeStart;
-
-    time_t rawTimeStart = autosaveFileStartTime;
-
-    Time_gmTime(&rawTimeStart, &timeStart);
-    
-    bool append = localTimeOffset == previousLocalTimeOffset;
-
-    append &= strcmp(autosaveFileDestination, autosavePreviousFileDestination) == 0;
-    
-    append &= autosaveFileStartTime == autosaveFilePreviousStopTime;
-
-    append &= timeStart.tm_sec == 0 && timeStart.tm_min % autosavePreviousDuration > 0;
-
-    memcpy(autosavePreviousFileDestination, autosaveFileDestination, FILEPATH_SIZE);
-
-    autosaveFilePreviousStopTime = autosaveFileStartTime + duration;
-
-    previousLocalTimeOffset = localTimeOffset;
-
-    /* Write the output WAV file */
-
-    int32_t numberOfSamples = duration * autosaveFileSampleRate;
-
-    int32_t overlap = autosaveFileStartIndex + numberOfSamples - AUDIO_BUFFER_SIZE;
-
-    if (append == true) {
-
-        if (overlap < 0) {
-
-            success = WavFile_appendFile(autosaveFilename, audioBuffer + autosaveFileStartIndex, numberOfSamples, NULL, 0);
-
-        } else {
-
-            success = WavFile_appendFile(autosaveFilename, audioBuffer + autosaveFileStartIndex, numberOfSamples - overlap, audioBuffer, overlap);
-
-        }
-
-    }
-
-    if (append == false || success == false) {
-
-        WavFile_initialiseHeader(&autosaveHeader);
-
-        WavFile_setHeaderDetails(&autosaveHeader, autosaveFileSampleRate, numberOfSamples);
-
-        WavFile_setHeaderComment(&autosaveHeader, (int32_t)autosaveFileStartTime + localTimeOffset, -1, localTimeOffset, autosaveInputDeviceCommentName);
-
-        WavFile_setFilename(autosaveFilename, (int32_t)autosaveFileStartTime + localTimeOffset, -1, autosaveFileDestination);
-
-        if (overlap < 0) {
-
-            success = WavFile_writeFile(&autosaveHeader, autosaveFilename, audioBuffer + autosaveFileStartIndex, numberOfSamples, NULL, 0);
-
-        } else {
-
-            success = WavFile_writeFile(&autosaveHeader, autosaveFilename, audioBuffer + autosaveFileStartIndex, numberOfSamples - overlap, audioBuffer, overlap);
-
-        }
-
-    }
-
-    /* Log output file */
-
-    static char buffer[FILE_TIME_BUFFER];
-
-    formatFileTime(buffer, autosaveFileStartTime, autosaveFilePreviousStopTime, localTimeOffset);
-
-    printf("[AUTOSAVE] %s\n", buffer);
-
-    /* Return status */
-
-    return success;
-
-}
-
-static bool makeMinuteTransitionRecording() {
-
-    /* Generate partial recording */
-
-    int64_t sampleCountDifference = autosaveTargetCount - autosaveFileStartCount;
-
-    int32_t duration = (int32_t)(sampleCountDifference / autosaveFileSampleRate);
-
-    bool success = writeAutosaveFile(duration);
-
-    /* Update for next minute transition */
-
-    autosaveFileStartTime += duration;
-
-    autosaveFileStartIndex = (autosaveFileStartIndex + sampleCountDifference) % AUDIO_BUFFER_SIZE;
-
-    autosaveFileStartCount = autosaveTargetCount;
-
-    autosaveTargetCount = autosaveFileStartCount + SECONDS_IN_MINUTE * autosaveFileSampleRate;
-
-    return success;
-
-}
-
-static void updateForMillisecondOffset(int32_t milliseconds) {
-
-    /* Update count, index and time for millisecond offset */
-
-    if (milliseconds > 0) {
-        
-        int32_t millisecondOffset = MILLISECONDS_IN_SECOND - milliseconds;
-
-        int32_t sampleOffset = ROUNDED_DIV(autosaveFileSampleRate * millisecondOffset, MILLISECONDS_IN_SECOND);
-
-        autosaveFileStartCount += sampleOffset;
-
-        autosaveFileStartIndex = (autosaveFileStartIndex + sampleOffset) % AUDIO_BUFFER_SIZE;
-
-        autosaveFileStartTime += 1;
-
-    }
-
-    /* Calculate target sample count for the next minute transition */
-
-    struct tm time;
-
-    time_t rawTime = autosaveFileStartTime;
-
-    Time_gmTime(&rawTime, &time);
-
-    autosaveTargetCount = autosaveFileStartCount + (SECONDS_IN_MINUTE - time.tm_sec) * autosaveFileSampleRate;
-
-}
-
-static void *backgroundThreadBody(void *ptr) {
-
-    static AS_event_t event;
-
-    puts("[BACKGROUND] Started");
-    
-    while (true) {
-
-        /* Check for AudioMoth */
-
-        pthread_mutex_lock(&backgroundDeviceCheckMutex);
-
-        device_check_t device_check = checkForAudioMoth(&deviceCheckContext, false);
-
-        bool audioMothFound = device_check.audioMothFound;
-
-        bool oldAudioMothFound = device_check.oldAudioMothFound;
-
-        pthread_mutex_unlock(&backgroundDeviceCheckMutex);
-
-        pthread_mutex_lock(&backgroundMutex);
-
-        if (backgroundDeviceCheckFoundAudioMoth != audioMothFound) puts(audioMothFound ? "[BACKGROUND] AudioMoth connected" : "[BACKGROUND] AudioMoth disconnected");
-
-        backgroundDeviceCheckTime = ma_timer_get_time_in_seconds(&timer);
-
-        backgroundDeviceCheckFoundAudioMoth = audioMothFound;
-
-        backgroundDeviceCheckFoundOldAudioMoth = oldAudioMothFound;
-
-        pthread_mutex_unlock(&backgroundMutex);
-
-        /* Get current sample count and autosave duration */
-
-        pthread_mutex_lock(&audioBufferMutex);
-
-        int64_t currentSampleCount = autosaveSampleCount;
-
-        pthread_mutex_unlock(&audioBufferMutex);
-
-        /* Process autosave events */
-
-        bool success = true;
-
-        while (Autosave_hasEvents()) {
-
-            /* Copy and remove first event */
-
-            Autosave_getFirstEvent(&event);
-
-            /* Process event */
-
-            if (autosaveWaitingForStartEvent && event.type == AS_START) {
-
-                puts("[AUTOSAVE] Start");
-
-                /* Set sample rate and device */
-
-                autosaveFileSampleRate = event.sampleRate;
-
-                memcpy(autosaveInputDeviceCommentName, event.inputDeviceCommentName, DEVICE_NAME_SIZE);
-
-                /* Adjust start time to match current count and index */
-
-                int64_t countDifference = event.currentCount - event.startCount;
-
-                int64_t updatedStartTime = event.startTime + ROUNDED_DIV(countDifference * MILLISECONDS_IN_SECOND, autosaveFileSampleRate);
-
-                int32_t milliseconds = updatedStartTime % MILLISECONDS_IN_SECOND;
-
-                autosaveFileStartTime = updatedStartTime / MILLISECONDS_IN_SECOND;
-
-                autosaveFileStartCount = event.currentCount;
-
-                autosaveFileStartIndex = event.currentIndex;
-
-                /* Update start time, count and index for millisecond offset */
-
-                updateForMillisecondOffset(milliseconds); 
-
-                /* Reset flag */
-                
-                autosaveWaitingForStartEvent = false;
-
-            }
-
-            if (currentSampleCount >= autosaveTargetCount && autosaveTargetCount < event.currentCount) {
-
-                success &= makeMinuteTransitionRecording();
-
-            }
-
-            if (event.type == AS_RESTART) {
-
-                /* Write samples since last start to file */
-
-                int32_t duration = (int32_t)(event.startCount - autosaveFileStartCount) / autosaveFileSampleRate;
-
-                success &= writeAutosaveFile(duration);
-
-                /* Set sample rate and device */
-
-                autosaveFileSampleRate = event.sampleRate;
-
-                memcpy(autosaveInputDeviceCommentName, event.inputDeviceCommentName, DEVICE_NAME_SIZE);
-
-                /* Adjust current index to match start time and count */
-
-                int32_t milliseconds = event.startTime % MILLISECONDS_IN_SECOND;
-
-                autosaveFileStartTime = event.startTime / MILLISECONDS_IN_SECOND;
-
-                autosaveFileStartCount = event.startCount;
-
-                int64_t countDifference = (event.currentCount - event.startCount);
-
-                autosaveFileStartIndex = (AUDIO_BUFFER_SIZE + event.currentIndex - countDifference) % AUDIO_BUFFER_SIZE;
-
-                /* Update start time, count and index for millisecond offset */
-
-                updateForMillisecondOffset(milliseconds);
-
-            }
-
-            if (event.type == AS_STOP) {
-
-                puts("[AUTOSAVE] Stop");
-
-                /* Write samples since last start to file */
-
-                int32_t duration = (int32_t)(event.currentCount - autosaveFileStartCount) / autosaveFileSampleRate;
-
-                success &= writeAutosaveFile(duration);
-
-                /* Reset flags */
-
-                autosaveWaitingForStartEvent = true;
-
-                autosaveTargetCount = INT64_MAX;
-
-            }
-
-            if (event.type == AS_SHUTDOWN) {
-
-                puts("[AUTOSAVE] Shutdown starting");
-
-                if (autosaveWaitingForStartEvent == false) {
-
-                    /* Write samples since last start to file */
-
-                    int32_t duration = (int32_t)(event.currentCount - autosaveFileStartCount) / autosaveFileSampleRate;
-
-                    writeAutosaveFile(duration);
-
-                }
-
-                pthread_mutex_lock(&autosaveMutex);
-
-                autosaveShutdownCompleted = true;
-
-                pthread_mutex_unlock(&autosaveMutex);
-
-                /* Reset flags */
-
-                autosaveWaitingForStartEvent = true;
-
-                autosaveTargetCount = INT64_MAX;
-
-            }
-
-        }
-
-        if (currentSampleCount >= autosaveTargetCount) {
-
-            success &= makeMinuteTransitionRecording();
-
-        }
-
-        /* Thread safe callback */
-
-        if (success == false) {
-
-            puts("[AUTOSAVE] Could not write WAV file");
-
-            napi_acquire_threadsafe_function(autosaveThreadSafeCallback);
-
-            napi_call_threadsafe_function(autosaveThreadSafeCallback, NULL, napi_tsfn_nonblocking);
-
-            napi_release_threadsafe_function(autosaveThreadSafeCallback, napi_tsfn_release);
-
-        }
-
-        /* Calculate delay period to wait for next update */
-
-        uint32_t microseconds = Time_getMicroseconds();
-
-        uint32_t delay = DEVICE_CHECK_INTERVAL - microseconds % DEVICE_CHECK_INTERVAL;
-
-        usleep(delay);
-
-    }
-
-    return NULL;
-
-}
-
-/* Exported functions */
-
-napi_value initialise(napi_env env, napi_callback_info info) {
-
-    bool success = true;
-
-    puts("[BACKSTAGE] initialise");
-
-    /* Initialise timers */
-
-    ma_timer_init(&timer);
-
-    /* Initialise the contexts */
-
-    ma_result result = ma_context_init(NULL, 0, NULL, &deviceCheckContext);
-
-    if (result != MA_SUCCESS) {
-        
-        puts("[BACKSTAGE] Could not initialise device check context");
-
-        success = false;
-
-    }
-
-    result = ma_context_init(NULL, 0, NULL, &playbackContext);
-
-    if (result != MA_SUCCESS) {
-        
-        puts("[BACKSTAGE] Could not initialise playback context");
-
-        success = false;
-
-    }
-
-    /* Initialise autosave queue */
-
-    bool initialised = Autosave_initialise(AUTOSAVE_EVENT_QUEUE_SIZE);
-
-    if (initialised == false) {
-        
-        puts("[BACKSTAGE] Could not initialise autosave queue");
-
-        success = false;
-
-    }
-
-    /* Initialise STFT */
-
-    STFT_initialise();
-
-    /* Initialise the heterodyne mixer */
-
-    Heterodyne_initialise(MAXIMUM_SAMPLE_RATE, 45000); 
-
-    /* Initialise mutexes */
-
-    pthread_mutex_init(&playbackMutex, NULL);
-
-    pthread_mutex_init(&autosaveMutex, NULL);
-
-    pthread_mutex_init(&localTimeMutex, NULL);
-
-    pthread_mutex_init(&stopStartMutex, NULL);
-
-    pthread_mutex_init(&backgroundMutex, NULL);
-
-    pthread_mutex_init(&audioBufferMutex, NULL);
-
-    pthread_mutex_init(&fileDestinationMutex, NULL);
-
-    pthread_mutex_init(&simulationRunningMutex, NULL);
-
-    pthread_mutex_init(&backgroundDeviceCheckMutex, NULL);
-
-    /* Generate the NAPI components */
-
-    NAPI_CALL(env, "Failed to create true value", napi_get_null(env, &napi_value_null))
-
-    NAPI_CALL(env, "Failed to create true value", napi_get_boolean(env, true, &napi_value_true))
-
-    NAPI_CALL(env, "Failed to create false value", napi_get_boolean(env, false, &napi_value_false))
-
-    NAPI_CALL(env, "Failed to create undefined value", napi_get_undefined(env, &napi_value_undefined))
-
-    NAPI_CALL(env, "Failed to create array buffer value", napi_create_arraybuffer(env, NUMBER_OF_BYTES_IN_SAMPLE * AUDIO_BUFFER_SIZE, (void**)&audioBuffer, &napi_audioArrayBuffer))
-
-    NAPI_CALL(env, "Failed to create typed array value", napi_create_typedarray(env, napi_int16_array, AUDIO_BUFFER_SIZE, napi_audioArrayBuffer, 0, &napi_audioTypedArray))
-
-    NAPI_CALL(env, "Failed to create array buffer value", napi_create_arraybuffer(env, NUMBER_OF_BYTES_IN_FLOAT32 * AUDIO_BUFFER_SIZE / STFT_INPUT_OUTPUT_RATIO, (void**)&stftBuffer, &napi_stftArrayBuffer))
-
-    NAPI_CALL(env, "Failed to create typed array value", napi_create_typedarray(env, napi_float32_array, AUDIO_BUFFER_SIZE / STFT_INPUT_OUTPUT_RATIO, napi_stftArrayBuffer, 0, &napi_stftTypedArray))
-
-    /* Start the background thread */
-
-    pthread_create(&backgroundThread, NULL, backgroundThreadBody, NULL);
-
-    /* Reset the start flag */
-
-    pthread_mutex_lock(&stopStartMutex);
-
-    started = false;
-
-    pthread_mutex_unlock(&stopStartMutex);
-        
-    /* Start device */
-
-    pthread_mutex_lock(&backgroundDeviceCheckMutex);
-
-    device_check_t device_check = checkForAudioMoth(&deviceCheckContext, true);
-
-    usingAudioMoth = device_check.audioMothFound;
-
-    bool startedMicrophone = startMicrophone(&deviceCheckContext, usingAudioMoth);
-
-    pthread_mutex_unlock(&backgroundDeviceCheckMutex);
-
-    puts(usingAudioMoth ? "[BACKSTAGE] Started AudioMoth" : "[BACKSTAGE] Started default device");
-
-    if (startedMicrophone == false) {
-        
-        puts("[BACKSTAGE] Failed to start capture");
-
-        success = false;
-
-    }
-
-    /* Wait for device to start */
-
-    bool threadStarted = false;
-
-    double startTime = ma_timer_get_time_in_seconds(&timer);
-
-    while (threadStarted == false) {
-
-        double currentTime = ma_timer_get_time_in_seconds(&timer);
-
-        if (currentTime - startTime > DEVICE_STOP_START_TIMEOUT) {
-
-            puts("[BACKSTAGE] Timed out waiting for device to start");
-
-            break;
-
-        }
-
-        pthread_mutex_lock(&stopStartMutex);
-
-        threadStarted = started;
-
-        pthread_mutex_unlock(&stopStartMutex);
-
-    }
-
-    success &= threadStarted;
-
-    /* Return typed array */
-
-    napi_value jsObj;
-
-    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj));
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "success", success ? napi_value_true : napi_value_false));
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioBuffer", napi_audioTypedArray));
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "stftBuffer", napi_stftTypedArray));
-
-    return jsObj;
-
-}
-
-napi_value changeSampleRate(napi_env env, napi_callback_info info) {
-
-    size_t argc = 1;
-    napi_value argv[1];
-
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
-
-    int32_t number;
-
-    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &number))
-
-    printf("[BACKSTAGE] changeSampleRate - %d\n", number);
-
-    for (uint32_t i = 0; i < NUMBER_OF_VALID_SAMPLE_RATES; i += 1) {
-
-        if (number == validSampleRates[i] && number != requestedSampleRate) {
-            
-            requestedSampleRate = number;
-
-            requestedSampleRateChanged = true;
-
-            break;
-
-        }
-
-    }
-
-    /* Return null value */
-
-    return napi_value_null;
-
-}
-
-napi_value getFrame(napi_env env, napi_callback_info info) {
-
-    /* Determine the offset and length for update and all data */
-
-    pthread_mutex_lock(&audioBufferMutex);
-
-    int32_t audioIndex = frontEndPaused ? captureBufferWriteIndex : audioBufferWriteIndex;
-
-    int64_t audioCount = frontEndPaused ? captureBufferSampleCount : audioBufferSampleCount;
-
-    int64_t unpausedAudioCount = audioBufferSampleCount;
-
-    int64_t audioTime = audioBufferStartTime;
-
-    pthread_mutex_unlock(&audioBufferMutex);
-
-    /* Calculate unpaused audio time */
-
-    int64_t unpausedAudioTime = audioTime + ROUNDED_DIV(unpausedAudioCount * MILLISECONDS_IN_SECOND, currentSampleRate);
-
-    /* Apply time corrections */
-
-    pthread_mutex_lock(&localTimeMutex);
-
-    int64_t localTimeOffset = useLocalTime ? Time_getLocalTimeOffset() : 0;
-
-    pthread_mutex_unlock(&localTimeMutex);
-
-    audioTime += ROUNDED_DIV(audioCount * MILLISECONDS_IN_SECOND, currentSampleRate);
-
-    audioTime += localTimeOffset * MILLISECONDS_IN_SECOND;
-
-    /* Read the simulation state */
-
-    pthread_mutex_lock(&simulationRunningMutex);
-
-    bool simulationFlag = simulationRunning;
-
-    pthread_mutex_unlock(&simulationRunningMutex);
-
-    /* Check the audio time against the current time */
-
-    int64_t currentTime = Time_getMillisecondUTC();
-
-    bool timeMismatch = simulationFlag == false && ABS(currentTime - unpausedAudioTime) > TIME_MISMATCH_LIMIT;
-
-    /* Check if the device has changed */
-
-    bool deviceChanged = false;
-
-    bool setOldAudioMothFoundFlag = false;
-
-    static bool oldAudioMothFound = false;
-
-    pthread_mutex_lock(&backgroundMutex);
-
-    if (backgroundDeviceCheckTime - timeDeviceStarted > DEVICE_CHANGE_INTERVAL) {
-
-        if (backgroundDeviceCheckFoundAudioMoth == true && usingAudioMoth == false) deviceChanged = true;
-    
-        if (backgroundDeviceCheckFoundAudioMoth == false && usingAudioMoth == true) deviceChanged = true;
-
-        if (backgroundDeviceCheckFoundOldAudioMoth && oldAudioMothFound == false) setOldAudioMothFoundFlag = true;
-
-        oldAudioMothFound = backgroundDeviceCheckFoundOldAudioMoth;
-
-    }
-
-    pthread_mutex_unlock(&backgroundMutex);
-
-    /* Check if sample rate has changed */
-
-    bool sampleRateChanged = false;
-
-    if (requestedSampleRateChanged) {
-
-        sampleRateChanged = currentSampleRate != MIN(requestedSampleRate, inputDeviceSampleRate);
-
-        requestedSampleRateChanged = false;
-
-    }
-
-    /* Generate return object */
-
-    napi_value jsObj;
-
-    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj));
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "redrawRequired", !frontEndPaused && shouldSetRedrawFlag ? napi_value_true : napi_value_false));
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "simulationRunning", simulationFlag ? napi_value_true : napi_value_false));
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "oldAudioMothFound", setOldAudioMothFoundFlag ? napi_value_true : napi_value_false));
-
-    napi_value napi_deviceName;
-
-    NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, inputDeviceName, NAPI_AUTO_LENGTH, &napi_deviceName))
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "deviceName",napi_deviceName))
-
-    napi_value napi_maximumSampleRate;
-
-    NAPI_CALL(env, "Failed to create value", napi_create_int32(env, usingAudioMoth ? audioMothSampleRate : maximumDefaultSampleRate, &napi_maximumSampleRate))
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "maximumSampleRate", napi_maximumSampleRate))
-
-    napi_value napi_currentSampleRate;
-
-    NAPI_CALL(env, "Failed to create value", napi_create_int32(env, currentSampleRate, &napi_currentSampleRate))
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "currentSampleRate", napi_currentSampleRate))
-
-    napi_value napi_audioTime;
-
-    NAPI_CALL(env, "Failed to create value", napi_create_double(env, (double)audioTime, &napi_audioTime))
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioTime", napi_audioTime))
-
-    napi_value napi_audioIndex;
-
-    NAPI_CALL(env, "Failed to create value", napi_create_double(env, (double)audioIndex, &napi_audioIndex))
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioIndex", napi_audioIndex))
-
-    napi_value napi_audioCount;
-
-    NAPI_CALL(env, "Failed to create value", napi_create_double(env, (double)audioCount, &napi_audioCount))
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioCount", napi_audioCount))
-
-    /* Actions to take this frame */
-
-    bool shouldRestart = false;
-
-    bool shouldStopDevice = false;
-
-    bool shouldStartDevice = false;
-
-    bool shouldStopSimulationThread = false;
-
-    bool shouldStartSimulationThread = false;
-
-    if (!frontEndPaused) shouldSetRedrawFlag = false;
-
-    /* Determine actions to take */
-
-    if (deviceChanged && simulationFlag == false) {
-
-        shouldStopDevice = true;
-
-        shouldRestart = true;
-
-        shouldStartDevice = true;
-
-        deviceChanged = false;
-
-    } else if (timeMismatch || sampleRateChanged) {
-
-        if (timeMismatch) puts("[BACKSTAGE] Restarting due to time mismatch");
-        
-        if (simulationFlag == false) {
-
-            shouldStopDevice = true;
-
-        } else {
-
-            shouldStopSimulationThread = true;
-
-        }
-        
-        shouldRestart = true;
-
-        if (simulationFlag == false) {
-
-            shouldStartDevice = true;
-
-        } else {
-
-            shouldStartSimulationThread = true;
-
-        }
-        
-    } else if (maximumDefaultSampleRateChanged) {
-
-        bool sampleRateChanged = requestedMaximumDefaultSampleRate != maximumDefaultSampleRate;
-
-        maximumDefaultSampleRate = requestedMaximumDefaultSampleRate;
-
-        if (usingAudioMoth == false && simulationFlag == false && sampleRateChanged) {
-
-            shouldStopDevice = true;
-
-            shouldRestart = true;
-
-            shouldStartDevice = true;
-
-        }
-
-        maximumDefaultSampleRateChanged = false;
-
-    } else if (shouldStartSimulation) {
-
-        if (simulationFlag == false) {
-
-            shouldStopDevice = true;
-
-        } else {
-
-            shouldStopSimulationThread = true;
-
-        }
-
-        shouldRestart = true;
-
-        shouldStartSimulationThread = true;
-
-        shouldStartSimulation = false;
-
-    } else if (shouldStopSimulation) {
-
-        if (simulationFlag) {
-
-            shouldStopSimulationThread = true;
-
-            shouldRestart = true;
-
-            shouldStartDevice = true;
-
-        }
-
-        shouldStopSimulation = false;
-
-    }
-
-    /* Implement the actions determined above */
-
-    if (shouldStopDevice || shouldStopSimulationThread) {
-
-        /* Reset the stopped flag */
-
-        pthread_mutex_lock(&stopStartMutex);
-
-        stopped = false;
-
-        pthread_mutex_unlock(&stopStartMutex);
-
-        /* Stop the device or simulation */
-
-        if (shouldStopDevice) {
-            
-            puts(usingAudioMoth ? "[BACKSTAGE] Stop AudioMoth" : "[BACKSTAGE] Stop default device");
-
-            pthread_mutex_lock(&backgroundDeviceCheckMutex);
-
-            stopMicrophone();
-
-            pthread_mutex_unlock(&backgroundDeviceCheckMutex);
-
-        }
-
-        if (shouldStopSimulationThread) {
-
-            puts("[BACKSTAGE] Stop simulation thread");
-
-            pthread_mutex_lock(&simulationRunningMutex);
-
-            simulationRunning = false;
-
-            pthread_mutex_unlock(&simulationRunningMutex);
-
-        }
-
-        /* Wait for device to stop */
-
-        bool threadStopped = false;
-
-        double startTime = ma_timer_get_time_in_seconds(&timer);
-
-        while (threadStopped == false) {
-
-            double currentTime = ma_timer_get_time_in_seconds(&timer);
-
-            if (currentTime - startTime > DEVICE_STOP_START_TIMEOUT) {
-
-                if (IS_WINDOWS == false && shouldStopDevice) puts("[BACKSTAGE] Timed out waiting for device to stop");
-
-                if (shouldStopSimulationThread) puts("[BACKSTAGE] Timed out waiting for simulation thread to stop");
-
-                break;
-
-            }
-
-            pthread_mutex_lock(&stopStartMutex);
-
-            threadStopped = stopped;
-
-            pthread_mutex_unlock(&stopStartMutex);
-
-        }
-
-    }
-
-    if (shouldRestart) {
-
-        /* Reset buffer indices */
-
-        pthread_mutex_lock(&audioBufferMutex);
-
-        audioBufferSampleCount = 0;
-
-        audioBufferIndex -= audioBufferIndex % STFT_INPUT_SAMPLES;
-
-        pthread_mutex_unlock(&audioBufferMutex);
-
-        /* Reset playback indices */
-
-        pthread_mutex_lock(&playbackMutex);
-
-        playbackBufferCount = 0;
-
-        playbackReadIndex = audioBufferWriteIndex;
-
-        pthread_mutex_unlock(&playbackMutex);
-
-        /* Set redraw flags */
-    
-        shouldSetRedrawFlag = true;
-
-    }
-
-    if (shouldStartDevice || shouldStartSimulationThread) {
-
-        /* Reset the start flag */
-
-        pthread_mutex_lock(&stopStartMutex);
-
-        started = false;
-
-        pthread_mutex_unlock(&stopStartMutex);
-
-        /* Start the device or simulation */
-
-        if (shouldStartDevice) {
-
-            pthread_mutex_lock(&backgroundDeviceCheckMutex);
-
-            device_check_t device_check = checkForAudioMoth(&deviceCheckContext, true);
-
-            usingAudioMoth = device_check.audioMothFound;
-            
-            startMicrophone(&deviceCheckContext, usingAudioMoth);
-
-            pthread_mutex_unlock(&backgroundDeviceCheckMutex);
-
-            puts(usingAudioMoth ? "[BACKSTAGE] Start AudioMoth" : "[BACKSTAGE] Start default device");
-
-            timeDeviceStarted = ma_timer_get_time_in_seconds(&timer);
-
-        }
-
-        if (shouldStartSimulationThread) {
-
-            Simulator_initialiseExample();
-
-            inputDeviceSampleRate = Simulator_getSampleRate(simulationIndex);
-
-            strncpy(inputDeviceName, "Simulated 384kHz AudioMoth USB Microphone", DEVICE_NAME_SIZE);
-
-            strncpy(inputDeviceCommentName, "a simulated 384kHz AudioMoth USB Microphone", DEVICE_NAME_SIZE);
-
-            currentSampleRate = inputDeviceSampleRate;
-
-            puts("[BACKSTAGE] Start simulation thread");
-
-            pthread_mutex_lock(&simulationRunningMutex);
-
-            simulationRunning = true;
-
-            pthread_mutex_unlock(&simulationRunningMutex);
-                
-            pthread_create(&simulationThread, NULL, simulationThreadBody, NULL);
-
-        }
-
-        /* Wait for device to start */
-
-        bool threadStarted = false;
-
-        double startTime = ma_timer_get_time_in_seconds(&timer);
-
-        while (threadStarted == false) {
-
-            double currentTime = ma_timer_get_time_in_seconds(&timer);
-
-            if (currentTime - startTime > DEVICE_STOP_START_TIMEOUT) {
-
-                if (shouldStartDevice) puts("[BACKSTAGE] Timed out waiting for device to start");
-
-                if (shouldStartSimulationThread) puts("[BACKSTAGE] Timed out waiting for simulation thread to start");
-
-                break;
-
-            }
-
-            pthread_mutex_lock(&stopStartMutex);
-
-            threadStarted = started;
-
-            pthread_mutex_unlock(&stopStartMutex);
-
-        }
-
-        /* Add autosave event */
-
-        pthread_mutex_lock(&autosaveMutex);
-
-        int32_t currentDuration = autosaveDuration;
-
-        pthread_mutex_unlock(&autosaveMutex);
-
-        if (threadStarted && currentDuration > 0) addAutosaveEvent(AS_RESTART);
-
-    }
-
-    /* Return object */
-
-    return jsObj;
-
-}
-
-napi_value clear(napi_env env, napi_callback_info info) {
-
-    puts("[BACKSTAGE] clear");
-
-    /* Reset buffer indices */
-
-    pthread_mutex_lock(&audioBufferMutex);
-
-    int64_t milliseconds = ROUNDED_DIV(audioBufferSampleCount * MILLISECONDS_IN_SECOND, (int64_t)currentSampleRate);
-
-    audioBufferStartTime += milliseconds;
-
-    audioBufferSampleCount = 0;
-   
-    pthread_mutex_unlock(&audioBufferMutex);
-
-    /* Set the reset flag */
-
-    shouldSetRedrawFlag = true;
- 
-    /* Return null value */
-
-    return napi_value_null;
-    
-}
-
-napi_value capture(napi_env env, napi_callback_info info) {
-
-    size_t argc = 2;
-    napi_value argv[2];
-
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
+    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &mode))
 
-    int32_t duration;
+    if (mode == MONITOR_HETERODYNE) {
 
-    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &duration))
+        /* Accept a single frequency or an array of frequencies with optional pan positions */
 
-    printf("[BACKSTAGE] capture - %d\n", duration);
+        bool isArray;
 
-    /* Generate callback function */
+        NAPI_CALL(env, "Failed to parse arguments", napi_is_array(env, argv[1], &isArray))
 
-    napi_value callback = argv[1];
+        if (isArray) {
 
-    napi_value work_name;
+            uint32_t length;
 
-    NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, "Capture Callback", NAPI_AUTO_LENGTH, &work_name))
+            NAPI_CALL(env, "Failed to parse array as an argument", napi_get_array_length(env, argv[1], &length))
 
-    NAPI_CALL(env, "Failed to create threadsafe function", napi_create_threadsafe_function(env, callback, NULL, work_name, 0, 1, NULL, NULL, NULL, threadSafeBooleanCallback, &captureBufferThreadSafeCallback))
+            numberOfChannels = MAX(1, MIN(HETERODYNE_MAXIMUM_CHANNELS, (int32_t)length));
 
-    /* Start thread */
+            for (int32_t i = 0; i < MIN(numberOfChannels, (int32_t)length); i += 1) {
 
-    if (!frontEndPaused) {
+                napi_value element;
 
-        duration = MAX(0, MIN(MAXIMUM_RECORD_DURATION, duration));
-        
-        captureAudioBuffer(duration);
+                NAPI_CALL(env, "Failed to get array element", napi_get_element(env, argv[1], i, &element))
 
-    }
+                NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, element, &frequencies[i]))
 
-    pthread_create(&captureBufferThread, NULL, captureBufferThreadBody, NULL);
-   
-    /* Return null value */
+            }
 
-    return napi_value_null;
-    
-}
+            if (length == 0) frequencies[0] = DEFAULT_HETERODYNE_FREQUENCY;
 
-napi_value setPause(napi_env env, napi_callback_info info) {
+        } else {
 
-    size_t argc = 2;
-    napi_value argv[2];
+            NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &frequencies[0]))
 
-    bool enable;
+        }
 
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
+        if (argc > 2) {
 
-    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
+            uint32_t length;
 
-    int32_t duration;
+            NAPI_CALL(env, "Failed to parse array as an argument", napi_get_array_length(env, argv[2], &length))
 
-    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &duration))
+            for (int32_t i = 0; i < MIN(numberOfChannels, (int32_t)length); i += 1) {
 
-    printf("[BACKSTAGE] setPause - %s, %d\n", enable ? "true" : "false", duration);
+                napi_value element;
 
-    if (enable && !frontEndPaused) {
+                double pan;
 
-        duration = MAX(0, MIN(MAXIMUM_RECORD_DURATION, duration));
+                NAPI_CALL(env, "Failed to get array element", napi_get_element(env, argv[2], i, &element))
 
-        captureAudioBuffer(duration);
+                NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_double(env, element, &pan))
 
-        frontEndPaused = true;
+                pans[i] = (float)MAX(-1.0, MIN(1.0, pan));
 
-    }
+            }
 
-    if (!enable && frontEndPaused) {
+        }
 
-        frontEndPaused = false;
+    } else if (mode == MONITOR_FREQUENCY_DIVISION) {
 
-        shouldSetRedrawFlag = true;
+        if (argc > 1) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &division))
 
     }
 
-    /* Generate return object */
-
-    napi_value jsObj;
-
-    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj));
-
-    if (frontEndPaused) {
-
-        napi_value napi_audioStartTime;
-
-        NAPI_CALL(env, "Failed to create value", napi_create_double(env, (double)captureBufferStartTime, &napi_audioStartTime))
-
-        NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioStartTime", napi_audioStartTime))
-
-        napi_value napi_audioIndex;
+    Engine_setMonitor(mode, numberOfChannels, frequencies, pans, division);
 
-        double audioIndex = captureBufferWriteIndex;
-    
-        NAPI_CALL(env, "Failed to create value", napi_create_double(env, audioIndex, &napi_audioIndex))
-
-        NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioIndex", napi_audioIndex))
-
-        napi_value napi_audioCount;
-
-        double audioCount = captureBufferSampleCount;
-
-        NAPI_CALL(env, "Failed to create value", napi_create_double(env, audioCount, &napi_audioCount))
-
-        NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "audioCount", napi_audioCount))
-
-    }
+    /* Return null value */
 
-    /* Return object */
+    return napi_value_null;
 
-    return jsObj;
-    
 }
 
-napi_value setFileDestination(napi_env env, napi_callback_info info) {
+napi_value setHighDefaultSampleRate(napi_env env, napi_callback_info info) {
 
     size_t argc = 1;
     napi_value argv[1];
 
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
-
-    size_t length;
-
-    static char buffer[FILEPATH_SIZE];
-
-    NAPI_CALL(env, "Failed to parse string as an argument", napi_get_value_string_utf8(env, argv[0], buffer, FILEPATH_SIZE, &length))
-
-    printf("[BACKSTAGE] setFileDestination - %s\n", buffer);
-
-    pthread_mutex_lock(&fileDestinationMutex);
+    bool enable;
 
-    memcpy(fileDestination, buffer, FILEPATH_SIZE);
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    fileDestinationSet = true;
+    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
 
-    pthread_mutex_unlock(&fileDestinationMutex);
+    Engine_setHighDefaultSampleRate(enable);
 
     /* Return null value */
 
     return napi_value_null;
-    
+
 }
 
-napi_value setAutoSaveCallback(napi_env env, napi_callback_info info) {
+napi_value setLocalTime(napi_env env, napi_callback_info info) {
 
     size_t argc = 1;
     napi_value argv[1];
 
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
-
-    puts("[BACKSTAGE] setAutoSaveCallback");
-
-    /* Generate callback function */
-
-    napi_value callback = argv[0];
+    bool enable;
 
-    napi_value work_name;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, "Autosave Callback", NAPI_AUTO_LENGTH, &work_name))
+    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
 
-    NAPI_CALL(env, "Failed to create threadsafe function", napi_create_threadsafe_function(env, callback, NULL, work_name, 0, 1, NULL, NULL, NULL, threadSafeNullCallback, &autosaveThreadSafeCallback))
+    Engine_setLocalTime(enable);
 
     /* Return null value */
 
@@ -2264,290 +894,139 @@ napi_value setAutoSaveCallback(napi_env env, napi_callback_info info) {
 
 }
 
-napi_value setAutoSave(napi_env env, napi_callback_info info) {
-
-    size_t argc = 1;
-    napi_value argv[1];
-
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
-
-    int32_t duration;
-
-    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &duration))
-
-    printf("[BACKSTAGE] setAutoSave - %d\n", duration);
-
-    pthread_mutex_lock(&autosaveMutex);
-
-    int32_t currentDuration = autosaveDuration;
-
-    pthread_mutex_unlock(&autosaveMutex);
-
-    if (currentDuration == 0 && duration > 0) addAutosaveEvent(AS_START);
-
-    if (currentDuration > 0 && duration == 0) addAutosaveEvent(AS_STOP);
-
-    if (currentDuration != duration) {
-
-        pthread_mutex_lock(&autosaveMutex);
-
-        autosaveDuration = duration;
-
-        pthread_mutex_unlock(&autosaveMutex);
+napi_value forceAutoSaveToStop(napi_env env, napi_callback_info info) {
 
-    }
+    Engine_forceAutoSaveToStop();
 
     /* Return null value */
 
     return napi_value_null;
-    
-}
-
-napi_value getSimulationInfo(napi_env env, napi_callback_info info) {
-
-    size_t argc = 1;
-    napi_value argv[1];
-
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
-
-    size_t length;
-
-    static char buffer[FILEPATH_SIZE];
-
-    NAPI_CALL(env, "Failed to parse string as an argument", napi_get_value_string_utf8(env, argv[0], buffer, FILEPATH_SIZE, &length))
-
-    printf("[BACKSTAGE] getSimulationInfo - %s\n", buffer);
-
-    napi_value jsObj;
-
-    napi_value napi_description;
-
-    napi_value napi_description_array;
-
-    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj))
-
-    NAPI_CALL(env, "Failed to parse arguments", napi_create_array_with_length(env, NUMBER_OF_SIMULATION_EXAMPLES, &napi_description_array))
-
-    NAPI_CALL(env, "Failed to set named property", napi_set_named_property(env, jsObj, "descriptions", napi_description_array))
-
-    Simulator_setPath(buffer);
-
-    for (int32_t i = 0; i < NUMBER_OF_SIMULATION_EXAMPLES; i += 1) {
-
-        char *description = Simulator_getDescription(i);
-
-        NAPI_CALL(env, "Failed to create string", napi_create_string_utf8(env, description, NAPI_AUTO_LENGTH, &napi_description))
-
-        NAPI_CALL(env, "Failed to set array element", napi_set_element(env, napi_description_array, i, napi_description))
-
-    }
-
-    /* Return object */
-
-    return jsObj;
 
 }
 
-napi_value setSimulation(napi_env env, napi_callback_info info) {
+napi_value setLowLatency(napi_env env, napi_callback_info info) {
 
     size_t argc = 2;
     napi_value argv[2];
 
     bool enable;
 
-    int32_t index;
+    bool exclusive = false;
 
     NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
     NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
 
-    if (enable) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &index))
-
-    /* Set flags */
-
-    bool success = true;
-
-    if (enable) {
-
-        printf("[BACKSTAGE] setSimulation - true, %d\n", index);
-
-        success = Simulator_loadExample(index);
+    if (argc > 1) NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[1], &exclusive))
 
-        if (success) {
+    Engine_setLowLatency(enable, exclusive);
 
-            shouldStartSimulation = true;
-
-            simulationIndex = index;
-
-        }
+    /* Return null value */
 
-    } else {
+    return napi_value_null;
 
-        puts("[BACKSTAGE] setSimulation - false");
+}
 
-        shouldStopSimulation = true;
+napi_value measureLatency(napi_env env, napi_callback_info info) {
 
-    }
+    bool success = Engine_measureLatency();
 
-    /* Return boolean value */
+    /* Return success value */
 
     return success ? napi_value_true : napi_value_false;
 
 }
 
-napi_value setMonitor(napi_env env, napi_callback_info info) {
-
-    size_t argc = 2;
-    napi_value argv[2];
-
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
-
-    int32_t mode;
+napi_value getStats(napi_env env, napi_callback_info info) {
 
-    int32_t frequency;
+    EN_stats_t stats;
 
-    NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[0], &mode))
+    Engine_getStats(&stats);
 
-    if (mode == MONITOR_HETERODYNE) {
+    /* Generate return object */
 
-        NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &frequency))
+    napi_value jsObj;
 
-        printf("[BACKSTAGE] setMonitor - 2, %d\n", frequency);
+    NAPI_CALL(env, "Failed to create object", napi_create_object(env, &jsObj));
 
-    } else {
+    setBooleanProperty(env, jsObj, "lowLatency", stats.lowLatency);
 
-        printf("[BACKSTAGE] setMonitor - %d\n", mode);
+    setBooleanProperty(env, jsObj, "exclusiveMode", stats.exclusiveMode);
 
-    }
+    setDoubleProperty(env, jsObj, "capturePeriod", stats.capturePeriod);
 
-    /* Update heterodyne */
+    setDoubleProperty(env, jsObj, "playbackBuffer", stats.playbackBuffer);
 
-    if (mode == MONITOR_HETERODYNE) Heterodyne_updateFrequencies(MAXIMUM_SAMPLE_RATE, frequency);
+    setDoubleProperty(env, jsObj, "playbackLag", stats.playbackLag);
 
-    heterodyneEnabled = mode == MONITOR_HETERODYNE;
+    setDoubleProperty(env, jsObj, "targetPlaybackLag", stats.targetPlaybackLag);
 
-    /* Stop and start monitor */
+    setDoubleProperty(env, jsObj, "driftAdjustment", stats.driftAdjustment);
 
-    if (!monitorEnabled && (mode == MONITOR_PLAYTHROUGH || mode == MONITOR_HETERODYNE)) {
+    setDoubleProperty(env, jsObj, "clockDrift", stats.clockDrift);
 
-        playbackBufferCount = 0;
+    setNullableDoubleProperty(env, jsObj, "simulationJitter", stats.simulationJitterValid, stats.simulationJitter);
 
-        playbackReadIndex = audioBufferWriteIndex;
+    setNullableDoubleProperty(env, jsObj, "simulationMaximumJitter", stats.simulationJitterValid, stats.simulationMaximumJitter);
 
-        pthread_create(&startPlaybackThread, NULL, startPlaybackThreadBody, NULL);
+    setNullableDoubleProperty(env, jsObj, "offlineThroughput", stats.offlineThroughputValid, stats.offlineThroughput);
 
-        monitorEnabled = true;
+    setNullableDoubleProperty(env, jsObj, "offlineSamplesProcessed", stats.offlineThroughputValid, (double)stats.offlineSamplesProcessed);
 
-    } else if (monitorEnabled && mode == MONITOR_OFF && monitorEnabled) {
+    setDoubleProperty(env, jsObj, "estimatedLatency", stats.estimatedLatency);
 
-        pthread_create(&stopPlaybackThread, NULL, stopPlaybackThreadBody, NULL);
+    setNullableDoubleProperty(env, jsObj, "loopbackLatency", stats.loopbackLatency >= 0.0, stats.loopbackLatency);
 
-        monitorEnabled = false;
+    setNullableDoubleProperty(env, jsObj, "monitorLatency", stats.monitorLatency >= 0.0, stats.monitorLatency);
 
-    }
+    setNullableDoubleProperty(env, jsObj, "deviceRestartLatency", stats.deviceRestartLatency >= 0.0, stats.deviceRestartLatency);
 
-    /* Return null value */
+    return jsObj;
 
-    return napi_value_null;
-    
 }
 
-napi_value setHighDefaultSampleRate(napi_env env, napi_callback_info info) {
+napi_value setVirtualAudioMoth(napi_env env, napi_callback_info info) {
 
-    size_t argc = 1;
-    napi_value argv[1];
+    size_t argc = 2;
+    napi_value argv[2];
 
-    bool enable;
+    bool connected;
+
+    int32_t sampleRate = 384000;
 
     NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
+    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &connected))
 
-    printf("[BACKSTAGE] setHighDefaultSampleRate - %s\n", enable ? "true" : "false");
+    if (argc > 1) NAPI_CALL(env, "Failed to parse number as an argument", napi_get_value_int32(env, argv[1], &sampleRate))
 
-    requestedMaximumDefaultSampleRate = enable ? MAXIMUM_SAMPLE_RATE : DEFAULT_SAMPLE_RATE;
+    bool success = Engine_setVirtualAudioMoth(connected, sampleRate);
 
-    maximumDefaultSampleRateChanged = true;
+    /* Return success value */
 
-    /* Return null value */
+    return success ? napi_value_true : napi_value_false;
 
-    return napi_value_null;
-    
 }
 
-napi_value setLocalTime(napi_env env, napi_callback_info info) {
+napi_value writePlaybackSink(napi_env env, napi_callback_info info) {
 
     size_t argc = 1;
     napi_value argv[1];
 
-    bool enable;
-
-    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
-
-    NAPI_CALL(env, "Failed to parse boolean as an argument", napi_get_value_bool(env, argv[0], &enable))
-
-    printf("[BACKSTAGE] setLocalTime - %s\n", enable ? "true" : "false");
-
-    pthread_mutex_lock(&localTimeMutex);
-
-    useLocalTime = enable;
-
-    pthread_mutex_unlock(&localTimeMutex);
-
-    /* Return null value */
-
-    return napi_value_null;
-    
-}
-
-napi_value forceAutoSaveToStop(napi_env env, napi_callback_info info) {
-
-    puts("[BACKSTAGE] forceAutoSaveToStop");
-
-    /* Set shutdown flag */
-
-    pthread_mutex_lock(&autosaveMutex);
-
-    autosaveShutdownCompleted = false;
-
-    pthread_mutex_unlock(&autosaveMutex);
-
-    /* Send shutdown message */
-
-    addAutosaveEvent(AS_SHUTDOWN);
-
-    /* Wait for shutdown to complete */
-
-    bool shutdownCompleted = false;
-
-    double startTime = ma_timer_get_time_in_seconds(&timer);
-
-    while (shutdownCompleted == false) {
-
-        double currentTime = ma_timer_get_time_in_seconds(&timer);
-
-        if (currentTime - startTime > DEVICE_SHUTDOWN_TIMEOUT) {
-
-            puts("[BACKSTAGE] Timed out waiting for shutdown to complete");
-
-            break;
-
-        }
+    size_t length;
 
-        pthread_mutex_lock(&autosaveMutex);
+    static char filename[FILEPATH_SIZE];
 
-        shutdownCompleted = autosaveShutdownCompleted;
+    NAPI_CALL(env, "Failed to parse arguments", napi_get_cb_info(env, info, &argc, argv, NULL, NULL))
 
-        pthread_mutex_unlock(&autosaveMutex);
+    NAPI_CALL(env, "Failed to parse string as an argument", napi_get_value_string_utf8(env, argv[0], filename, FILEPATH_SIZE, &length))
 
-    }
+    bool success = Engine_writePlaybackSink(filename);
 
-    puts("[BACKSTAGE] Autosave shutdown complete");
+    /* Return success value */
 
-    /* Return null value */
+    return success ? napi_value_true : napi_value_false;
 
-    return napi_value_null;
-    
 }
 
 /* Initialise exported functions */
@@ -2566,12 +1045,20 @@ napi_value Init(napi_env env, napi_value exports) {
 
     NAPI_EXPORT_FUNCTION(setPause)
 
+    NAPI_EXPORT_FUNCTION(setReview)
+
     NAPI_EXPORT_FUNCTION(setFileDestination)
 
     NAPI_EXPORT_FUNCTION(setAutoSaveCallback)
 
     NAPI_EXPORT_FUNCTION(setAutoSave)
 
+    NAPI_EXPORT_FUNCTION(setTrigger)
+
+    NAPI_EXPORT_FUNCTION(setSchedule)
+
+    NAPI_EXPORT_FUNCTION(setFilter)
+
     NAPI_EXPORT_FUNCTION(getSimulationInfo)
 
     NAPI_EXPORT_FUNCTION(setSimulation)
@@ -2582,10 +1069,20 @@ napi_value Init(napi_env env, napi_value exports) {
 
     NAPI_EXPORT_FUNCTION(setLocalTime)
 
+    NAPI_EXPORT_FUNCTION(setLowLatency)
+
+    NAPI_EXPORT_FUNCTION(measureLatency)
+
+    NAPI_EXPORT_FUNCTION(getStats)
+
+    NAPI_EXPORT_FUNCTION(setVirtualAudioMoth)
+
+    NAPI_EXPORT_FUNCTION(writePlaybackSink)
+
     NAPI_EXPORT_FUNCTION(forceAutoSaveToStop)
 
     return exports;
 
 }
 
-NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
\ No newline at end of file
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,684 @@
+/****************************************************************************
+ * benchmark.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stft.h"
+#include "engine.h"
+#include "xtime.h"
+#include "macros.h"
+#include "biquad.h"
+#include "wavFile.h"
+#include "autosave.h"
+#include "prefilter.h"
+#include "resampler.h"
+#include "heterodyne.h"
+#include "frequencyDivider.h"
+
+/* Maths constants */
+
+#ifndef M_PI
+#define M_PI                                3.14159265358979323846
+#endif
+
+/* Benchmark constants. Each iteration processes one second of audio at the sample rate under test */
+
+#define DEFAULT_NUMBER_OF_ITERATIONS        20
+#define MAXIMUM_NUMBER_OF_ITERATIONS        1000
+#define NUMBER_OF_WARM_UP_ITERATIONS        2
+
+/* Capture constants. These match the capture sample rates in engine.c */
+
+#define NUMBER_OF_VALID_SAMPLE_RATES        8
+#define MAXIMUM_SAMPLE_RATE                 384000
+
+static int32_t validSampleRates[NUMBER_OF_VALID_SAMPLE_RATES] = {8000, 16000, 32000, 48000, 96000, 192000, 250000, 384000};
+
+/* Pipeline constants */
+
+#define CALLBACKS_PER_SECOND                100
+
+#define PLAYBACK_SAMPLE_RATE                48000
+#define PLAYBACK_BLOCK_SIZE                 (PLAYBACK_SAMPLE_RATE / CALLBACKS_PER_SECOND)
+
+#define REVIEW_TIME_EXPANSION               10
+#define DRIFT_ADJUSTMENT                    0.001
+
+#define DEFAULT_HETERODYNE_FREQUENCY        45000
+#define DEFAULT_FREQUENCY_DIVISION          10
+
+#define AUTOSAVE_EVENT_QUEUE_SIZE           64
+
+/* Buffer constants */
+
+#define FILEPATH_SIZE                       8192
+#define FILENAME_SIZE                       (FILEPATH_SIZE + 32)
+
+/* Unit conversion constants */
+
+#define NANOSECONDS_IN_SECOND               1e9
+
+/* Kernel structure. The setup function is not timed and the run function returns the number of samples processed. Kernels which convert to a capture rate are measured for every valid output rate up to the input rate */
+
+typedef struct {
+    char *name;
+    void (*setup)(int32_t sampleRate);
+    int32_t (*run)(int32_t sampleRate);
+    bool everyOutputSampleRate;
+} BM_kernel_t;
+
+/* Result structure */
+
+typedef struct {
+    int32_t samplesPerIteration;
+    double nanosecondsPerSample;
+    double minimumNanosecondsPerSample;
+    double variance;
+} BM_result_t;
+
+/* Input and output buffers */
+
+static int16_t audioInput[MAXIMUM_SAMPLE_RATE];
+
+static int16_t audioWorking[MAXIMUM_SAMPLE_RATE];
+
+static float floatInput[MAXIMUM_SAMPLE_RATE];
+
+static float floatOutput[MAXIMUM_SAMPLE_RATE];
+
+static float stftOutput[MAXIMUM_SAMPLE_RATE / STFT_INPUT_OUTPUT_RATIO];
+
+static volatile double doubleSink;
+
+/* Kernel state */
+
+static RS_resampler_t resampler;
+
+static RS_captureResampler_t captureResampler;
+
+static int32_t outputSampleRate;
+
+static BQ_filter_t filter;
+
+static BQ_filterCoefficients_t filterCoefficients;
+
+static BQ_cascade_t cascade;
+
+static WAV_header_t header;
+
+static char wavFilename[FILENAME_SIZE];
+
+static char fileDestination[FILEPATH_SIZE] = ".";
+
+/* Private functions */
+
+static void generateInput(void) {
+
+    /* A chirp with added noise from a fixed seed so every run processes the same signal */
+
+    uint32_t state = 1;
+
+    double phase = 0.0;
+
+    for (int32_t i = 0; i < MAXIMUM_SAMPLE_RATE; i += 1) {
+
+        state = state * 1664525 + 1013904223;
+
+        double noise = (double)(int32_t)(state >> 16) / 65536.0 - 0.5;
+
+        phase += 2.0 * M_PI * (0.01 + 0.4 * (double)i / MAXIMUM_SAMPLE_RATE);
+
+        double sample = 8000.0 * sin(phase) + 2000.0 * noise;
+
+        audioInput[i] = (int16_t)sample;
+
+        floatInput[i] = (float)sample;
+
+    }
+
+}
+
+static void setupNothing(int32_t sampleRate) {
+
+}
+
+static int32_t getDecimation(int32_t sampleRate) {
+
+    return sampleRate % PLAYBACK_SAMPLE_RATE == 0 ? sampleRate / PLAYBACK_SAMPLE_RATE : 1;
+
+}
+
+/* STFT */
+
+static int32_t runSTFT(int32_t sampleRate) {
+
+    int32_t numberOfSamples = sampleRate - sampleRate % STFT_INPUT_SAMPLES;
+
+    for (int32_t offset = 0; offset < numberOfSamples; offset += STFT_INPUT_SAMPLES) STFT_transform(audioInput, offset, stftOutput, offset / STFT_INPUT_OUTPUT_RATIO);
+
+    return numberOfSamples;
+
+}
+
+/* Capture prefilter */
+
+static void setupPrefilter(int32_t sampleRate) {
+
+    Prefilter_configure(PF_BAND_PASS, sampleRate / 8, sampleRate / 4);
+
+    memcpy(audioWorking, audioInput, sizeof(audioWorking));
+
+}
+
+static int32_t runPrefilter(int32_t sampleRate) {
+
+    int32_t blockSize = sampleRate / CALLBACKS_PER_SECOND;
+
+    for (int32_t i = 0; i < sampleRate; i += blockSize) Prefilter_processBlock(audioWorking + i, blockSize, sampleRate);
+
+    return sampleRate;
+
+}
+
+/* Resamplers */
+
+static int32_t runResampler(int32_t inputSampleRate) {
+
+    int32_t inputIndex = 0;
+
+    while (true) {
+
+        int32_t numberOfInputSamples = Resampler_getNumberOfInputSamples(&resampler, PLAYBACK_BLOCK_SIZE);
+
+        if (inputIndex + numberOfInputSamples > inputSampleRate) break;
+
+        Resampler_process(&resampler, floatInput + inputIndex, PLAYBACK_BLOCK_SIZE, floatOutput);
+
+        inputIndex += numberOfInputSamples;
+
+    }
+
+    return inputIndex;
+
+}
+
+static void setupCaptureResampler(int32_t sampleRate) {
+
+    Resampler_initialiseCapture(&captureResampler, sampleRate, outputSampleRate);
+
+}
+
+static int32_t runCaptureResampler(int32_t sampleRate) {
+
+    /* Process each callback of input up to every STFT block boundary as the capture callback does */
+
+    int32_t blockSize = sampleRate / CALLBACKS_PER_SECOND;
+
+    int32_t outputIndex = 0;
+
+    for (int32_t i = 0; i < sampleRate; i += blockSize) {
+
+        int32_t inputIndex = i;
+
+        while (true) {
+
+            int32_t numberOfSamplesToBoundary = STFT_INPUT_SAMPLES - outputIndex % STFT_INPUT_SAMPLES;
+
+            int32_t numberOfInputSamplesUsed;
+
+            int32_t numberOfSamples = Resampler_processCapture(&captureResampler, audioInput + inputIndex, i + blockSize - inputIndex, numberOfSamplesToBoundary, audioWorking + outputIndex, &numberOfInputSamplesUsed);
+
+            inputIndex += numberOfInputSamplesUsed;
+
+            outputIndex += numberOfSamples;
+
+            if (numberOfSamples < numberOfSamplesToBoundary) break;
+
+        }
+
+    }
+
+    return sampleRate;
+
+}
+
+static void setupPlaybackResampler(int32_t sampleRate) {
+
+    Resampler_initialise(&resampler, sampleRate, PLAYBACK_SAMPLE_RATE, false);
+
+}
+
+static int32_t runPlaybackResampler(int32_t sampleRate) {
+
+    return runResampler(sampleRate);
+
+}
+
+static void setupDriftResampler(int32_t sampleRate) {
+
+    Resampler_initialise(&resampler, sampleRate, PLAYBACK_SAMPLE_RATE, true);
+
+    Resampler_setAdjustment(&resampler, DRIFT_ADJUSTMENT);
+
+}
+
+static int32_t runDriftResampler(int32_t sampleRate) {
+
+    return runResampler(sampleRate);
+
+}
+
+static void setupReviewResampler(int32_t sampleRate) {
+
+    Resampler_initialise(&resampler, sampleRate / REVIEW_TIME_EXPANSION, PLAYBACK_SAMPLE_RATE, false);
+
+}
+
+static int32_t runReviewResampler(int32_t sampleRate) {
+
+    return runResampler(sampleRate / REVIEW_TIME_EXPANSION);
+
+}
+
+/* Heterodyne */
+
+static void setupHeterodyne(int32_t sampleRate) {
+
+    Heterodyne_updateFrequencies(sampleRate, MIN(DEFAULT_HETERODYNE_FREQUENCY, sampleRate / 4));
+
+}
+
+static int32_t runHeterodyne(int32_t sampleRate) {
+
+    double sum = 0.0;
+
+    for (int32_t i = 0; i < sampleRate; i += 1) sum += Heterodyne_nextOutput(floatInput[i]);
+
+    doubleSink = sum;
+
+    return sampleRate;
+
+}
+
+static int32_t runHeterodyneBlock(int32_t sampleRate) {
+
+    int32_t blockSize = sampleRate / CALLBACKS_PER_SECOND;
+
+    int32_t decimation = getDecimation(sampleRate);
+
+    for (int32_t i = 0; i < sampleRate; i += blockSize) Heterodyne_processBlock(floatInput + i, blockSize, decimation, floatOutput);
+
+    return sampleRate;
+
+}
+
+/* Frequency divider */
+
+static void setupFrequencyDivider(int32_t sampleRate) {
+
+    FrequencyDivider_initialise();
+
+}
+
+static int32_t runFrequencyDivider(int32_t sampleRate) {
+
+    int32_t blockSize = sampleRate / CALLBACKS_PER_SECOND;
+
+    int32_t decimation = getDecimation(sampleRate);
+
+    for (int32_t i = 0; i < sampleRate; i += blockSize) FrequencyDivider_processBlock(floatInput + i, blockSize, sampleRate, DEFAULT_FREQUENCY_DIVISION, decimation, floatOutput);
+
+    return sampleRate;
+
+}
+
+/* Biquad filters */
+
+static void setupBiquad(int32_t sampleRate) {
+
+    Biquad_designBandPassFilter(&filterCoefficients, sampleRate, sampleRate / 8, sampleRate / 4);
+
+    Biquad_initialise(&filter);
+
+}
+
+static int32_t runBiquad(int32_t sampleRate) {
+
+    double sum = 0.0;
+
+    for (int32_t i = 0; i < sampleRate; i += 1) sum += Biquad_applyFilter(floatInput[i], &filter, &filterCoefficients);
+
+    doubleSink = sum;
+
+    return sampleRate;
+
+}
+
+static void setupBiquadCascade(int32_t sampleRate) {
+
+    Biquad_designBandPassFilter(&filterCoefficients, sampleRate, sampleRate / 8, sampleRate / 4);
+
+    Biquad_initialiseCascade(&cascade);
+
+    Biquad_addSection(&cascade, &filterCoefficients);
+
+    Biquad_addSection(&cascade, &filterCoefficients);
+
+}
+
+static int32_t runBiquadCascade(int32_t sampleRate) {
+
+    int32_t blockSize = sampleRate / CALLBACKS_PER_SECOND;
+
+    for (int32_t i = 0; i < sampleRate; i += blockSize) Biquad_applyCascade(&cascade, floatInput + i, blockSize, floatOutput + i);
+
+    return sampleRate;
+
+}
+
+/* WAV files */
+
+static void setupWavWrite(int32_t sampleRate) {
+
+    snprintf(wavFilename, FILENAME_SIZE, "%s/BENCHMARK.WAV", fileDestination);
+
+    WavFile_initialiseHeader(&header);
+
+    WavFile_setHeaderDetails(&header, sampleRate, sampleRate);
+
+    WavFile_setHeaderComment(&header, 0, 0, 0, "a benchmark");
+
+}
+
+static int32_t runWavWrite(int32_t sampleRate) {
+
+    if (WavFile_writeFile(&header, wavFilename, audioInput, sampleRate / 2, audioInput + sampleRate / 2, sampleRate - sampleRate / 2) == false) return 0;
+
+    return sampleRate;
+
+}
+
+static void setupWavAppend(int32_t sampleRate) {
+
+    setupWavWrite(sampleRate);
+
+    WavFile_writeFile(&header, wavFilename, audioInput, sampleRate, NULL, 0);
+
+}
+
+static int32_t runWavAppend(int32_t sampleRate) {
+
+    if (WavFile_appendFile(wavFilename, audioInput, sampleRate / 2, audioInput + sampleRate / 2, sampleRate - sampleRate / 2) == false) return 0;
+
+    return sampleRate;
+
+}
+
+/* Autosave queue. Each iteration passes one event per STFT frame, the most the trigger can generate */
+
+static int32_t runAutosaveQueue(int32_t sampleRate) {
+
+    AS_event_t event = {.type = AS_TRIGGER_START, .sampleRate = sampleRate};
+
+    int32_t numberOfEvents = sampleRate / STFT_INPUT_SAMPLES;
+
+    for (int32_t i = 0; i < numberOfEvents; i += 1) {
+
+        event.currentCount = i;
+
+        Autosave_addEvent(&event);
+
+        Autosave_getFirstEvent(&event);
+
+    }
+
+    return numberOfEvents;
+
+}
+
+/* Kernel table */
+
+static BM_kernel_t kernels[] = {
+    {"stft", setupNothing, runSTFT, false},
+    {"prefilter", setupPrefilter, runPrefilter, false},
+    {"captureResampler", setupCaptureResampler, runCaptureResampler, true},
+    {"playbackResampler", setupPlaybackResampler, runPlaybackResampler, false},
+    {"driftResampler", setupDriftResampler, runDriftResampler, false},
+    {"reviewResampler", setupReviewResampler, runReviewResampler, false},
+    {"heterodyne", setupHeterodyne, runHeterodyne, false},
+    {"heterodyneBlock", setupHeterodyne, runHeterodyneBlock, false},
+    {"frequencyDivider", setupFrequencyDivider, runFrequencyDivider, false},
+    {"biquad", setupBiquad, runBiquad, false},
+    {"biquadCascade", setupBiquadCascade, runBiquadCascade, false},
+    {"wavWrite", setupWavWrite, runWavWrite, false},
+    {"wavAppend", setupWavAppend, runWavAppend, false},
+    {"autosaveQueue", setupNothing, runAutosaveQueue, false}
+};
+
+#define NUMBER_OF_KERNELS                   (int32_t)(sizeof(kernels) / sizeof(BM_kernel_t))
+
+/* Measurement */
+
+static bool measureKernel(BM_kernel_t *kernel, int32_t sampleRate, int32_t numberOfIterations, BM_result_t *result) {
+
+    static double nanosecondsPerSample[MAXIMUM_NUMBER_OF_ITERATIONS];
+
+    kernel->setup(sampleRate);
+
+    int32_t numberOfSamples = 0;
+
+    for (int32_t i = 0; i < NUMBER_OF_WARM_UP_ITERATIONS + numberOfIterations; i += 1) {
+
+        int64_t startTime = Time_getMonotonicNanoseconds();
+
+        numberOfSamples = kernel->run(sampleRate);
+
+        int64_t duration = Time_getMonotonicNanoseconds() - startTime;
+
+        if (numberOfSamples == 0) return false;
+
+        if (i >= NUMBER_OF_WARM_UP_ITERATIONS) nanosecondsPerSample[i - NUMBER_OF_WARM_UP_ITERATIONS] = (double)duration / (double)numberOfSamples;
+
+    }
+
+    /* Mean, minimum and sample variance of the time per sample across iterations */
+
+    double sum = 0.0;
+
+    double minimum = INFINITY;
+
+    for (int32_t i = 0; i < numberOfIterations; i += 1) {
+
+        sum += nanosecondsPerSample[i];
+
+        minimum = MIN(minimum, nanosecondsPerSample[i]);
+
+    }
+
+    double mean = sum / numberOfIterations;
+
+    double sumOfSquares = 0.0;
+
+    for (int32_t i = 0; i < numberOfIterations; i += 1) sumOfSquares += (nanosecondsPerSample[i] - mean) * (nanosecondsPerSample[i] - mean);
+
+    result->samplesPerIteration = numberOfSamples;
+
+    result->nanosecondsPerSample = mean;
+
+    result->minimumNanosecondsPerSample = minimum;
+
+    result->variance = numberOfIterations > 1 ? sumOfSquares / (numberOfIterations - 1) : 0.0;
+
+    return true;
+
+}
+
+static void printUsage(void) {
+
+    puts("Usage: backstage_benchmark [--iterations <number>] [--kernel <name>] [--destination <folder>] [--output <file>]\n");
+
+    printf("Kernels:");
+
+    for (int32_t i = 0; i < NUMBER_OF_KERNELS; i += 1) printf(" %s", kernels[i].name);
+
+    printf("\n");
+
+}
+
+/* Main function */
+
+int main(int argc, char **argv) {
+
+    int32_t numberOfIterations = DEFAULT_NUMBER_OF_ITERATIONS;
+
+    char *kernelName = NULL;
+
+    char *outputFilename = NULL;
+
+    /* Parse the arguments */
+
+    for (int32_t i = 1; i < argc; i += 1) {
+
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(argv[i], "--iterations") == 0 && hasValue) {
+
+            numberOfIterations = atoi(argv[++i]);
+
+        } else if (strcmp(argv[i], "--kernel") == 0 && hasValue) {
+
+            kernelName = argv[++i];
+
+        } else if (strcmp(argv[i], "--destination") == 0 && hasValue) {
+
+            snprintf(fileDestination, FILEPATH_SIZE, "%s", argv[++i]);
+
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+
+            outputFilename = argv[++i];
+
+        } else {
+
+            printUsage();
+
+            return strcmp(argv[i], "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+        }
+
+    }
+
+    if (numberOfIterations < 1 || numberOfIterations > MAXIMUM_NUMBER_OF_ITERATIONS) {
+
+        printf("[BENCHMARK] Number of iterations must be between 1 and %d\n", MAXIMUM_NUMBER_OF_ITERATIONS);
+
+        return EXIT_FAILURE;
+
+    }
+
+    FILE *output = outputFilename == NULL ? stdout : fopen(outputFilename, "w");
+
+    if (output == NULL) {
+
+        printf("[BENCHMARK] Could not open %s\n", outputFilename);
+
+        return EXIT_FAILURE;
+
+    }
+
+    /* Initialise the kernels as the engine does */
+
+    generateInput();
+
+    STFT_initialise();
+
+    Prefilter_initialise();
+
+    Heterodyne_initialise(MAXIMUM_SAMPLE_RATE, DEFAULT_HETERODYNE_FREQUENCY);
+
+    FrequencyDivider_initialise();
+
+    Autosave_initialise(AUTOSAVE_EVENT_QUEUE_SIZE);
+
+    int32_t resamplerSampleRates[2 * NUMBER_OF_VALID_SAMPLE_RATES];
+
+    for (int32_t i = 0; i < NUMBER_OF_VALID_SAMPLE_RATES; i += 1) {
+
+        resamplerSampleRates[2 * i] = validSampleRates[i];
+
+        resamplerSampleRates[2 * i + 1] = validSampleRates[i] / REVIEW_TIME_EXPANSION;
+
+    }
+
+    if (Resampler_designFilterBanks(resamplerSampleRates, 2 * NUMBER_OF_VALID_SAMPLE_RATES, PLAYBACK_SAMPLE_RATE) == false) {
+
+        puts("[BENCHMARK] Failed to design resampler filter banks");
+
+        return EXIT_FAILURE;
+
+    }
+
+    /* Run every kernel at every sample rate */
+
+    bool success = true;
+
+    bool first = true;
+
+    fprintf(output, "{\n    \"iterations\": %d,\n    \"results\": [", numberOfIterations);
+
+    for (int32_t i = 0; i < NUMBER_OF_KERNELS; i += 1) {
+
+        if (kernelName != NULL && strcmp(kernelName, kernels[i].name) != 0) continue;
+
+        for (int32_t j = 0; j < NUMBER_OF_VALID_SAMPLE_RATES; j += 1) {
+
+            int32_t numberOfOutputSampleRates = kernels[i].everyOutputSampleRate ? j + 1 : 1;
+
+            for (int32_t k = 0; k < numberOfOutputSampleRates; k += 1) {
+
+                BM_result_t result;
+
+                outputSampleRate = validSampleRates[k];
+
+                if (measureKernel(&kernels[i], validSampleRates[j], numberOfIterations, &result) == false) {
+
+                    fprintf(stderr, "[BENCHMARK] %s failed at %d Hz\n", kernels[i].name, validSampleRates[j]);
+
+                    success = false;
+
+                    continue;
+
+                }
+
+                char outputSampleRateField[32] = "";
+
+                if (kernels[i].everyOutputSampleRate) snprintf(outputSampleRateField, sizeof(outputSampleRateField), ", \"outputSampleRate\": %d", outputSampleRate);
+
+                fprintf(output, "%s\n        {\"kernel\": \"%s\", \"sampleRate\": %d%s, \"samplesPerIteration\": %d, \"nsPerSample\": %.4f, \"minimumNsPerSample\": %.4f, \"samplesPerSecond\": %.0f, \"nsPerSampleVariance\": %.6f}", first ? "" : ",", kernels[i].name, validSampleRates[j], outputSampleRateField, result.samplesPerIteration, result.nanosecondsPerSample, result.minimumNanosecondsPerSample, NANOSECONDS_IN_SECOND / result.nanosecondsPerSample, result.variance);
+
+                first = false;
+
+            }
+
+        }
+
+    }
+
+    fprintf(output, "\n    ]\n}\n");
+
+    if (output != stdout) fclose(output);
+
+    /* Remove the WAV file left by the file kernels */
+
+    if (wavFilename[0] != 0) remove(wavFilename);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -5,7 +5,10 @@
  *****************************************************************************/
 
 #include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
 
+#include "macros.h"
 #include "biquad.h"
 
 /* Maths constants */
@@ -18,6 +21,12 @@
 #define M_TWOPI         (2.0 * M_PI)
 #endif
 
+/* Cascade constants */
+
+#define CASCADE_CONVERSION_BLOCK_SIZE   256
+
+#define NARROW_WAVEFRONT_LANES          4
+
 /* Private functions to determine initial parameters and set final coefficients */
 
 static inline void determineParametersFromFrequencyAndBandwidth(uint32_t frequency, double bandwidth, uint32_t sampleRate, double *omega, double *alpha) {
@@ -149,3 +158,215 @@ double Biquad_applyFilter(double sample, BQ_filter_t *filter, BQ_filterCoefficie
     return filter->yv[2];
 
 }
+
+/* Public functions to build and apply second order section cascades */
+
+void Biquad_initialiseCascade(BQ_cascade_t *cascade) {
+
+    cascade->numberOfSections = 0;
+
+    /* Unused sections pass their input straight through */
+
+    for (int32_t k = 0; k < BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS; k += 1) {
+
+        cascade->b0[k] = 1.0f;
+        cascade->b1[k] = 0.0f;
+        cascade->b2[k] = 0.0f;
+        cascade->a1[k] = 0.0f;
+        cascade->a2[k] = 0.0f;
+
+    }
+
+    Biquad_resetCascade(cascade);
+
+}
+
+bool Biquad_addSection(BQ_cascade_t *cascade, BQ_filterCoefficients_t *filterCoefficients) {
+
+    if (cascade->numberOfSections == BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS) return false;
+
+    int32_t k = cascade->numberOfSections;
+
+    cascade->b0[k] = (float)filterCoefficients->B0_A0;
+    cascade->b1[k] = (float)filterCoefficients->B1_A0;
+    cascade->b2[k] = (float)filterCoefficients->B2_A0;
+    cascade->a1[k] = (float)filterCoefficients->A1_A0;
+    cascade->a2[k] = (float)filterCoefficients->A2_A0;
+
+    cascade->numberOfSections += 1;
+
+    return true;
+
+}
+
+void Biquad_resetCascade(BQ_cascade_t *cascade) {
+
+    for (int32_t k = 0; k < BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS; k += 1) {
+
+        cascade->s1[k] = 0.0f;
+        cascade->s2[k] = 0.0f;
+
+    }
+
+}
+
+static void applySections(BQ_cascade_t *cascade, const float *input, int32_t numberOfSamples, float *output) {
+
+    /* Run each section over the whole block in turn */
+
+    for (int32_t k = 0; k < cascade->numberOfSections; k += 1) {
+
+        const float b0 = cascade->b0[k], b1 = cascade->b1[k], b2 = cascade->b2[k];
+
+        const float a1 = cascade->a1[k], a2 = cascade->a2[k];
+
+        float s1 = cascade->s1[k], s2 = cascade->s2[k];
+
+        const float *source = k == 0 ? input : output;
+
+        for (int32_t i = 0; i < numberOfSamples; i += 1) {
+
+            float x = source[i];
+
+            float y = b0 * x + s1;
+
+            s1 = b1 * x - a1 * y + s2;
+
+            s2 = b2 * x - a2 * y;
+
+            output[i] = y;
+
+        }
+
+        cascade->s1[k] = s1;
+
+        cascade->s2[k] = s2;
+
+    }
+
+    if (cascade->numberOfSections == 0 && input != output) for (int32_t i = 0; i < numberOfSamples; i += 1) output[i] = input[i];
+
+}
+
+static inline void applyWavefront(BQ_cascade_t *cascade, const float *input, int32_t numberOfSamples, float *output, const int32_t numberOfLanes) {
+
+    /* The recursion in each section is serial, so the sections are run as a wavefront with one vector lane per section. At step t section k works on sample t - k, which its predecessor finished on the previous step */
+
+    float b0[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS], b1[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS], b2[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+
+    float a1[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS], a2[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+
+    float s1[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS], s2[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS];
+
+    float x[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS] = {0};
+
+    float y[BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS] = {0};
+
+    for (int32_t k = 0; k < numberOfLanes; k += 1) {
+
+        b0[k] = cascade->b0[k];
+        b1[k] = cascade->b1[k];
+        b2[k] = cascade->b2[k];
+        a1[k] = cascade->a1[k];
+        a2[k] = cascade->a2[k];
+        s1[k] = cascade->s1[k];
+        s2[k] = cascade->s2[k];
+
+    }
+
+    const int32_t lastSection = numberOfLanes - 1;
+
+    const int32_t numberOfSteps = numberOfSamples + lastSection;
+
+    for (int32_t t = 0; t < numberOfSteps; t += 1) {
+
+        /* Feed each section with the output of the one before */
+
+        for (int32_t k = lastSection; k > 0; k -= 1) x[k] = y[k - 1];
+
+        x[0] = t < numberOfSamples ? input[t] : 0.0f;
+
+        if (t >= lastSection && t < numberOfSamples) {
+
+            /* Steady state with every lane active */
+
+            for (int32_t k = 0; k < numberOfLanes; k += 1) {
+
+                y[k] = b0[k] * x[k] + s1[k];
+
+                s1[k] = b1[k] * x[k] - a1[k] * y[k] + s2[k];
+
+                s2[k] = b2[k] * x[k] - a2[k] * y[k];
+
+            }
+
+        } else {
+
+            /* Wavefront filling at the start of the block or draining at the end */
+
+            for (int32_t k = 0; k < numberOfLanes; k += 1) {
+
+                int32_t n = t - k;
+
+                if (n < 0 || n >= numberOfSamples) continue;
+
+                y[k] = b0[k] * x[k] + s1[k];
+
+                s1[k] = b1[k] * x[k] - a1[k] * y[k] + s2[k];
+
+                s2[k] = b2[k] * x[k] - a2[k] * y[k];
+
+            }
+
+        }
+
+        if (t >= lastSection) output[t - lastSection] = y[lastSection];
+
+    }
+
+    for (int32_t k = 0; k < numberOfLanes; k += 1) {
+
+        cascade->s1[k] = s1[k];
+        cascade->s2[k] = s2[k];
+
+    }
+
+}
+
+void Biquad_applyCascade(BQ_cascade_t *cascade, const float *input, int32_t numberOfSamples, float *output) {
+
+    /* A single section has nothing to overlap with, otherwise use the narrowest wavefront which covers the cascade */
+
+    if (cascade->numberOfSections <= 1) {
+
+        applySections(cascade, input, numberOfSamples, output);
+
+    } else if (cascade->numberOfSections <= NARROW_WAVEFRONT_LANES) {
+
+        applyWavefront(cascade, input, numberOfSamples, output, NARROW_WAVEFRONT_LANES);
+
+    } else {
+
+        applyWavefront(cascade, input, numberOfSamples, output, BIQUAD_MAXIMUM_NUMBER_OF_SECTIONS);
+
+    }
+
+}
+
+void Biquad_applyCascadeInt16(BQ_cascade_t *cascade, const int16_t *input, int32_t numberOfSamples, int16_t *output) {
+
+    float block[CASCADE_CONVERSION_BLOCK_SIZE];
+
+    for (int32_t index = 0; index < numberOfSamples; index += CASCADE_CONVERSION_BLOCK_SIZE) {
+
+        int32_t length = MIN(CASCADE_CONVERSION_BLOCK_SIZE, numberOfSamples - index);
+
+        for (int32_t i = 0; i < length; i += 1) block[i] = (float)input[index + i];
+
+        Biquad_applyCascade(cascade, block, length, block);
+
+        for (int32_t i = 0; i < length; i += 1) output[index + i] = (int16_t)MAX(INT16_MIN, MIN(INT16_MAX, roundf(block[i])));
+
+    }
+
+}
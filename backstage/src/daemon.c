@@ -0,0 +1,670 @@
+/****************************************************************************
+ * daemon.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "engine.h"
+#include "macros.h"
+#include "threads.h"
+#include "schedule.h"
+#include "generator.h"
+#include "simulator.h"
+#include "prefilter.h"
+
+#if IS_WINDOWS == false
+    #include <unistd.h>
+#endif
+
+/* Frame timer constant */
+
+#define FRAME_INTERVAL                      50000
+#define MICROSECONDS_IN_SECOND              1000000
+
+/* Configuration constants */
+
+#define DEFAULT_AUTOSAVE_DURATION           60
+#define MAXIMUM_LINE_LENGTH                 (FILEPATH_SIZE + 64)
+#define MINUTES_IN_HOUR                     60
+#define HOURS_IN_DAY                        24
+
+/* Generator constants */
+
+#define DEFAULT_GENERATOR_SAMPLE_RATE       384000
+#define DEFAULT_GENERATOR_LEVEL             -6.0
+
+/* Virtual backend constant */
+
+#define VIRTUAL_AUDIOMOTH_SAMPLE_RATE       384000
+
+/* Option structure. Options without an argument are flags */
+
+typedef struct {
+    char *name;
+    char *argument;
+    char *description;
+} DA_option_t;
+
+static DA_option_t options[] = {
+    {"config", "<file>", "Read options from a file of 'name value' lines"},
+    {"destination", "<folder>", "Folder for autosave files (required)"},
+    {"duration", "<minutes>", "Length of each autosave file (default 60)"},
+    {"segment-length", "<samples>", "Cut autosave files at exact sample counts (3840 to 23040000)"},
+    {"sample-rate", "<hertz>", "Capture sample rate"},
+    {"high-default-sample-rate", NULL, "Allow the default device to run at 384kHz"},
+    {"local-time", NULL, "Name and stamp files in local time"},
+    {"trigger", "<min>,<max>,<dB>,<dB>,<ms>,<ms>", "Only write segments where the band level exceeds the threshold, with pre- and post-trigger periods of 0 to 26000 milliseconds"},
+    {"filter", "<type>,<hertz>[,<hertz>]", "Apply a low-pass, high-pass, band-pass or notch filter"},
+    {"duty-cycle", "<seconds>,<minutes>", "Record for a number of seconds each period"},
+    {"window", "<hh:mm>-<hh:mm>", "Record inside a daily window, which may cross midnight but not be empty (repeatable)"},
+    {"suspend-processing", NULL, "Suspend analysis outside the schedule"},
+    {"simulate", "<file>", "Take input from WAV files in turn (repeatable)"},
+    {"generate", "<signal>[,<hertz>[,<hertz>]]", "Take input from a sine, chirp, bat-call, white-noise, pink-noise or impulse signal"},
+    {"generate-sample-rate", "<hertz>", "Sample rate of the generated signal, one of the supported capture rates (default 384000)"},
+    {"generate-level", "<dBFS>", "Peak level of the generated signal (default -6)"},
+    {"generate-duration", "<seconds>", "Length of the generated signal, which repeats unless offline"},
+    {"offline", NULL, "Process the simulated input once as fast as possible and exit"},
+    {"start-time", "<milliseconds>", "Time of the first offline sample since the epoch"},
+    {"virtual-backend", NULL, "Replace the audio devices with timer-paced null devices"},
+    {"virtual-hotplug", "<seconds>", "Connect and disconnect a simulated AudioMoth on the virtual backend"},
+    {"help", NULL, "Show this message"}
+};
+
+#define NUMBER_OF_OPTIONS                   (int32_t)(sizeof(options) / sizeof(DA_option_t))
+
+/* Configuration variables */
+
+static char destination[FILEPATH_SIZE];
+
+static int32_t autosaveDuration = DEFAULT_AUTOSAVE_DURATION;
+
+static int32_t segmentLength;
+
+static int32_t sampleRate;
+
+static bool highDefaultSampleRate;
+
+static bool localTime;
+
+static bool triggerEnabled;
+
+static int32_t triggerMinimumFrequency;
+
+static int32_t triggerMaximumFrequency;
+
+static double triggerThreshold;
+
+static double triggerHysteresis;
+
+static int32_t triggerPreTrigger;
+
+static int32_t triggerPostTrigger;
+
+static int32_t filterType = PF_NONE;
+
+static int32_t filterFrequency1;
+
+static int32_t filterFrequency2;
+
+static int32_t scheduleMode = SCHEDULE_OFF;
+
+static int32_t dutyCycleRecordDuration;
+
+static int32_t dutyCyclePeriod;
+
+static int32_t numberOfWindows;
+
+static int32_t windowStartMinutes[MAXIMUM_NUMBER_OF_WINDOWS];
+
+static int32_t windowStopMinutes[MAXIMUM_NUMBER_OF_WINDOWS];
+
+static bool suspendProcessing;
+
+static int32_t numberOfSimulationFiles;
+
+static char simulationFiles[MAXIMUM_PLAYLIST_LENGTH][FILEPATH_SIZE];
+
+static bool generatorEnabled;
+
+static GN_settings_t generatorSettings = {GN_SINE, DEFAULT_GENERATOR_SAMPLE_RATE, 0, 0, DEFAULT_GENERATOR_LEVEL, 0.0};
+
+static bool offline;
+
+static double offlineStartTime;
+
+static bool virtualBackend;
+
+static int32_t virtualHotplugInterval;
+
+static bool helpRequested;
+
+/* Shutdown and failure flags */
+
+static volatile sig_atomic_t shutdownRequested;
+
+static volatile uint32_t autosaveFailed;
+
+/* Callbacks */
+
+static void handleSignal(int signal) {
+
+    shutdownRequested = true;
+
+}
+
+static void handleAutosaveFailure(void) {
+
+    Atomic_store32(&autosaveFailed, true);
+
+}
+
+/* Option parsing */
+
+static bool parseBoolean(char *value, bool *result) {
+
+    if (value == NULL || strcmp(value, "true") == 0 || strcmp(value, "1") == 0) {
+
+        *result = true;
+
+        return true;
+
+    }
+
+    if (strcmp(value, "false") == 0 || strcmp(value, "0") == 0) {
+
+        *result = false;
+
+        return true;
+
+    }
+
+    return false;
+
+}
+
+static bool parseFilter(char *value) {
+
+    char name[32];
+
+    int32_t frequency1 = 0, frequency2 = 0;
+
+    int32_t count = sscanf(value, "%31[a-z-],%d,%d", name, &frequency1, &frequency2);
+
+    if (count < 1) return false;
+
+    if (strcmp(name, "none") == 0) {
+
+        filterType = PF_NONE;
+
+    } else if (strcmp(name, "low-pass") == 0 && count == 2) {
+
+        filterType = PF_LOW_PASS;
+
+    } else if (strcmp(name, "high-pass") == 0 && count == 2) {
+
+        filterType = PF_HIGH_PASS;
+
+    } else if (strcmp(name, "band-pass") == 0 && count == 3) {
+
+        filterType = PF_BAND_PASS;
+
+    } else if (strcmp(name, "notch") == 0 && count == 3) {
+
+        filterType = PF_NOTCH;
+
+    } else {
+
+        return false;
+
+    }
+
+    filterFrequency1 = frequency1;
+
+    filterFrequency2 = frequency2;
+
+    return true;
+
+}
+
+static bool parseGenerator(char *value) {
+
+    char name[32];
+
+    int32_t frequency1 = 0, frequency2 = 0;
+
+    if (sscanf(value, "%31[a-z-],%d,%d", name, &frequency1, &frequency2) < 1) return false;
+
+    if (Generator_findSignal(name, &generatorSettings.signal) == false) return false;
+
+    generatorSettings.frequency1 = frequency1;
+
+    generatorSettings.frequency2 = frequency2;
+
+    generatorEnabled = true;
+
+    return true;
+
+}
+
+static bool parseWindow(char *value) {
+
+    int32_t startHours, startMinutes, stopHours, stopMinutes;
+
+    if (numberOfWindows == MAXIMUM_NUMBER_OF_WINDOWS) return false;
+
+    if (sscanf(value, "%d:%d-%d:%d", &startHours, &startMinutes, &stopHours, &stopMinutes) != 4) return false;
+
+    if (startHours < 0 || startHours >= HOURS_IN_DAY || stopHours < 0 || stopHours >= HOURS_IN_DAY) return false;
+
+    if (startMinutes < 0 || startMinutes >= MINUTES_IN_HOUR || stopMinutes < 0 || stopMinutes >= MINUTES_IN_HOUR) return false;
+
+    if (startHours == stopHours && startMinutes == stopMinutes) return false;
+
+    windowStartMinutes[numberOfWindows] = startHours * MINUTES_IN_HOUR + startMinutes;
+
+    windowStopMinutes[numberOfWindows] = stopHours * MINUTES_IN_HOUR + stopMinutes;
+
+    numberOfWindows += 1;
+
+    scheduleMode = SCHEDULE_WINDOWS;
+
+    return true;
+
+}
+
+static bool readConfigFile(char *filename);
+
+static bool applyOption(char *name, char *value) {
+
+    if (strcmp(name, "config") == 0) return readConfigFile(value);
+
+    if (strcmp(name, "destination") == 0) {
+
+        if (strlen(value) >= FILEPATH_SIZE) return false;
+
+        strcpy(destination, value);
+
+        return true;
+
+    }
+
+    if (strcmp(name, "duration") == 0) return sscanf(value, "%d", &autosaveDuration) == 1 && autosaveDuration > 0;
+
+    if (strcmp(name, "segment-length") == 0) {
+
+        if (sscanf(value, "%d", &segmentLength) != 1) return false;
+
+        segmentLength = segmentLength > 0 ? MAX(MINIMUM_SEGMENT_LENGTH, MIN(MAXIMUM_SEGMENT_LENGTH, segmentLength)) : 0;
+
+        return true;
+
+    }
+
+    if (strcmp(name, "sample-rate") == 0) return sscanf(value, "%d", &sampleRate) == 1;
+
+    if (strcmp(name, "high-default-sample-rate") == 0) return parseBoolean(value, &highDefaultSampleRate);
+
+    if (strcmp(name, "local-time") == 0) return parseBoolean(value, &localTime);
+
+    if (strcmp(name, "trigger") == 0) {
+
+        triggerEnabled = sscanf(value, "%d,%d,%lf,%lf,%d,%d", &triggerMinimumFrequency, &triggerMaximumFrequency, &triggerThreshold, &triggerHysteresis, &triggerPreTrigger, &triggerPostTrigger) == 6;
+
+        triggerPreTrigger = MAX(0, MIN(MAXIMUM_TRIGGER_PERIOD, triggerPreTrigger));
+
+        triggerPostTrigger = MAX(0, MIN(MAXIMUM_TRIGGER_PERIOD, triggerPostTrigger));
+
+        return triggerEnabled;
+
+    }
+
+    if (strcmp(name, "filter") == 0) return parseFilter(value);
+
+    if (strcmp(name, "duty-cycle") == 0) {
+
+        scheduleMode = SCHEDULE_DUTY_CYCLE;
+
+        return sscanf(value, "%d,%d", &dutyCycleRecordDuration, &dutyCyclePeriod) == 2;
+
+    }
+
+    if (strcmp(name, "window") == 0) return parseWindow(value);
+
+    if (strcmp(name, "suspend-processing") == 0) return parseBoolean(value, &suspendProcessing);
+
+    if (strcmp(name, "simulate") == 0) {
+
+        if (numberOfSimulationFiles == MAXIMUM_PLAYLIST_LENGTH || strlen(value) >= FILEPATH_SIZE) return false;
+
+        strcpy(simulationFiles[numberOfSimulationFiles], value);
+
+        numberOfSimulationFiles += 1;
+
+        return true;
+
+    }
+
+    if (strcmp(name, "generate") == 0) return parseGenerator(value);
+
+    if (strcmp(name, "generate-sample-rate") == 0) return sscanf(value, "%d", &generatorSettings.sampleRate) == 1;
+
+    if (strcmp(name, "generate-level") == 0) return sscanf(value, "%lf", &generatorSettings.level) == 1;
+
+    if (strcmp(name, "generate-duration") == 0) return sscanf(value, "%lf", &generatorSettings.duration) == 1 && generatorSettings.duration >= 0.0;
+
+    if (strcmp(name, "offline") == 0) return parseBoolean(value, &offline);
+
+    if (strcmp(name, "start-time") == 0) return sscanf(value, "%lf", &offlineStartTime) == 1;
+
+    if (strcmp(name, "virtual-backend") == 0) return parseBoolean(value, &virtualBackend);
+
+    if (strcmp(name, "virtual-hotplug") == 0) {
+
+        virtualBackend = true;
+
+        return sscanf(value, "%d", &virtualHotplugInterval) == 1 && virtualHotplugInterval > 0;
+
+    }
+
+    if (strcmp(name, "help") == 0) return parseBoolean(value, &helpRequested);
+
+    return false;
+
+}
+
+static DA_option_t *findOption(char *name) {
+
+    for (int32_t i = 0; i < NUMBER_OF_OPTIONS; i += 1) {
+
+        if (strcmp(options[i].name, name) == 0) return &options[i];
+
+    }
+
+    return NULL;
+
+}
+
+static bool readConfigFile(char *filename) {
+
+    FILE *file = fopen(filename, "r");
+
+    if (file == NULL) {
+
+        printf("[DAEMON] Could not open %s\n", filename);
+
+        return false;
+
+    }
+
+    bool success = true;
+
+    int32_t lineNumber = 0;
+
+    static char line[MAXIMUM_LINE_LENGTH];
+
+    while (success && fgets(line, MAXIMUM_LINE_LENGTH, file) != NULL) {
+
+        lineNumber += 1;
+
+        /* Skip comments and strip trailing white space */
+
+        if (line[strspn(line, " \t")] == '#') continue;
+
+        char *end = line + strlen(line);
+
+        while (end > line && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) *--end = 0;
+
+        /* Split the line into a name and an optional value separated by white space or an equals sign */
+
+        char *name = line + strspn(line, " \t");
+
+        if (*name == 0) continue;
+
+        char *value = name + strcspn(name, " \t=");
+
+        if (*value != 0) {
+
+            *value++ = 0;
+
+            value += strspn(value, " \t=");
+
+        }
+
+        DA_option_t *option = findOption(name);
+
+        success = option != NULL && (*value != 0 || option->argument == NULL) && applyOption(name, *value == 0 ? NULL : value);
+
+        if (success == false) printf("[DAEMON] Invalid option on line %d of %s\n", lineNumber, filename);
+
+    }
+
+    fclose(file);
+
+    return success;
+
+}
+
+static bool parseArguments(int argc, char **argv) {
+
+    for (int32_t i = 1; i < argc; i += 1) {
+
+        char *argument = argv[i];
+
+        if (strncmp(argument, "--", 2) != 0) {
+
+            printf("[DAEMON] Unexpected argument %s\n", argument);
+
+            return false;
+
+        }
+
+        DA_option_t *option = findOption(argument + 2);
+
+        char *value = NULL;
+
+        if (option != NULL && option->argument != NULL) value = i + 1 < argc ? argv[++i] : NULL;
+
+        if (option == NULL || (option->argument != NULL && value == NULL) || applyOption(argument + 2, value) == false) {
+
+            printf("[DAEMON] Invalid option %s\n", argument);
+
+            return false;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+static void printUsage(void) {
+
+    puts("Usage: backstage_daemon [options]\n");
+
+    for (int32_t i = 0; i < NUMBER_OF_OPTIONS; i += 1) printf("  --%s%s%s\n      %s\n", options[i].name, options[i].argument == NULL ? "" : " ", options[i].argument == NULL ? "" : options[i].argument, options[i].description);
+
+}
+
+/* Main function */
+
+int main(int argc, char **argv) {
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    bool success = parseArguments(argc, argv);
+
+    if (success == false || helpRequested) {
+
+        printUsage();
+
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    }
+
+    if (destination[0] == 0) {
+
+        puts("[DAEMON] A destination folder is required");
+
+        printUsage();
+
+        return EXIT_FAILURE;
+
+    }
+
+    if (offline && numberOfSimulationFiles == 0 && generatorEnabled == false) {
+
+        puts("[DAEMON] Offline processing requires at least one simulated WAV file or a generator");
+
+        return EXIT_FAILURE;
+
+    }
+
+    if (generatorEnabled && numberOfSimulationFiles > 0) {
+
+        puts("[DAEMON] Simulated WAV files and a generator cannot be used together");
+
+        return EXIT_FAILURE;
+
+    }
+
+    /* The engine writes into buffers owned by the caller */
+
+    int16_t *audioBuffer = malloc(AUDIO_BUFFER_SIZE * sizeof(int16_t));
+
+    float *stftBuffer = malloc(STFT_BUFFER_SIZE * sizeof(float));
+
+    if (audioBuffer == NULL || stftBuffer == NULL) {
+
+        puts("[DAEMON] Could not allocate audio buffers");
+
+        return EXIT_FAILURE;
+
+    }
+
+    /* Shut down cleanly on interrupt or termination */
+
+    signal(SIGINT, handleSignal);
+
+    signal(SIGTERM, handleSignal);
+
+#ifdef SIGBREAK
+    signal(SIGBREAK, handleSignal);
+#endif
+
+    /* Start the engine. Capture from a device which appears later is picked up by the background device check */
+
+    if (Engine_initialise(audioBuffer, stftBuffer, virtualBackend ? BACKEND_VIRTUAL : BACKEND_SYSTEM) == false) puts("[DAEMON] Engine did not start cleanly");
+
+    Engine_setAutoSaveCallback(handleAutosaveFailure);
+
+    Engine_setFileDestination(destination);
+
+    Engine_setLocalTime(localTime);
+
+    if (highDefaultSampleRate) Engine_setHighDefaultSampleRate(true);
+
+    if (sampleRate > 0) Engine_changeSampleRate(sampleRate);
+
+    Engine_setFilter(filterType, filterFrequency1, filterFrequency2);
+
+    if (triggerEnabled) Engine_setTrigger(true, triggerMinimumFrequency, triggerMaximumFrequency, triggerThreshold, triggerHysteresis, triggerPreTrigger, triggerPostTrigger);
+
+    if (scheduleMode == SCHEDULE_DUTY_CYCLE) Engine_setDutyCycleSchedule(dutyCycleRecordDuration, dutyCyclePeriod, suspendProcessing);
+
+    if (scheduleMode == SCHEDULE_WINDOWS) Engine_setWindowSchedule(numberOfWindows, windowStartMinutes, windowStopMinutes, suspendProcessing);
+
+    if (numberOfSimulationFiles > 0) {
+
+        Engine_clearSimulationPlaylist();
+
+        for (int32_t i = 0; i < numberOfSimulationFiles; i += 1) success &= Engine_addToSimulationPlaylist(simulationFiles[i]);
+
+        success = success && Engine_startSimulationPlaylist(offline, offlineStartTime);
+
+        if (success == false) {
+
+            puts("[DAEMON] Could not start simulation");
+
+            return EXIT_FAILURE;
+
+        }
+
+    }
+
+    if (generatorEnabled && Engine_startGenerator(&generatorSettings, offline, offlineStartTime) == false) {
+
+        puts("[DAEMON] Could not start generator");
+
+        return EXIT_FAILURE;
+
+    }
+
+    Engine_setAutoSave(autosaveDuration, segmentLength);
+
+    /* Drive the engine until asked to stop or offline processing completes */
+
+    EN_frame_t frame;
+
+    EN_stats_t stats;
+
+    int32_t frameCounter = 0;
+
+    bool virtualAudioMothConnected = false;
+
+    double previousRestartLatency = -1.0;
+
+    while (shutdownRequested == false) {
+
+        Engine_getFrame(&frame);
+
+        if (frame.oldAudioMothFound) puts("[DAEMON] Found an AudioMoth USB Microphone with old firmware");
+
+        if (offline && frame.offlineComplete) break;
+
+        /* Toggle the simulated AudioMoth and report how long each resulting device restart took */
+
+        if (virtualHotplugInterval > 0) {
+
+            frameCounter += 1;
+
+            if (frameCounter == virtualHotplugInterval * MICROSECONDS_IN_SECOND / FRAME_INTERVAL) {
+
+                virtualAudioMothConnected = !virtualAudioMothConnected;
+
+                Engine_setVirtualAudioMoth(virtualAudioMothConnected, VIRTUAL_AUDIOMOTH_SAMPLE_RATE);
+
+                frameCounter = 0;
+
+            }
+
+            Engine_getStats(&stats);
+
+            if (stats.deviceRestartLatency != previousRestartLatency) printf("[DAEMON] Device restart took %.1f ms\n", stats.deviceRestartLatency);
+
+            previousRestartLatency = stats.deviceRestartLatency;
+
+        }
+
+        usleep(FRAME_INTERVAL);
+
+    }
+
+    puts(shutdownRequested ? "[DAEMON] Shutting down on signal" : "[DAEMON] Shutting down");
+
+    /* Write out the current autosave file before exiting */
+
+    Engine_forceAutoSaveToStop();
+
+    if (Atomic_load32(&autosaveFailed)) puts("[DAEMON] One or more autosave files could not be written");
+
+    return Atomic_load32(&autosaveFailed) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+}
@@ -0,0 +1,4232 @@
+/****************************************************************************
+ * engine.c
+ * openacousticdevices.info
+ * January 2023
+ *****************************************************************************/
+
+#include <stdio.h>
+
+#ifdef __APPLE__
+    #define MA_NO_RUNTIME_LINKING
+#endif
+
+#define MINIAUDIO_IMPLEMENTATION
+
+#include "stft.h"
+#include "engine.h"
+#include "xtime.h"
+#include "macros.h"
+#include "threads.h"
+#include "wavFile.h"
+#include "autosave.h"
+#include "miniaudio.h"
+#include "simulator.h"
+#include "trigger.h"
+#include "prefilter.h"
+#include "timing.h"
+#include "timestamps.h"
+#include "schedule.h"
+#include "resampler.h"
+#include "heterodyne.h"
+#include "frequencyDivider.h"
+
+/* Callback constants */
+
+#define CALLBACKS_PER_SECOND                100
+
+/* Capture constants */
+
+#define NUMBER_OF_VALID_SAMPLE_RATES        8
+#define MAXIMUM_RECORD_DURATION             60
+#define DEFAULT_SAMPLE_RATE                 48000
+#define MAXIMUM_SAMPLE_RATE                 384000
+
+#define CAPTURE_BUFFER_SIZE                 (MAXIMUM_RECORD_DURATION * MAXIMUM_SAMPLE_RATE)
+
+/* Buffer constants */
+
+#define FILE_TIME_BUFFER                    1024
+#define DEVICE_NAME_SIZE                    1024
+#define FILENAME_SIZE                       8192
+
+/* Unit conversion constants */
+
+#define HERTZ_IN_KILOHERTZ                  1000
+
+#define SECONDS_IN_MINUTE                   60
+#define MINUTES_IN_HOUR                     60
+#define MILLISECONDS_IN_SECOND              1000
+#define PARTS_PER_MILLION                   1000000
+#define MICROSECONDS_IN_SECOND              1000000
+#define MICROSECONDS_IN_MILLISECOND         1000
+
+/* Frame timer constants */
+
+#define TIME_MISMATCH_LIMIT                 2000
+
+/* Simulation pacing constant. The deadlines are resynchronised rather than caught up after a longer stall */
+
+#define SIMULATION_MAXIMUM_LATENESS         (MICROSECONDS_IN_SECOND / 4)
+
+/* Offline processing constants. The backlog is in callbacks and bounds the number of trigger events waiting in the autosave queue */
+
+#define OFFLINE_MAXIMUM_BACKLOG             2
+#define OFFLINE_WAIT_INTERVAL               100
+
+/* Device check constant */
+
+#define DEVICE_STOP_START_TIMEOUT           2.0
+#define DEVICE_CHANGE_INTERVAL              1.0
+#define DEVICE_CHECK_INTERVAL               (MICROSECONDS_IN_SECOND / 4)
+
+/* Monitor constants */
+
+#define PLAYBACK_SAMPLE_RATE                48000
+#define PLAYBACK_BLOCK_SIZE                 (PLAYBACK_SAMPLE_RATE / CALLBACKS_PER_SECOND)
+#define PLAYBACK_INPUT_BLOCK_SIZE           (PLAYBACK_BLOCK_SIZE * MAXIMUM_SAMPLE_RATE / PLAYBACK_SAMPLE_RATE + 1)
+
+#define PLAYBACK_NUMBER_OF_CHANNELS         2
+
+#if IS_WINDOWS
+    #define MAXIMUM_PLAYBACK_LAG            (CALLBACKS_PER_SECOND / 2)
+    #define TARGET_PLAYBACK_LAG             (CALLBACKS_PER_SECOND / 10)
+    #define TARGET_MINIMUM_PLAYBACK_LAG     (CALLBACKS_PER_SECOND / 10)
+#else
+    #define MAXIMUM_PLAYBACK_LAG            (CALLBACKS_PER_SECOND / 4)
+    #define TARGET_PLAYBACK_LAG             (CALLBACKS_PER_SECOND / 20)
+    #define TARGET_MINIMUM_PLAYBACK_LAG     (CALLBACKS_PER_SECOND / 20)
+#endif
+
+/* Minimum playback lag in device periods of the active latency profile */
+
+#define MINIMUM_PLAYBACK_LAG                2
+
+#define TARGET_PLAYBACK_LAG_MILLISECONDS    (TARGET_PLAYBACK_LAG * MILLISECONDS_IN_SECOND / CALLBACKS_PER_SECOND)
+
+/* Low latency profile constants */
+
+#define LOW_LATENCY_CALLBACKS_PER_SECOND    400
+#define LOW_LATENCY_NUMBER_OF_PERIODS       2
+#define LOW_LATENCY_TARGET_PLAYBACK_LAG     6
+
+/* Virtual backend constant. The null playback sink keeps the most recent output it would have played */
+
+#define SINK_DURATION                       10
+#define SINK_BUFFER_SIZE                    (SINK_DURATION * PLAYBACK_SAMPLE_RATE * PLAYBACK_NUMBER_OF_CHANNELS)
+
+/* Loopback latency measurement constants */
+
+#define LATENCY_IDLE                        0
+#define LATENCY_REQUESTED                   1
+#define LATENCY_CLICK_SENT                  2
+
+#define LATENCY_CLICK_LENGTH                24
+#define LATENCY_CLICK_AMPLITUDE             (INT16_MAX / 2)
+#define LATENCY_DETECTION_THRESHOLD         (INT16_MAX / 8)
+#define LATENCY_MEASUREMENT_TIMEOUT         1.0
+
+/* Playback drift compensation constants */
+
+#define DRIFT_PROPORTIONAL_GAIN             0.2
+#define DRIFT_INTEGRAL_GAIN                 0.01
+#define DRIFT_LAG_SMOOTHING                 0.05
+#define MAXIMUM_DRIFT_ADJUSTMENT            0.005
+
+#define MAXIMUM_FREQUENCY_DIVISION          32
+
+/* Review playback constants */
+
+#define NUMBER_OF_TIME_EXPANSIONS           3
+
+#define REVIEW_IDLE                         0
+#define REVIEW_STARTING                     1
+#define REVIEW_PLAYING                      2
+
+/* Autosave constants */
+
+#define AUTOSAVE_EVENT_QUEUE_SIZE           64
+
+/* State events wait up to a second in millisecond steps for space in the queue */
+
+#define AUTOSAVE_EVENT_RETRY_INTERVAL       1000
+#define AUTOSAVE_EVENT_RETRY_LIMIT          1000
+
+#define DEVICE_SHUTDOWN_TIMEOUT             2.0
+
+/* Audio buffer variables */
+
+static int16_t *audioBuffer;
+
+static int64_t audioBufferStartTime;
+
+static int32_t audioBufferIndex;
+
+static int32_t audioBufferWriteIndex;
+
+static int64_t audioBufferSampleCount;
+
+static pthread_mutex_t audioBufferMutex;
+
+/* Working STFT buffer */
+
+static float* stftBuffer;
+
+/* Capture buffer variables */
+
+static char captureBufferDeviceCommentName[DEVICE_NAME_SIZE];
+
+static int16_t captureBuffer[CAPTURE_BUFFER_SIZE];
+
+static int64_t captureBufferSampleCount;
+
+static int32_t captureBufferWriteIndex;
+
+static int32_t captureBufferSampleRate;
+
+static int64_t captureBufferStartTime;
+
+static int32_t captureBufferLength;
+
+static int32_t captureBufferLocalTimeOffset;
+
+static void (*captureBufferCallback)(bool success);
+
+static pthread_t captureBufferThread;
+
+static bool captureBufferSuccess;
+
+/* Playback variables */
+
+static pthread_t startPlaybackThread;
+
+static pthread_t stopPlaybackThread;
+
+/* Simulation variables */
+
+static bool shouldStopSimulation;
+
+static bool shouldStartSimulation;
+
+static pthread_t simulationThread;
+
+static bool simulationRunning;
+
+static pthread_mutex_t simulationRunningMutex;
+
+static int16_t simulationBuffer[MAXIMUM_SAMPLE_RATE / CALLBACKS_PER_SECOND];
+
+static int32_t simulationPlaylistLength;
+
+/* Set by the simulation thread when the next file in the playlist has a different sample rate */
+
+static volatile uint32_t simulationSampleRateChanged;
+
+/* Mean and maximum lateness of the simulation thread wakeups over the last second in microseconds */
+
+static volatile uint32_t simulationMeanJitter;
+
+static volatile uint32_t simulationMaximumJitter;
+
+/* Offline processing feeds the playlist through the pipeline as fast as it can be consumed, timed by its own sample clock */
+
+static volatile uint32_t offlineProcessing;
+
+static bool simulationOffline;
+
+static bool offlineRequested;
+
+static int64_t offlineRequestedStartTime;
+
+static int64_t offlineClockTime;
+
+static int64_t offlineClockRemainder;
+
+static volatile uint32_t offlineFinished;
+
+static volatile uint32_t offlineThroughput;
+
+static volatile int64_t offlineSamplesProcessed;
+
+/* Frontend state variables */
+
+static double timeDeviceStarted;
+
+static bool heterodyneEnabled;
+
+/* Heterodyne bank settings published to the playback callback with a sequence counter which is odd while they are being written */
+
+static volatile uint32_t heterodyneSettingsSequence;
+
+static int32_t heterodyneNumberOfChannels = 1;
+
+static int32_t heterodyneFrequencies[HETERODYNE_MAXIMUM_CHANNELS] = {DEFAULT_HETERODYNE_FREQUENCY};
+
+static float heterodynePans[HETERODYNE_MAXIMUM_CHANNELS];
+
+static bool frequencyDivisionEnabled;
+
+static volatile int32_t frequencyDivision = DEFAULT_FREQUENCY_DIVISION;
+
+static bool monitorEnabled;
+
+static bool frontEndPaused;
+
+static ma_timer timer;
+
+/* File destination variables */
+
+static bool fileDestinationSet;
+
+static pthread_mutex_t fileDestinationMutex;
+
+static char fileDestination[FILEPATH_SIZE];
+
+/* Local time variable */
+
+static volatile uint32_t useLocalTime = true;
+
+/* Background thread variables */
+
+static pthread_t backgroundThread;
+
+static pthread_mutex_t backgroundMutex;
+
+static double backgroundDeviceCheckTime;
+
+static pthread_mutex_t backgroundDeviceCheckMutex;
+
+static bool backgroundDeviceCheckFoundAudioMoth;
+
+static bool backgroundDeviceCheckFoundOldAudioMoth;
+
+/* Autosave capture variables */
+
+static int32_t autosaveDuration;
+
+static int32_t autosaveSegmentLength;
+
+static int64_t autosaveStartTime;
+
+static int64_t autosaveSampleCount;
+
+static int64_t autosaveStartSampleCount;
+
+/* Autosave file variables */
+
+static time_t autosaveFileStartTime;
+
+static int32_t autosaveFileStartIndex;
+
+static int64_t autosaveFileStartCount;
+
+static int32_t autosaveFileSampleRate;
+
+static int32_t autosaveFileSegmentLength;
+
+static bool autosaveFileTriggered;
+
+static bool autosaveTriggerOpen;
+
+static AS_event_t autosaveTriggerStartEvent;
+
+static int64_t autosaveFileReferenceTime;
+
+static int64_t autosaveFileReferenceCount;
+
+/* Autosave state variables */
+
+static bool autosaveShutdownCompleted;
+
+static pthread_mutex_t autosaveMutex;
+
+static volatile int64_t autosaveTargetCount = INT64_MAX;
+
+/* Schedule state variables */
+
+static bool scheduleSuspendsProcessing;
+
+static volatile uint32_t processingSuspended;
+
+static volatile int64_t scheduleTransitionCount = INT64_MAX;
+
+static bool autosaveWaitingForStartEvent = true;
+
+static char autosaveInputDeviceCommentName[DEVICE_NAME_SIZE];
+
+static char autosaveTriggerDeviceCommentName[DEVICE_NAME_SIZE];
+
+static void (*autosaveErrorCallback)(void);
+
+/* Autosave thread variables */
+
+static pthread_t autosaveThread;
+
+static bool autosaveWakePending;
+
+/* Sample count the autosave thread has caught up with, used to hold back offline processing */
+
+static volatile int64_t autosaveProcessedCount;
+
+/* Set when an event could not be queued so the autosave thread reports it through the error callback */
+
+static volatile uint32_t autosaveEventDropped;
+
+static pthread_cond_t autosaveWakeCondition;
+
+static pthread_mutex_t autosaveWakeMutex;
+
+/* Playback start variables */
+
+static int32_t playbackReadIndex = 0;
+
+static int32_t playbackBufferCount = 1;
+
+static int32_t minimumPlaybackBufferLag = INT32_MAX;
+
+static pthread_mutex_t playbackMutex;
+
+/* Playback statistics variables protected by the playback mutex */
+
+static double playbackLagMilliseconds;
+
+static double playbackDriftAdjustment;
+
+static double measuredLoopbackLatency = -1.0;
+
+/* Monitor write index published on every capture callback rather than every STFT frame */
+
+static volatile uint32_t monitorBufferWriteIndex;
+
+/* Review playback variables. Parameters are written before the state is set to starting and copied by the playback callback */
+
+static volatile uint32_t reviewState = REVIEW_IDLE;
+
+static volatile uint32_t reviewCursor;
+
+static int32_t reviewStartIndex;
+
+static int32_t reviewStopIndex;
+
+static int32_t reviewExpansion;
+
+static bool playbackDeviceRunning;
+
+/* Latency profile variables */
+
+static bool lowLatencyEnabled;
+
+static bool exclusiveModeEnabled;
+
+static bool requestedLowLatency;
+
+static bool requestedExclusiveMode;
+
+static bool latencyProfileChanged = false;
+
+static volatile uint32_t targetPlaybackLagMilliseconds = TARGET_PLAYBACK_LAG_MILLISECONDS;
+
+static volatile uint32_t playbackCallbacksPerSecond = CALLBACKS_PER_SECOND;
+
+/* Loopback latency measurement variables */
+
+static volatile uint32_t latencyMeasurementState = LATENCY_IDLE;
+
+static double latencyClickTime;
+
+/* Miniaudio contexts */
+
+static ma_context playbackContext;
+
+static ma_context deviceCheckContext;
+
+/* Virtual backend variables. The null capture device is presented as an AudioMoth while one is connected */
+
+static bool virtualBackend;
+
+static volatile uint32_t virtualAudioMothConnected;
+
+static volatile uint32_t virtualAudioMothSampleRate;
+
+static int16_t sinkBuffer[SINK_BUFFER_SIZE];
+
+static int32_t sinkWriteIndex;
+
+static int64_t sinkSampleCount;
+
+static pthread_mutex_t sinkMutex;
+
+/* Device restart timing variables. The latency is in microseconds and negative until measured */
+
+static volatile int64_t deviceRestartRequestTime;
+
+static volatile int64_t deviceRestartLatency = -1;
+
+/* Stop and start variable */
+
+static bool stopped;
+
+static bool started;
+
+static pthread_mutex_t stopStartMutex;
+
+/* State variables */
+
+static bool usingAudioMoth;
+
+static ma_device captureDevice;
+
+static ma_device playbackDevice;
+
+static ma_device_id audioMothDeviceID;
+
+static bool shouldSetRedrawFlag = true;
+
+static bool requestedSampleRateChanged = false;
+
+static int32_t requestedMaximumDefaultSampleRate;
+
+static bool maximumDefaultSampleRateChanged = false;
+
+/* Sample rate variables */
+
+static int32_t currentSampleRate;
+
+/* Sample rate handed to the capture path to switch to at the next frame boundary, or zero */
+
+static volatile uint32_t pendingSampleRate;
+
+static volatile uint32_t sampleRateSwitched;
+
+static int32_t audioMothSampleRate;
+
+static int32_t requestedSampleRate = DEFAULT_SAMPLE_RATE;
+
+static int32_t maximumDefaultSampleRate = DEFAULT_SAMPLE_RATE;
+
+static int32_t validSampleRates[NUMBER_OF_VALID_SAMPLE_RATES] = {8000, 16000, 32000, 48000, 96000, 192000, 250000, 384000};
+
+static int32_t validTimeExpansions[NUMBER_OF_TIME_EXPANSIONS] = {1, 10, 20};
+
+/* Input device variables */
+
+static int32_t inputDeviceSampleRate;
+
+static char inputDeviceName[DEVICE_NAME_SIZE];
+
+static char inputDeviceCommentName[DEVICE_NAME_SIZE];
+
+static int32_t inputDeviceCommentNameID;
+
+/* Structure for a stereo pair of monitor resamplers kept in lockstep */
+
+typedef struct {
+    RS_resampler_t left;
+    RS_resampler_t right;
+    bool stereo;
+    bool valid;
+} monitor_resampler_t;
+
+/* Structure for device check */
+
+typedef struct {
+    bool audioMothFound;
+    bool oldAudioMothFound;
+} device_check_t;
+
+/* Structure for device enumeration */
+
+typedef struct {
+    bool updateAudioMothSettings;
+    device_check_t device_check;
+} enumerate_devices_t;
+
+/* Callbacks to handle capture and playback of audio samples */
+
+void capture_notification_callback(const ma_device_notification *pNotification) {
+
+    if (pNotification->type == ma_device_notification_type_started) { }
+
+    if (pNotification->type == ma_device_notification_type_stopped) {
+        
+        pthread_mutex_lock(&stopStartMutex);
+        
+        stopped = true;
+
+        pthread_mutex_unlock(&stopStartMutex);
+
+    }
+
+    if (pNotification->type == ma_device_notification_type_rerouted) { }
+
+    if (pNotification->type == ma_device_notification_type_interruption_began) { }
+
+    if (pNotification->type == ma_device_notification_type_interruption_ended) { }
+
+}
+
+/* Functions to convert and resample monitor audio, shared by live and review playback */
+
+static float playbackInputBlock[PLAYBACK_INPUT_BLOCK_SIZE];
+
+static float playbackMixedBlock[PLAYBACK_INPUT_BLOCK_SIZE];
+
+static float playbackMixedRightBlock[PLAYBACK_INPUT_BLOCK_SIZE];
+
+static float playbackBankBlock[PLAYBACK_INPUT_BLOCK_SIZE * HETERODYNE_MAXIMUM_CHANNELS];
+
+static float playbackOutputBlock[PLAYBACK_BLOCK_SIZE];
+
+static float playbackOutputRightBlock[PLAYBACK_BLOCK_SIZE];
+
+static int32_t getMonitorDecimation(int32_t sampleRate, bool convert) {
+
+    /* Heterodyne or frequency divide at the source rate and decimate to the playback rate when it divides exactly */
+
+    bool convertToAudible = convert && (heterodyneEnabled || frequencyDivisionEnabled);
+
+    return convertToAudible && sampleRate % PLAYBACK_SAMPLE_RATE == 0 ? sampleRate / PLAYBACK_SAMPLE_RATE : 1;
+
+}
+
+static bool initialiseMonitorResampler(monitor_resampler_t *resampler, int32_t inputSampleRate, bool adjustable) {
+
+    resampler->valid = Resampler_initialise(&resampler->left, inputSampleRate, PLAYBACK_SAMPLE_RATE, adjustable);
+
+    resampler->right = resampler->left;
+
+    resampler->stereo = false;
+
+    return resampler->valid;
+
+}
+
+static void setMonitorResamplerAdjustment(monitor_resampler_t *resampler, double adjustment) {
+
+    Resampler_setAdjustment(&resampler->left, adjustment);
+
+    Resampler_setAdjustment(&resampler->right, adjustment);
+
+}
+
+static void convertAndResample(monitor_resampler_t *resampler, int32_t numberOfSamples, int32_t sampleRate, int32_t decimation, bool convert, int32_t numberOfOutputSamples, int16_t *outputBuffer) {
+
+    static int32_t heterodyneSampleRate;
+
+    static uint32_t heterodyneSequenceInUse = UINT32_MAX;
+
+    static int32_t numberOfChannels = 1;
+
+    static float gainLeft[HETERODYNE_MAXIMUM_CHANNELS];
+
+    static float gainRight[HETERODYNE_MAXIMUM_CHANNELS];
+
+    /* Play silence rather than the wrong pitch if no filter bank was designed for this rate */
+
+    if (resampler->valid == false) {
+
+        for (int32_t i = 0; i < PLAYBACK_NUMBER_OF_CHANNELS * numberOfOutputSamples; i += 1) outputBuffer[i] = 0;
+
+        return;
+
+    }
+
+    /* Apply new heterodyne bank settings once a consistent copy has been read */
+
+    uint32_t sequence = Atomic_load32(&heterodyneSettingsSequence);
+
+    if (convert && heterodyneEnabled && sequence % 2 == 0 && (heterodyneSampleRate != sampleRate || heterodyneSequenceInUse != sequence)) {
+
+        int32_t channels = heterodyneNumberOfChannels;
+
+        int32_t frequencies[HETERODYNE_MAXIMUM_CHANNELS];
+
+        float pans[HETERODYNE_MAXIMUM_CHANNELS];
+
+        memcpy(frequencies, heterodyneFrequencies, sizeof(frequencies));
+
+        memcpy(pans, heterodynePans, sizeof(pans));
+
+        Atomic_acquireFence();
+
+        if (Atomic_load32(&heterodyneSettingsSequence) == sequence) {
+
+            numberOfChannels = channels;
+
+            /* Balance law keeps a centred channel at full level on both sides and the sum is scaled so the channels cannot clip together */
+
+            float mixGain = 1.0f / (float)MAX(1, numberOfChannels);
+
+            for (int32_t c = 0; c < numberOfChannels; c += 1) {
+
+                gainLeft[c] = mixGain * MIN(1.0f, 1.0f - pans[c]);
+
+                gainRight[c] = mixGain * MIN(1.0f, 1.0f + pans[c]);
+
+            }
+
+            heterodyneSampleRate = sampleRate;
+
+            heterodyneSequenceInUse = sequence;
+
+            Heterodyne_updateChannels(heterodyneSampleRate, numberOfChannels, frequencies);
+
+        }
+
+    }
+
+    /* Convert and decimate the block if required and then resample to the playback rate */
+
+    bool stereo = convert && heterodyneEnabled;
+
+    if (stereo && resampler->stereo == false) resampler->right = resampler->left;
+
+    resampler->stereo = stereo;
+
+    if (stereo) {
+
+        int32_t numberOfBankSamples = numberOfSamples / decimation;
+
+        Heterodyne_processBlock(playbackInputBlock, numberOfSamples, decimation, playbackBankBlock);
+
+        for (int32_t i = 0; i < numberOfBankSamples; i += 1) {
+
+            float left = 0.0f;
+
+            float right = 0.0f;
+
+            for (int32_t c = 0; c < numberOfChannels; c += 1) {
+
+                left += gainLeft[c] * playbackBankBlock[i * numberOfChannels + c];
+
+                right += gainRight[c] * playbackBankBlock[i * numberOfChannels + c];
+
+            }
+
+            playbackMixedBlock[i] = left;
+
+            playbackMixedRightBlock[i] = right;
+
+        }
+
+        Resampler_process(&resampler->left, playbackMixedBlock, numberOfOutputSamples, playbackOutputBlock);
+
+        Resampler_process(&resampler->right, playbackMixedRightBlock, numberOfOutputSamples, playbackOutputRightBlock);
+
+    } else if (convert && frequencyDivisionEnabled) {
+
+        FrequencyDivider_processBlock(playbackInputBlock, numberOfSamples, sampleRate, frequencyDivision, decimation, playbackMixedBlock);
+
+        Resampler_process(&resampler->left, playbackMixedBlock, numberOfOutputSamples, playbackOutputBlock);
+
+    } else {
+
+        Resampler_process(&resampler->left, playbackInputBlock, numberOfOutputSamples, playbackOutputBlock);
+
+    }
+
+    float *rightBlock = stereo ? playbackOutputRightBlock : playbackOutputBlock;
+
+    for (int32_t i = 0; i < numberOfOutputSamples; i += 1) {
+
+        float left = MAX(INT16_MIN, MIN(INT16_MAX, roundf(playbackOutputBlock[i])));
+
+        float right = MAX(INT16_MIN, MIN(INT16_MAX, roundf(rightBlock[i])));
+
+        outputBuffer[PLAYBACK_NUMBER_OF_CHANNELS * i] = (int16_t)left;
+
+        outputBuffer[PLAYBACK_NUMBER_OF_CHANNELS * i + 1] = (int16_t)right;
+
+    }
+
+}
+
+/* Function to stream the selected region of the paused capture buffer with its own cursor */
+
+static void reviewPlayback(int16_t *outputBuffer, ma_uint32 frameCount) {
+
+    static monitor_resampler_t reviewResampler;
+
+    static int32_t cursor;
+
+    static int32_t stopIndex;
+
+    static int32_t sampleRate;
+
+    static int32_t decimation;
+
+    static bool convert;
+
+    if (Atomic_load32(&reviewState) == REVIEW_STARTING) {
+
+        cursor = reviewStartIndex;
+
+        stopIndex = reviewStopIndex;
+
+        /* Time expansion plays the captured samples at a fraction of their rate so ultrasound becomes audible directly */
+
+        convert = reviewExpansion == 1;
+
+        sampleRate = captureBufferSampleRate / reviewExpansion;
+
+        decimation = getMonitorDecimation(sampleRate, convert);
+
+        initialiseMonitorResampler(&reviewResampler, sampleRate / decimation, false);
+
+        Atomic_store32(&reviewState, REVIEW_PLAYING);
+
+    }
+
+    ma_uint32 outputIndex = 0;
+
+    while (outputIndex < frameCount) {
+
+        int32_t numberOfOutputSamples = MIN(PLAYBACK_BLOCK_SIZE, (int32_t)(frameCount - outputIndex));
+
+        int32_t numberOfSamples = Resampler_getNumberOfInputSamples(&reviewResampler.left, numberOfOutputSamples) * decimation;
+
+        if (cursor + numberOfSamples > stopIndex) break;
+
+        for (int32_t i = 0; i < numberOfSamples; i += 1) playbackInputBlock[i] = (float)captureBuffer[cursor + i];
+
+        cursor += numberOfSamples;
+
+        convertAndResample(&reviewResampler, numberOfSamples, sampleRate, decimation, convert, numberOfOutputSamples, outputBuffer + PLAYBACK_NUMBER_OF_CHANNELS * outputIndex);
+
+        outputIndex += numberOfOutputSamples;
+
+    }
+
+    Atomic_store32(&reviewCursor, (uint32_t)cursor);
+
+    /* Pad with silence and finish at the end of the selection */
+
+    if (outputIndex < frameCount) {
+
+        for (ma_uint32 i = PLAYBACK_NUMBER_OF_CHANNELS * outputIndex; i < PLAYBACK_NUMBER_OF_CHANNELS * frameCount; i += 1) outputBuffer[i] = 0;
+
+        Atomic_compareExchange32(&reviewState, REVIEW_PLAYING, REVIEW_IDLE);
+
+    }
+
+}
+
+void playback_data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount) {
+
+    int16_t *outputBuffer = (int16_t*)pOutput;
+
+    /* Review playback replaces the live monitor and leaves the live read index alone */
+
+    if (Atomic_load32(&reviewState) != REVIEW_IDLE) {
+
+        reviewPlayback(outputBuffer, frameCount);
+
+        return;
+
+    }
+
+    /* Static playback variables */
+
+    static bool playbackBufferWaiting = false;
+
+    static monitor_resampler_t playbackResampler;
+
+    static double smoothedLagError;
+
+    static double driftIntegral;
+
+    /* Calculate the buffer lag */
+
+    int32_t sampleRate = currentSampleRate;
+
+    int32_t writeIndex = (int32_t)Atomic_load32(&monitorBufferWriteIndex);
+
+    int32_t sampleLag = (AUDIO_BUFFER_SIZE + writeIndex - playbackReadIndex) % AUDIO_BUFFER_SIZE;
+
+    int32_t bufferLag = sampleLag * CALLBACKS_PER_SECOND / sampleRate;
+
+    int32_t targetSampleLag = (int32_t)Atomic_load32(&targetPlaybackLagMilliseconds) * sampleRate / MILLISECONDS_IN_SECOND;
+
+    int32_t minimumSampleLag = MINIMUM_PLAYBACK_LAG * sampleRate / (int32_t)Atomic_load32(&playbackCallbacksPerSecond);
+
+    /* Check minimum buffer lag */
+
+    if (bufferLag > MAXIMUM_PLAYBACK_LAG) {
+       
+        playbackReadIndex = writeIndex;
+
+        playbackBufferWaiting = true;
+
+        smoothedLagError = 0.0;
+
+        sampleLag = 0;
+
+        bufferLag = 0;
+
+    }
+
+    /* Update shared global variables */
+
+    bool starvation = (double)sampleLag < 1.0 + (1.0 + MAXIMUM_DRIFT_ADJUSTMENT) * (double)frameCount * (double)sampleRate / (double)PLAYBACK_SAMPLE_RATE;
+
+    pthread_mutex_lock(&playbackMutex);
+
+    minimumPlaybackBufferLag = MIN(bufferLag, minimumPlaybackBufferLag);
+
+    playbackBufferCount += playbackBufferWaiting == false && (sampleLag < minimumSampleLag || starvation) ? 2 : 0;
+
+    pthread_mutex_unlock(&playbackMutex);
+
+    /* Provide samples to playback device */
+
+    if (playbackBufferWaiting || starvation) {
+
+        for (ma_uint32 i = 0; i < PLAYBACK_NUMBER_OF_CHANNELS * frameCount; i += 1) outputBuffer[i] = 0;
+
+    } else {
+
+        int32_t monitorDecimation = getMonitorDecimation(sampleRate, true);
+
+        int32_t resamplerSampleRate = sampleRate / monitorDecimation;
+
+        if (playbackResampler.left.inputSampleRate != resamplerSampleRate) {
+
+            initialiseMonitorResampler(&playbackResampler, resamplerSampleRate, true);
+
+            smoothedLagError = 0.0;
+
+        }
+
+        /* Trim the resampler ratio with a PI controller on the buffer lag to track drift between the capture and playback clocks */
+
+        double lagError = (double)(sampleLag - targetSampleLag) / (double)sampleRate;
+
+        smoothedLagError += DRIFT_LAG_SMOOTHING * (lagError - smoothedLagError);
+
+        double interval = (double)frameCount / (double)PLAYBACK_SAMPLE_RATE;
+
+        driftIntegral = MAX(-MAXIMUM_DRIFT_ADJUSTMENT, MIN(MAXIMUM_DRIFT_ADJUSTMENT, driftIntegral + DRIFT_INTEGRAL_GAIN * smoothedLagError * interval));
+
+        double adjustment = MAX(-MAXIMUM_DRIFT_ADJUSTMENT, MIN(MAXIMUM_DRIFT_ADJUSTMENT, DRIFT_PROPORTIONAL_GAIN * smoothedLagError + driftIntegral));
+
+        setMonitorResamplerAdjustment(&playbackResampler, adjustment);
+
+        pthread_mutex_lock(&playbackMutex);
+
+        playbackLagMilliseconds = (double)sampleLag * MILLISECONDS_IN_SECOND / (double)sampleRate;
+
+        playbackDriftAdjustment = adjustment;
+
+        pthread_mutex_unlock(&playbackMutex);
+
+        ma_uint32 outputIndex = 0;
+
+        while (outputIndex < frameCount) {
+
+            int32_t numberOfOutputSamples = MIN(PLAYBACK_BLOCK_SIZE, (int32_t)(frameCount - outputIndex));
+
+            int32_t numberOfResamplerSamples = Resampler_getNumberOfInputSamples(&playbackResampler.left, numberOfOutputSamples);
+
+            int32_t numberOfSamples = numberOfResamplerSamples * monitorDecimation;
+
+            /* Read a block from the audio buffer */
+
+            for (int32_t i = 0; i < numberOfSamples; i += 1) {
+
+                playbackInputBlock[i] = (float)audioBuffer[playbackReadIndex];
+
+                playbackReadIndex = (playbackReadIndex + 1) % AUDIO_BUFFER_SIZE;
+
+            }
+
+            convertAndResample(&playbackResampler, numberOfSamples, sampleRate, monitorDecimation, true, numberOfOutputSamples, outputBuffer + PLAYBACK_NUMBER_OF_CHANNELS * outputIndex);
+
+            outputIndex += numberOfOutputSamples;
+
+        }
+
+    }
+
+    /* Overwrite the start of the buffer with a click for loopback latency measurement */
+
+    if (Atomic_load32(&latencyMeasurementState) == LATENCY_REQUESTED) {
+
+        for (ma_uint32 i = 0; i < PLAYBACK_NUMBER_OF_CHANNELS * MIN(LATENCY_CLICK_LENGTH, frameCount); i += 1) outputBuffer[i] = (i / PLAYBACK_NUMBER_OF_CHANNELS) % 2 ? -LATENCY_CLICK_AMPLITUDE : LATENCY_CLICK_AMPLITUDE;
+
+        latencyClickTime = ma_timer_get_time_in_seconds(&timer);
+
+        Atomic_store32(&latencyMeasurementState, LATENCY_CLICK_SENT);
+
+    }
+
+    if (sampleLag > targetSampleLag) playbackBufferWaiting = false;
+
+}
+
+/* Function to wake the autosave thread */
+
+static void signalAutosaveThread(void) {
+
+    pthread_mutex_lock(&autosaveWakeMutex);
+
+    autosaveWakePending = true;
+
+    pthread_cond_signal(&autosaveWakeCondition);
+
+    pthread_mutex_unlock(&autosaveWakeMutex);
+
+}
+
+/* Function to pass events to the autosave thread */
+
+static void addAutosaveEvent(AS_event_type_t eventType) {
+
+    AS_event_t event;
+
+    event.type = eventType;
+
+    event.sampleRate = currentSampleRate;
+
+    pthread_mutex_lock(&audioBufferMutex);
+
+    event.currentCount = autosaveSampleCount;
+    event.currentIndex = audioBufferWriteIndex;
+ 
+    event.startTime = autosaveStartTime;
+    event.startCount = autosaveStartSampleCount;
+
+    pthread_mutex_unlock(&audioBufferMutex);
+
+    event.deviceNameID = inputDeviceCommentNameID;
+
+    bool added = Autosave_addEvent(&event);
+
+    /* State events come from the frontend thread so can wait for the autosave thread to drain the queue */
+
+    bool stateEvent = eventType == AS_START || eventType == AS_STOP || eventType == AS_SHUTDOWN;
+
+    for (int32_t i = 0; stateEvent && added == false && i < AUTOSAVE_EVENT_RETRY_LIMIT; i += 1) {
+
+        signalAutosaveThread();
+
+        usleep(AUTOSAVE_EVENT_RETRY_INTERVAL);
+
+        added = Autosave_addEvent(&event);
+
+    }
+
+    if (added == false) {
+
+        puts("[AUTOSAVE] Event queue full");
+
+        Atomic_store32(&autosaveEventDropped, true);
+
+    }
+
+    signalAutosaveThread();
+
+}
+
+/* Functions to pass triggered segment transitions to the autosave thread */
+
+static void addTriggerEvent(AS_event_type_t eventType, TR_segment_t *segment, int32_t currentIndex) {
+
+    /* Start time and count are only written by the capture path so can be read here without locking */
+
+    AS_event_t event;
+
+    event.type = eventType;
+
+    event.sampleRate = currentSampleRate;
+
+    event.currentIndex = currentIndex;
+
+    event.deviceNameID = inputDeviceCommentNameID;
+
+    event.currentCount = eventType == AS_TRIGGER_STOP ? segment->stopCount : segment->startCount;
+
+    event.startTime = autosaveStartTime;
+
+    event.startCount = autosaveStartSampleCount;
+
+    event.triggerStartCount = MAX(segment->startCount, autosaveStartSampleCount);
+
+    bool added = Autosave_addEvent(&event);
+
+    if (added == false) {
+
+        puts("[AUTOSAVE] Event queue full");
+
+        Atomic_store32(&autosaveEventDropped, true);
+
+    }
+
+    signalAutosaveThread();
+
+}
+
+static void addTriggerEvents(int32_t transitions, TR_segment_t *segment, int32_t currentIndex) {
+
+    if (transitions & TR_SEGMENT_STOPPED) addTriggerEvent(AS_TRIGGER_STOP, segment, currentIndex);
+
+    if (transitions & TR_SEGMENT_STARTED) addTriggerEvent(AS_TRIGGER_START, segment, currentIndex);
+
+}
+
+/* Function to change the decimation ratio without restarting the capture device */
+
+static void switchSampleRate(int32_t sampleRate, int32_t increment, TR_segment_t *segment) {
+
+    /* Close any triggered segment recorded at the old rate */
+
+    int64_t switchCount = autosaveSampleCount + increment;
+
+    addTriggerEvents(Trigger_flush(switchCount, segment), segment, audioBufferIndex);
+
+    pthread_mutex_lock(&audioBufferMutex);
+
+    /* Publish the frames decimated at the old rate */
+
+    audioBufferWriteIndex = (audioBufferWriteIndex + increment) % AUDIO_BUFFER_SIZE;
+
+    audioBufferSampleCount += increment;
+
+    autosaveSampleCount = switchCount;
+
+    /* Rebase the start times so the sample counts restart at the new rate */
+
+    audioBufferStartTime += Timing_samplesToMilliseconds(audioBufferSampleCount, currentSampleRate);
+
+    audioBufferSampleCount = 0;
+
+    autosaveStartTime += Timing_samplesToMilliseconds(autosaveSampleCount - autosaveStartSampleCount, currentSampleRate);
+
+    autosaveStartSampleCount = autosaveSampleCount;
+
+    currentSampleRate = sampleRate;
+
+    pthread_mutex_unlock(&audioBufferMutex);
+
+    /* Start a new autosave file at the switch so no samples are lost */
+
+    addAutosaveEvent(AS_RESTART);
+
+    Atomic_store32(&sampleRateSwitched, true);
+
+    printf("[BACKSTAGE] Switched sample rate to %d\n", sampleRate);
+
+}
+
+void capture_data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount) {
+
+    static int64_t signalledTargetCount = INT64_MAX;
+
+    int64_t startTime = 0;
+
+    int32_t increment = 0;
+
+    int16_t *inputBuffer = (int16_t*)pInput;
+
+    /* Static resample variables */
+
+    static TR_segment_t triggerSegment;
+
+    static RS_captureResampler_t captureResampler;
+
+    /* Start of the samples not yet passed through the prefilter */
+
+    static int32_t prefilterIndex = 0;
+
+    bool offline = Atomic_load32(&offlineProcessing);
+
+    /* Check for restart */
+
+    pthread_mutex_lock(&stopStartMutex);
+
+    bool restart = started == false;
+
+    pthread_mutex_unlock(&stopStartMutex);
+
+    if (restart) {
+
+        /* Close any triggered segment recorded before the restart */
+
+        addTriggerEvents(Trigger_flush(autosaveSampleCount, &triggerSegment), &triggerSegment, audioBufferWriteIndex);
+
+        /* Get start time */
+
+        startTime = offline ? offlineClockTime / MICROSECONDS_IN_MILLISECOND : Time_getMillisecondUTC();
+
+        offlineClockRemainder = 0;
+
+        /* Reset resampler */
+
+        Resampler_initialiseCapture(&captureResampler, inputDeviceSampleRate, currentSampleRate);
+
+        /* Reset prefilter */
+
+        Prefilter_reset();
+
+        prefilterIndex = audioBufferIndex;
+
+        /* Restart the clock model as the sample count and start time are reset */
+
+        Timing_reset(inputDeviceSampleRate);
+
+    }
+
+    /* Time the device clock against the monotonic clock. Simulated input is paced by a thread so has no clock of its own */
+
+    int64_t monotonicTime;
+
+    int64_t utcOffset;
+
+    if (offline) {
+
+        /* Offline input runs faster than real time so the sample clock is the only time reference */
+
+        int64_t elapsed = (int64_t)frameCount * MICROSECONDS_IN_SECOND + offlineClockRemainder;
+
+        offlineClockTime += elapsed / inputDeviceSampleRate;
+
+        offlineClockRemainder = elapsed % inputDeviceSampleRate;
+
+        monotonicTime = offlineClockTime;
+
+        utcOffset = 0;
+
+    } else {
+
+        monotonicTime = Time_getMonotonicMicroseconds();
+
+        utcOffset = Time_getMicrosecondUTC() - monotonicTime;
+
+    }
+
+    if (pDevice != NULL) Timing_addObservation(frameCount, monotonicTime);
+
+    /* Detect the loopback click and time it against when it was written to the playback device */
+
+    if (Atomic_load32(&latencyMeasurementState) == LATENCY_CLICK_SENT) {
+
+        double currentTime = ma_timer_get_time_in_seconds(&timer);
+
+        for (ma_uint32 i = 0; i < frameCount; i += 1) {
+
+            if (ABS(inputBuffer[i]) > LATENCY_DETECTION_THRESHOLD) {
+
+                double detectionTime = currentTime - (double)(frameCount - i) / (double)inputDeviceSampleRate;
+
+                pthread_mutex_lock(&playbackMutex);
+
+                measuredLoopbackLatency = MILLISECONDS_IN_SECOND * MAX(0.0, detectionTime - latencyClickTime);
+
+                pthread_mutex_unlock(&playbackMutex);
+
+                printf("[BACKSTAGE] Loopback latency %.1f ms\n", MILLISECONDS_IN_SECOND * (detectionTime - latencyClickTime));
+
+                Atomic_store32(&latencyMeasurementState, LATENCY_IDLE);
+
+                break;
+
+            }
+
+        }
+
+        if (Atomic_load32(&latencyMeasurementState) == LATENCY_CLICK_SENT && currentTime - latencyClickTime > LATENCY_MEASUREMENT_TIMEOUT) {
+
+            puts("[BACKSTAGE] No loopback click detected");
+
+            Atomic_store32(&latencyMeasurementState, LATENCY_IDLE);
+
+        }
+
+    }
+
+    /* Skip analysis outside of the recording schedule */
+
+    bool suspended = Atomic_load32(&processingSuspended);
+
+    /* Resample into the audio buffer up to each block boundary so every completed block is timestamped, filtered and analysed */
+
+    int32_t inputIndex = 0;
+
+    while (true) {
+
+        int32_t numberOfSamplesToBoundary = STFT_INPUT_SAMPLES - audioBufferIndex % STFT_INPUT_SAMPLES;
+
+        int32_t numberOfInputSamplesUsed;
+
+        int32_t numberOfSamples = Resampler_processCapture(&captureResampler, inputBuffer + inputIndex, frameCount - inputIndex, numberOfSamplesToBoundary, audioBuffer + audioBufferIndex, &numberOfInputSamplesUsed);
+
+        inputIndex += numberOfInputSamplesUsed;
+
+        audioBufferIndex = (audioBufferIndex + numberOfSamples) % AUDIO_BUFFER_SIZE;
+
+        if (numberOfSamples < numberOfSamplesToBoundary) break;
+
+        int32_t startIndex = (audioBufferIndex + AUDIO_BUFFER_SIZE - STFT_INPUT_SAMPLES) % AUDIO_BUFFER_SIZE;
+
+        /* Record when the first sample of the block was captured */
+
+        int64_t blockTime;
+
+        int32_t framesBeforeLatest = frameCount - inputIndex;
+
+        if (Timing_getFrameTime(framesBeforeLatest, &blockTime) == false) blockTime = monotonicTime - (int64_t)framesBeforeLatest * MICROSECONDS_IN_SECOND / inputDeviceSampleRate;
+
+        blockTime -= (int64_t)(STFT_INPUT_SAMPLES - 1) * MICROSECONDS_IN_SECOND / currentSampleRate;
+
+        Timestamps_addBlock(startIndex, autosaveSampleCount + increment, currentSampleRate, blockTime, blockTime + utcOffset);
+
+        increment += STFT_INPUT_SAMPLES;
+
+        /* Filter the remainder of the frame before it is analysed */
+
+        Prefilter_processBlock(audioBuffer + prefilterIndex, startIndex + STFT_INPUT_SAMPLES - prefilterIndex, currentSampleRate);
+
+        prefilterIndex = audioBufferIndex;
+
+        if (suspended) {
+
+            for (int32_t k = 0; k < STFT_INPUT_SAMPLES / STFT_INPUT_OUTPUT_RATIO; k += 1) stftBuffer[startIndex / STFT_INPUT_OUTPUT_RATIO + k] = -INFINITY;
+
+        } else {
+
+            STFT_transform(audioBuffer, startIndex, stftBuffer, startIndex / STFT_INPUT_OUTPUT_RATIO);
+
+            int64_t frameStopCount = autosaveSampleCount + increment;
+
+            int32_t transitions = Trigger_processFrame(stftBuffer + startIndex / STFT_INPUT_OUTPUT_RATIO, currentSampleRate, frameStopCount, &triggerSegment);
+
+            if (transitions != TR_NONE) addTriggerEvents(transitions, &triggerSegment, audioBufferIndex);
+
+        }
+
+        /* Apply a requested sample rate change at a frame boundary */
+
+        uint32_t sampleRate = Atomic_load32(&pendingSampleRate);
+
+        if (sampleRate != 0 && restart == false && Atomic_compareExchange32(&pendingSampleRate, sampleRate, 0)) {
+
+            switchSampleRate((int32_t)sampleRate, increment, &triggerSegment);
+
+            increment = 0;
+
+            Resampler_setCaptureSampleRates(&captureResampler, inputDeviceSampleRate, currentSampleRate);
+
+        }
+
+    }
+
+    /* Filter the partial frame so the monitor only ever reads filtered samples */
+
+    Prefilter_processBlock(audioBuffer + prefilterIndex, audioBufferIndex - prefilterIndex, currentSampleRate);
+
+    prefilterIndex = audioBufferIndex;
+
+    Atomic_store32(&monitorBufferWriteIndex, (uint32_t)audioBufferIndex);
+
+    pthread_mutex_lock(&audioBufferMutex);
+
+    audioBufferWriteIndex = (audioBufferWriteIndex + increment) % AUDIO_BUFFER_SIZE;
+
+    if (restart) {
+        
+        autosaveStartTime = startTime;
+
+        audioBufferStartTime = startTime;
+
+        autosaveStartSampleCount = autosaveSampleCount;
+
+    }
+
+    audioBufferSampleCount += increment;
+
+    autosaveSampleCount += increment;
+
+    int64_t currentSampleCount = autosaveSampleCount;
+
+    pthread_mutex_unlock(&audioBufferMutex);
+
+    /* Wake the autosave thread once when the next file transition is reached */
+
+    int64_t targetCount = MIN(Atomic_load64(&autosaveTargetCount), Atomic_load64(&scheduleTransitionCount));
+
+    if (currentSampleCount >= targetCount && targetCount != signalledTargetCount) {
+
+        signalledTargetCount = targetCount;
+
+        signalAutosaveThread();
+
+    }
+
+    if (restart) {
+
+        pthread_mutex_lock(&stopStartMutex);
+
+        started = true;
+
+        pthread_mutex_unlock(&stopStartMutex);
+
+        /* Time a device restart up to the first samples from the new device */
+
+        int64_t requestTime = Atomic_load64(&deviceRestartRequestTime);
+
+        if (requestTime > 0 && offline == false) {
+
+            Atomic_store64(&deviceRestartLatency, Time_getMonotonicMicroseconds() - requestTime);
+
+            Atomic_store64(&deviceRestartRequestTime, 0);
+
+        }
+
+    }
+
+}
+
+/* Functions to check for AudioMoth */
+
+ma_bool32 enumerate_devices_callback(ma_context *pContext, ma_device_type deviceType, const ma_device_info* deviceInfo, void *pUserData) {
+
+    enumerate_devices_t *enumerateDevices = (enumerate_devices_t*)pUserData;
+
+    const char *name = deviceInfo->name;
+
+    /* A simulated hotplug renames the null capture device so the name is parsed as for a real AudioMoth */
+
+    char virtualName[DEVICE_NAME_SIZE];
+
+    if (virtualBackend && deviceType == ma_device_type_capture && Atomic_load32(&virtualAudioMothConnected)) {
+
+        snprintf(virtualName, DEVICE_NAME_SIZE, "%dkHz AudioMoth USB Microphone", Atomic_load32(&virtualAudioMothSampleRate) / HERTZ_IN_KILOHERTZ);
+
+        name = virtualName;
+
+    }
+
+    if (strstr(name, "F32x USBXpress Device")) enumerateDevices->device_check.oldAudioMothFound = true;
+
+    if (strstr(name, "AudioMoth")) {
+
+        if (strstr(name, "kHz AudioMoth") == NULL) enumerateDevices->device_check.oldAudioMothFound = true;
+
+        enumerateDevices->device_check.audioMothFound = true;
+
+        if (enumerateDevices->updateAudioMothSettings) { 
+
+            memcpy(&audioMothDeviceID, &(deviceInfo->id), sizeof(ma_device_id));
+
+            const char *digit = strstr(name, "kHz") - 1;
+
+            if (digit == NULL) {
+
+                audioMothSampleRate = MAXIMUM_SAMPLE_RATE;
+
+            } else {
+
+                int32_t multiplier = 1000;
+
+                audioMothSampleRate = 0;
+
+                do {
+
+                    audioMothSampleRate += multiplier * (*digit - '0');
+
+                    multiplier *= 10;
+
+                    digit -= 1;
+
+                } while (*digit >= '0' && *digit <= '9');
+
+            }
+
+        }
+
+        return MA_FALSE;
+
+    }
+
+    return MA_TRUE;
+
+}
+
+static device_check_t checkForAudioMoth(ma_context *context, bool updateAudioMothSettings) {
+
+    enumerate_devices_t info = {
+        .updateAudioMothSettings = updateAudioMothSettings,
+        .device_check.oldAudioMothFound = false,
+        .device_check.audioMothFound = false
+    };
+
+    ma_result result = ma_context_enumerate_devices(context, enumerate_devices_callback, (void*)&info);
+
+    if (result != MA_SUCCESS) {
+
+        device_check_t device_check = {
+            .oldAudioMothFound = false,
+            .audioMothFound = false
+        };
+
+        return device_check;
+
+    }
+
+    return info.device_check;
+    
+}
+
+/* Function to apply the latency profile to a device configuration */
+
+static void applyLatencyProfile(ma_device_config *deviceConfig, int32_t sampleRate) {
+
+    if (lowLatencyEnabled) {
+
+        deviceConfig->periodSizeInFrames = sampleRate / LOW_LATENCY_CALLBACKS_PER_SECOND;
+        deviceConfig->periods = LOW_LATENCY_NUMBER_OF_PERIODS;
+        deviceConfig->performanceProfile = ma_performance_profile_low_latency;
+
+    } else {
+
+        deviceConfig->periodSizeInFrames = sampleRate / CALLBACKS_PER_SECOND;
+
+    }
+
+}
+
+/* Thread functions to start and stop capture device */
+
+static bool startMicrophone(ma_context *context, bool usingAudioMoth) {
+
+    /* Initialise capture device */
+
+    ma_device_config captureDeviceConfig = ma_device_config_init(ma_device_type_capture);
+
+    captureDeviceConfig.capture.pDeviceID = usingAudioMoth ? &audioMothDeviceID : NULL;
+    captureDeviceConfig.capture.format = ma_format_s16;
+    captureDeviceConfig.capture.channels = 1;
+    captureDeviceConfig.capture.shareMode  = ma_share_mode_shared;
+
+    inputDeviceSampleRate = usingAudioMoth ? audioMothSampleRate : maximumDefaultSampleRate;
+
+    sprintf(inputDeviceName, usingAudioMoth ? "%dkHz AudioMoth USB Microphone" : "%dkHz Default Input", inputDeviceSampleRate / HERTZ_IN_KILOHERTZ);
+
+    sprintf(inputDeviceCommentName, usingAudioMoth ? "a %dkHz AudioMoth USB Microphone" : "the %dkHz default input", inputDeviceSampleRate / HERTZ_IN_KILOHERTZ);
+
+    inputDeviceCommentNameID = Autosave_internDeviceName(inputDeviceCommentName);
+
+    currentSampleRate = MIN(requestedSampleRate, inputDeviceSampleRate);
+
+    requestedSampleRate = currentSampleRate;
+
+    Atomic_store32(&pendingSampleRate, 0);
+
+    captureDeviceConfig.sampleRate = inputDeviceSampleRate;
+    captureDeviceConfig.dataCallback = capture_data_callback;
+    captureDeviceConfig.notificationCallback = capture_notification_callback;
+
+    applyLatencyProfile(&captureDeviceConfig, inputDeviceSampleRate);
+
+    if (exclusiveModeEnabled) captureDeviceConfig.capture.shareMode = ma_share_mode_exclusive;
+
+    ma_result result = ma_device_init(context, &captureDeviceConfig, &captureDevice);
+
+    /* Fall back to shared mode if the backend does not support exclusive mode */
+
+    if (result != MA_SUCCESS && exclusiveModeEnabled) {
+
+        puts("[BACKSTAGE] Exclusive mode not available for capture device");
+
+        captureDeviceConfig.capture.shareMode = ma_share_mode_shared;
+
+        result = ma_device_init(context, &captureDeviceConfig, &captureDevice);
+
+    }
+
+    if (result != MA_SUCCESS) return false;
+
+    /* Start the capture device */
+
+    result = ma_device_start(&captureDevice);
+
+    if (result != MA_SUCCESS) return false;
+
+    return true;
+
+}
+
+void stopMicrophone(void) {
+
+    ma_device_stop(&captureDevice);
+
+    ma_device_uninit(&captureDevice);
+        
+    memset(&captureDevice, 0, sizeof(ma_device));
+
+}
+
+/* Null playback sink for the virtual backend */
+
+static void sink_playback_data_callback(ma_device *pDevice, void *pOutput, const void *pInput, ma_uint32 frameCount) {
+
+    playback_data_callback(pDevice, pOutput, pInput, frameCount);
+
+    /* Keep the output which would have been played */
+
+    int16_t *outputBuffer = (int16_t*)pOutput;
+
+    int32_t numberOfSamples = (int32_t)frameCount * PLAYBACK_NUMBER_OF_CHANNELS;
+
+    pthread_mutex_lock(&sinkMutex);
+
+    for (int32_t i = 0; i < numberOfSamples; i += 1) {
+
+        sinkBuffer[sinkWriteIndex] = outputBuffer[i];
+
+        sinkWriteIndex = (sinkWriteIndex + 1) % SINK_BUFFER_SIZE;
+
+    }
+
+    sinkSampleCount += numberOfSamples;
+
+    pthread_mutex_unlock(&sinkMutex);
+
+}
+
+/* Static thread functions to start and stop playback device */
+
+static void *startPlaybackThreadBody(void *ptr) {
+
+    /* Initialise playback device */
+
+    ma_device_config playbackDeviceConfig = ma_device_config_init(ma_device_type_playback);
+
+    playbackDeviceConfig.playback.pDeviceID = NULL;
+    playbackDeviceConfig.playback.format = ma_format_s16;
+    playbackDeviceConfig.playback.channels = PLAYBACK_NUMBER_OF_CHANNELS;
+
+    playbackDeviceConfig.sampleRate = PLAYBACK_SAMPLE_RATE;
+    playbackDeviceConfig.dataCallback = virtualBackend ? sink_playback_data_callback : playback_data_callback;
+    playbackDeviceConfig.notificationCallback = NULL;
+
+    applyLatencyProfile(&playbackDeviceConfig, PLAYBACK_SAMPLE_RATE);
+
+    if (exclusiveModeEnabled) playbackDeviceConfig.playback.shareMode = ma_share_mode_exclusive;
+
+    ma_result result = ma_device_init(&playbackContext, &playbackDeviceConfig, &playbackDevice);
+
+    if (result != MA_SUCCESS && exclusiveModeEnabled) {
+
+        puts("[BACKSTAGE] Exclusive mode not available for playback device");
+
+        playbackDeviceConfig.playback.shareMode = ma_share_mode_shared;
+
+        result = ma_device_init(&playbackContext, &playbackDeviceConfig, &playbackDevice);
+
+    }
+
+    if (result != MA_SUCCESS) {
+        
+        puts("[BACKSTAGE] Failed to initialise playback device");
+
+        return NULL;
+
+    }
+
+    /* Start the playback device */
+
+    result = ma_device_start(&playbackDevice);
+
+    if (result != MA_SUCCESS) puts("[BACKSTAGE] Failed to start playback device");
+
+    return NULL;
+
+}
+
+static void *stopPlaybackThreadBody(void *ptr) {
+
+    ma_device_stop(&playbackDevice);
+
+    ma_device_uninit(&playbackDevice);
+        
+    memset(&playbackDevice, 0, sizeof(ma_device));
+
+    return NULL;
+    
+}
+
+static void *restartPlaybackThreadBody(void *ptr) {
+
+    stopPlaybackThreadBody(NULL);
+
+    startPlaybackThreadBody(NULL);
+
+    return NULL;
+
+}
+
+/* Function to start or stop the playback device as monitoring and review playback require */
+
+static void updatePlaybackDevice(void) {
+
+    bool required = monitorEnabled || Atomic_load32(&reviewState) != REVIEW_IDLE;
+
+    if (required && playbackDeviceRunning == false) {
+
+        pthread_create(&startPlaybackThread, NULL, startPlaybackThreadBody, NULL);
+
+        playbackDeviceRunning = true;
+
+    } else if (required == false && playbackDeviceRunning) {
+
+        pthread_create(&stopPlaybackThread, NULL, stopPlaybackThreadBody, NULL);
+
+        playbackDeviceRunning = false;
+
+    }
+
+}
+
+/* Simulation thread */
+
+static void *simulationThreadBody(void *ptr) {
+
+    int32_t counter = 0;
+
+    int32_t bufferLag = TARGET_MINIMUM_PLAYBACK_LAG;
+
+    int64_t deadline = Time_getMonotonicMicroseconds();
+
+    int64_t totalLateness = 0;
+
+    int64_t maximumLateness = 0;
+
+    bool sampleRateChangeSignalled = false;
+
+    Atomic_store32(&simulationMeanJitter, 0);
+
+    Atomic_store32(&simulationMaximumJitter, 0);
+
+    while (true) {
+
+        /* Prepare data and call audio capture function */
+
+        pthread_mutex_lock(&playbackMutex);
+
+        int32_t iterations = playbackBufferCount;
+
+        playbackBufferCount = 1;
+
+        pthread_mutex_unlock(&playbackMutex);
+
+        for (int32_t j = 0; j < iterations; j += 1) {
+
+            /* Wait for the simulation to be restarted if the next file is at a different sample rate */
+
+            int32_t sampleRate = Simulator_getSampleRate();
+
+            if (sampleRate != 0 && sampleRate != inputDeviceSampleRate) {
+
+                if (sampleRateChangeSignalled == false) Atomic_store32(&simulationSampleRateChanged, true);
+
+                sampleRateChangeSignalled = true;
+
+                break;
+
+            }
+
+            /* Reads stop at the end of each file so a change of sample rate always falls between callbacks */
+
+            int32_t frameCount = Simulator_read(simulationBuffer, inputDeviceSampleRate / CALLBACKS_PER_SECOND);
+
+            if (frameCount > 0) capture_data_callback(NULL, NULL, (void*)simulationBuffer, frameCount);
+
+        }
+
+        /* Check flag */
+
+        pthread_mutex_lock(&simulationRunningMutex);
+
+        bool running = simulationRunning;
+
+        pthread_mutex_unlock(&simulationRunningMutex);
+
+        if (running == false) break;
+
+        /* Check the minimum buffer lag */
+
+        counter += 1;
+
+        if (counter == CALLBACKS_PER_SECOND) {
+
+            pthread_mutex_lock(&playbackMutex);
+
+            bufferLag = minimumPlaybackBufferLag;
+
+            minimumPlaybackBufferLag = INT32_MAX;
+
+            pthread_mutex_unlock(&playbackMutex);
+
+            /* Publish the wakeup jitter statistics */
+
+            Atomic_store32(&simulationMeanJitter, (uint32_t)(totalLateness / CALLBACKS_PER_SECOND));
+
+            Atomic_store32(&simulationMaximumJitter, (uint32_t)maximumLateness);
+
+            totalLateness = 0;
+
+            maximumLateness = 0;
+
+            counter = 0;
+
+        }
+
+        /* Calculate period to wait for next update */
+
+        int64_t interval;
+
+        if (bufferLag < MAXIMUM_PLAYBACK_LAG) {
+
+            interval = MICROSECONDS_IN_SECOND / (CALLBACKS_PER_SECOND + TARGET_MINIMUM_PLAYBACK_LAG - bufferLag);
+
+        } else {
+
+            interval = MICROSECONDS_IN_SECOND / CALLBACKS_PER_SECOND;
+
+        }
+
+        /* Sleep until an absolute deadline so time spent in the callback and late wakeups do not accumulate */
+
+        deadline += interval;
+
+        int64_t now = Time_getMonotonicMicroseconds();
+
+        if (now - deadline > SIMULATION_MAXIMUM_LATENESS) deadline = now;
+
+        Time_sleepUntilMonotonicMicroseconds(deadline);
+
+        int64_t lateness = MAX(0, Time_getMonotonicMicroseconds() - deadline);
+
+        totalLateness += lateness;
+
+        maximumLateness = MAX(maximumLateness, lateness);
+
+    }
+
+    pthread_mutex_lock(&stopStartMutex);
+
+    stopped = true;
+
+    pthread_mutex_unlock(&stopStartMutex);
+
+    return NULL;
+    
+}
+
+/* Offline processing thread */
+
+static bool isSimulationRunning(void) {
+
+    pthread_mutex_lock(&simulationRunningMutex);
+
+    bool running = simulationRunning;
+
+    pthread_mutex_unlock(&simulationRunningMutex);
+
+    return running;
+
+}
+
+static void *offlineThreadBody(void *ptr) {
+
+    int32_t counter = 0;
+
+    int64_t startTime = Time_getMonotonicMicroseconds();
+
+    int64_t numberOfSamples = 0;
+
+    double duration = 0.0;
+
+    bool waiting = false;
+
+    while (isSimulationRunning()) {
+
+        /* Wait to be restarted if the next file is at a different sample rate, or to be stopped at the end of the playlist */
+
+        if (waiting) {
+
+            usleep(OFFLINE_WAIT_INTERVAL);
+
+            continue;
+
+        }
+
+        int32_t sampleRate = Simulator_getSampleRate();
+
+        if (sampleRate != 0 && sampleRate != inputDeviceSampleRate) {
+
+            Atomic_store32(&simulationSampleRateChanged, true);
+
+            waiting = true;
+
+            continue;
+
+        }
+
+        int32_t frameCount = Simulator_read(simulationBuffer, inputDeviceSampleRate / CALLBACKS_PER_SECOND);
+
+        if (frameCount == 0) {
+
+            if (Simulator_isFinished()) Atomic_store32(&offlineFinished, true);
+
+            waiting = true;
+
+            continue;
+
+        }
+
+        capture_data_callback(NULL, NULL, (void*)simulationBuffer, frameCount);
+
+        numberOfSamples += frameCount;
+
+        duration += (double)frameCount / (double)inputDeviceSampleRate;
+
+        Atomic_store64(&offlineSamplesProcessed, Atomic_load64(&offlineSamplesProcessed) + frameCount);
+
+        /* Hold back until the autosave thread has caught up so no samples are overwritten before they are written */
+
+        signalAutosaveThread();
+
+        pthread_mutex_lock(&audioBufferMutex);
+
+        int64_t currentSampleCount = autosaveSampleCount;
+
+        pthread_mutex_unlock(&audioBufferMutex);
+
+        int64_t maximumBacklog = (int64_t)OFFLINE_MAXIMUM_BACKLOG * currentSampleRate / CALLBACKS_PER_SECOND;
+
+        while (currentSampleCount - Atomic_load64(&autosaveProcessedCount) > maximumBacklog && isSimulationRunning()) usleep(OFFLINE_WAIT_INTERVAL);
+
+        /* Publish the throughput */
+
+        counter += 1;
+
+        if (counter == CALLBACKS_PER_SECOND) {
+
+            int64_t elapsed = MAX(1, Time_getMonotonicMicroseconds() - startTime);
+
+            Atomic_store32(&offlineThroughput, (uint32_t)MIN(UINT32_MAX, numberOfSamples * MICROSECONDS_IN_SECOND / elapsed));
+
+            counter = 0;
+
+        }
+
+    }
+
+    double elapsed = (double)MAX(1, Time_getMonotonicMicroseconds() - startTime) / MICROSECONDS_IN_SECOND;
+
+    printf("[BACKSTAGE] Offline processing of %lld samples at %.0f samples per second, %.1f times real time\n", (long long)numberOfSamples, (double)numberOfSamples / elapsed, duration / elapsed);
+
+    pthread_mutex_lock(&stopStartMutex);
+
+    stopped = true;
+
+    pthread_mutex_unlock(&stopStartMutex);
+
+    return NULL;
+
+}
+
+/* Static capture functions */
+
+static void captureAudioBuffer(int32_t duration) {
+
+    /* Read local time offset */
+
+    captureBufferLocalTimeOffset = Atomic_load32(&useLocalTime) ? Time_getLocalTimeOffset() : 0;
+
+    /* Capture current parameters */
+
+    pthread_mutex_lock(&audioBufferMutex);
+
+    captureBufferWriteIndex = audioBufferWriteIndex;
+
+    captureBufferSampleCount = audioBufferSampleCount;
+
+    captureBufferStartTime = audioBufferStartTime + captureBufferLocalTimeOffset * MILLISECONDS_IN_SECOND;
+
+    captureBufferSampleRate = currentSampleRate;
+    
+    pthread_mutex_unlock(&audioBufferMutex);   
+
+    strncpy(captureBufferDeviceCommentName, inputDeviceCommentName, DEVICE_NAME_SIZE);
+
+    /* Calculate the capture duration and the start time */
+
+    int64_t requestedDurationInSamples = duration * captureBufferSampleRate;
+
+    int64_t capturedDurationInSamples = MIN(requestedDurationInSamples, captureBufferSampleCount);
+
+    captureBufferStartTime += Timing_samplesToMilliseconds(captureBufferSampleCount, captureBufferSampleRate);
+
+    captureBufferStartTime -= Timing_samplesToMilliseconds(capturedDurationInSamples, captureBufferSampleRate);
+
+    /* Prefer the time recorded when the first captured sample arrived */
+
+    int64_t utcTime;
+
+    int32_t captureStartIndex = (int32_t)((AUDIO_BUFFER_SIZE + captureBufferWriteIndex - capturedDurationInSamples) % AUDIO_BUFFER_SIZE);
+
+    if (capturedDurationInSamples > 0 && Timestamps_getTimeOfIndex(captureStartIndex, &utcTime)) captureBufferStartTime = ROUNDED_DIV(utcTime, MICROSECONDS_IN_MILLISECOND) + captureBufferLocalTimeOffset * MILLISECONDS_IN_SECOND;
+
+    captureBufferLength = (int32_t)capturedDurationInSamples;
+
+    /* Copy the data into the capture buffer */
+
+    int32_t offset = captureBufferLength - captureBufferWriteIndex;
+
+    if (offset < 0) {
+
+        memcpy(captureBuffer, audioBuffer - offset, captureBufferLength * NUMBER_OF_BYTES_IN_SAMPLE);
+
+    } else {
+
+        int32_t remainder = captureBufferLength - offset;
+
+        memcpy(captureBuffer, audioBuffer + AUDIO_BUFFER_SIZE - offset, offset * NUMBER_OF_BYTES_IN_SAMPLE);
+
+        memcpy(captureBuffer + offset, audioBuffer, remainder * NUMBER_OF_BYTES_IN_SAMPLE);
+
+    }
+
+}
+
+static void *captureBufferThreadBody(void *ptr) {
+
+    static WAV_header_t captureHeader;
+
+    static char captureFilename[FILENAME_SIZE];
+
+    static char captureBufferFileDestination[FILEPATH_SIZE];
+
+    int32_t time = captureBufferStartTime / MILLISECONDS_IN_SECOND;
+
+    int32_t milliseconds = captureBufferStartTime % MILLISECONDS_IN_SECOND;
+
+    /* Get the file destination */
+
+    pthread_mutex_lock(&fileDestinationMutex);
+
+    bool destinationSet = fileDestinationSet;
+
+    memcpy(captureBufferFileDestination, fileDestination, FILEPATH_SIZE);
+
+    pthread_mutex_unlock(&fileDestinationMutex);
+
+    /* Write the output WAV file */
+
+    captureBufferSuccess = false;
+
+    if (captureBufferLength > 0 && destinationSet == true) {
+
+        WavFile_initialiseHeader(&captureHeader);
+
+        WavFile_setHeaderDetails(&captureHeader, captureBufferSampleRate, captureBufferLength);
+
+        WavFile_setHeaderComment(&captureHeader, time, milliseconds, captureBufferLocalTimeOffset, captureBufferDeviceCommentName);
+
+        WavFile_setFilename(captureFilename, time, milliseconds, captureBufferFileDestination);
+
+        captureBufferSuccess = WavFile_writeFile(&captureHeader, captureFilename, captureBuffer, captureBufferLength, NULL, 0);
+
+    }
+
+    /* Report the result */
+
+    if (captureBufferCallback != NULL) captureBufferCallback(captureBufferSuccess);
+
+    return NULL;
+
+}
+
+/* Background and autosave functions */
+
+/* Private function */
+
+static void formatFileTime(char *buffer, time_t start, time_t stop, int32_t timeOffset) {
+
+    struct tm time;
+
+    time_t rawTime = start + timeOffset;
+
+    Time_gmTime(&rawTime, &time);
+
+    buffer += sprintf(buffer, "%02d:%02d:%02d to ", time.tm_hour, time.tm_min, time.tm_sec);
+
+    rawTime = stop + timeOffset;
+
+    Time_gmTime(&rawTime, &time);
+
+    buffer += sprintf(buffer, "%02d:%02d:%02d (UTC", time.tm_hour, time.tm_min, time.tm_sec);
+
+    int32_t timeOffsetMinutes = timeOffset / SECONDS_IN_MINUTE;
+
+    int32_t timezoneHours = timeOffsetMinutes / MINUTES_IN_HOUR;
+
+    int32_t timezoneMinutes = timeOffsetMinutes % MINUTES_IN_HOUR;
+
+    if (timezoneHours < 0) {
+
+        buffer += sprintf(buffer, "%d", timezoneHours);
+
+    } else if (timezoneHours > 0) {
+
+        buffer += sprintf(buffer, "+%d", timezoneHours);
+
+    } else {
+
+        if (timezoneMinutes < 0) buffer += sprintf(buffer, "-0");
+
+        if (timezoneMinutes > 0) buffer += sprintf(buffer, "+0");
+
+    }
+
+    if (timezoneMinutes < 0) buffer += sprintf(buffer, ":%02d", -timezoneMinutes);
+
+    if (timezoneMinutes > 0) buffer += sprintf(buffer, ":%02d", timezoneMinutes);
+
+    sprintf(buffer, ")");
+
+}
+
+static bool writeAutosaveFileSection(time_t startTime, int32_t startIndex, int32_t duration) {
+
+    bool success = false;
+
+    static WAV_header_t autosaveHeader;
+
+    static int32_t previousLocalTimeOffset = 0;
+
+    static int32_t autosavePreviousDuration = 0;
+
+    static char autosaveFilename[FILENAME_SIZE];
+
+    static time_t autosaveFilePreviousStopTime = 0;
+
+    static char autosaveFileDestination[FILEPATH_SIZE];
+    
+    static char autosavePreviousFileDestination[FILEPATH_SIZE];
+
+    /* Get the file destination */
+
+    pthread_mutex_lock(&fileDestinationMutex);
+
+    bool destinationSet = fileDestinationSet;
+
+    memcpy(autosaveFileDestination, fileDestination, FILEPATH_SIZE);
+
+    pthread_mutex_unlock(&fileDestinationMutex);
+
+    if (destinationSet == false) return false;
+
+    /* Read local time offset */
+
+    int32_t localTimeOffset = Atomic_load32(&useLocalTime) ? Time_getLocalTimeOffset() : 0;
+
+    /* Get current autosave duration */
+
+    pthread_mutex_lock(&autosaveMutex);
+
+    if (autosaveDuration > 0) autosavePreviousDuration = autosaveDuration;
+
+    pthread_mutex_unlock(&autosaveMutex);
+
+    /* Determine whether file should be appended */
+
+    struct tm timeStart;
+
+    time_t rawTimeStart = startTime;
+
+    Time_gmTime(&rawTimeStart, &timeStart);
+    
+    bool append = localTimeOffset == previousLocalTimeOffset;
+
+    append &= strcmp(autosaveFileDestination, autosavePreviousFileDestination) == 0;
+    
+    append &= startTime == autosaveFilePreviousStopTime;
+
+    append &= timeStart.tm_sec == 0 && timeStart.tm_min % autosavePreviousDuration > 0;
+
+    memcpy(autosavePreviousFileDestination, autosaveFileDestination, FILEPATH_SIZE);
+
+    autosaveFilePreviousStopTime = startTime + duration;
+
+    previousLocalTimeOffset = localTimeOffset;
+
+    /* Write the output WAV file */
+
+    int32_t numberOfSamples = duration * autosaveFileSampleRate;
+
+    int32_t overlap = startIndex + numberOfSamples - AUDIO_BUFFER_SIZE;
+
+    if (append == true) {
+
+        if (overlap < 0) {
+
+            success = WavFile_appendFile(autosaveFilename, audioBuffer + startIndex, numberOfSamples, NULL, 0);
+
+        } else {
+
+            success = WavFile_appendFile(autosaveFilename, audioBuffer + startIndex, numberOfSamples - overlap, audioBuffer, overlap);
+
+        }
+
+    }
+
+    if (append == false || success == false) {
+
+        WavFile_initialiseHeader(&autosaveHeader);
+
+        WavFile_setHeaderDetails(&autosaveHeader, autosaveFileSampleRate, numberOfSamples);
+
+        WavFile_setHeaderComment(&autosaveHeader, (int32_t)startTime + localTimeOffset, -1, localTimeOffset, autosaveInputDeviceCommentName);
+
+        WavFile_setFilename(autosaveFilename, (int32_t)startTime + localTimeOffset, -1, autosaveFileDestination);
+
+        if (overlap < 0) {
+
+            success = WavFile_writeFile(&autosaveHeader, autosaveFilename, audioBuffer + startIndex, numberOfSamples, NULL, 0);
+
+        } else {
+
+            success = WavFile_writeFile(&autosaveHeader, autosaveFilename, audioBuffer + startIndex, numberOfSamples - overlap, audioBuffer, overlap);
+
+        }
+
+    }
+
+    /* Log output file */
+
+    static char buffer[FILE_TIME_BUFFER];
+
+    formatFileTime(buffer, startTime, autosaveFilePreviousStopTime, localTimeOffset);
+
+    printf("[AUTOSAVE] %s\n", buffer);
+
+    /* Return status */
+
+    return success;
+
+}
+
+static bool writeAutosaveFile(int32_t duration) {
+
+    bool success = true;
+
+    if (duration == 0 || autosaveFileTriggered) return true;
+
+    /* Read local time offset */
+
+    int32_t localTimeOffset = Atomic_load32(&useLocalTime) ? Time_getLocalTimeOffset() : 0;
+
+    /* Write only the sections which fall inside the recording schedule */
+
+    int32_t offset = 0;
+
+    while (offset < duration) {
+
+        time_t startTime = autosaveFileStartTime + offset;
+
+        int64_t secondsUntilTransition = Schedule_getSecondsUntilTransition(startTime + localTimeOffset);
+
+        int32_t sectionDuration = (int32_t)MIN(duration - offset, secondsUntilTransition);
+
+        if (Schedule_isActive(startTime + localTimeOffset)) {
+
+            int32_t startIndex = (int32_t)(((int64_t)autosaveFileStartIndex + (int64_t)offset * autosaveFileSampleRate) % AUDIO_BUFFER_SIZE);
+
+            success &= writeAutosaveFileSection(startTime, startIndex, sectionDuration);
+
+        }
+
+        offset += sectionDuration;
+
+    }
+
+    return success;
+
+}
+
+static bool makeMinuteTransitionRecording() {
+
+    /* Generate partial recording */
+
+    int64_t sampleCountDifference = autosaveTargetCount - autosaveFileStartCount;
+
+    int32_t duration = (int32_t)(sampleCountDifference / autosaveFileSampleRate);
+
+    bool success = writeAutosaveFile(duration);
+
+    /* Update for next minute transition */
+
+    autosaveFileStartTime += duration;
+
+    autosaveFileStartIndex = (autosaveFileStartIndex + sampleCountDifference) % AUDIO_BUFFER_SIZE;
+
+    autosaveFileStartCount = autosaveTargetCount;
+
+    Atomic_store64(&autosaveTargetCount, autosaveFileStartCount + SECONDS_IN_MINUTE * autosaveFileSampleRate);
+
+    return success;
+
+}
+
+static void updateForMillisecondOffset(int32_t milliseconds) {
+
+    /* Update count, index and time for millisecond offset */
+
+    if (milliseconds > 0) {
+        
+        int32_t millisecondOffset = MILLISECONDS_IN_SECOND - milliseconds;
+
+        int32_t sampleOffset = ROUNDED_DIV(autosaveFileSampleRate * millisecondOffset, MILLISECONDS_IN_SECOND);
+
+        autosaveFileStartCount += sampleOffset;
+
+        autosaveFileStartIndex = (autosaveFileStartIndex + sampleOffset) % AUDIO_BUFFER_SIZE;
+
+        autosaveFileStartTime += 1;
+
+    }
+
+    /* Calculate target sample count for the next minute transition */
+
+    struct tm time;
+
+    time_t rawTime = autosaveFileStartTime;
+
+    Time_gmTime(&rawTime, &time);
+
+    Atomic_store64(&autosaveTargetCount, autosaveFileStartCount + (SECONDS_IN_MINUTE - time.tm_sec) * autosaveFileSampleRate);
+
+}
+
+static bool isScheduleActive(int64_t time) {
+
+    int32_t localTimeOffset = Atomic_load32(&useLocalTime) ? Time_getLocalTimeOffset() : 0;
+
+    return Schedule_isActive(time / MILLISECONDS_IN_SECOND + localTimeOffset);
+
+}
+
+static bool writeAutosaveSegment(int32_t startIndex, int64_t startTime, int32_t sampleRate, char *deviceCommentName, int32_t numberOfSamples) {
+
+    bool success = false;
+
+    static WAV_header_t autosaveSegmentHeader;
+
+    static char autosaveSegmentFilename[FILENAME_SIZE];
+
+    static char autosaveSegmentFileDestination[FILEPATH_SIZE];
+
+    if (numberOfSamples <= 0 || isScheduleActive(startTime) == false) return true;
+
+    /* Samples older than the buffer have already been overwritten */
+
+    if (numberOfSamples > AUDIO_BUFFER_SIZE) return false;
+
+    /* Get the file destination */
+
+    pthread_mutex_lock(&fileDestinationMutex);
+
+    bool destinationSet = fileDestinationSet;
+
+    memcpy(autosaveSegmentFileDestination, fileDestination, FILEPATH_SIZE);
+
+    pthread_mutex_unlock(&fileDestinationMutex);
+
+    if (destinationSet == false) return false;
+
+    /* Read local time offset */
+
+    int32_t localTimeOffset = Atomic_load32(&useLocalTime) ? Time_getLocalTimeOffset() : 0;
+
+    int32_t time = (int32_t)(startTime / MILLISECONDS_IN_SECOND) + localTimeOffset;
+
+    int32_t milliseconds = startTime % MILLISECONDS_IN_SECOND;
+
+    /* Write the output WAV file */
+
+    int32_t overlap = startIndex + numberOfSamples - AUDIO_BUFFER_SIZE;
+
+    WavFile_initialiseHeader(&autosaveSegmentHeader);
+
+    WavFile_setHeaderDetails(&autosaveSegmentHeader, sampleRate, numberOfSamples);
+
+    WavFile_setHeaderComment(&autosaveSegmentHeader, time, milliseconds, localTimeOffset, deviceCommentName);
+
+    WavFile_setFilename(autosaveSegmentFilename, time, milliseconds, autosaveSegmentFileDestination);
+
+    if (overlap < 0) {
+
+        success = WavFile_writeFile(&autosaveSegmentHeader, autosaveSegmentFilename, audioBuffer + startIndex, numberOfSamples, NULL, 0);
+
+    } else {
+
+        success = WavFile_writeFile(&autosaveSegmentHeader, autosaveSegmentFilename, audioBuffer + startIndex, numberOfSamples - overlap, audioBuffer, overlap);
+
+    }
+
+    /* Log output file */
+
+    printf("[AUTOSAVE] %d samples from %s\n", numberOfSamples, autosaveSegmentFilename);
+
+    /* Return status */
+
+    return success;
+
+}
+
+static bool writeContinuousSegment(int32_t numberOfSamples) {
+
+    /* Only triggered segments are written when the trigger is enabled */
+
+    if (autosaveFileTriggered) return true;
+
+    /* Calculate the start time of the segment from the sample clock */
+
+    int64_t countDifference = autosaveFileStartCount - autosaveFileReferenceCount;
+
+    int64_t startTime = autosaveFileReferenceTime + Timing_samplesToMilliseconds(countDifference, autosaveFileSampleRate);
+
+    int64_t utcTime;
+
+    if (Timestamps_getTimeOfCount(autosaveFileStartCount, &utcTime)) startTime = ROUNDED_DIV(utcTime, MICROSECONDS_IN_MILLISECOND);
+
+    return writeAutosaveSegment(autosaveFileStartIndex, startTime, autosaveFileSampleRate, autosaveInputDeviceCommentName, numberOfSamples);
+
+}
+
+static bool writeTriggeredSegment(AS_event_t *startEvent, int64_t stopCount, int32_t stopIndex) {
+
+    int32_t numberOfSamples = (int32_t)(stopCount - startEvent->triggerStartCount);
+
+    int32_t startIndex = (AUDIO_BUFFER_SIZE + stopIndex - numberOfSamples) % AUDIO_BUFFER_SIZE;
+
+    int64_t countDifference = startEvent->triggerStartCount - startEvent->startCount;
+
+    int64_t startTime = startEvent->startTime + Timing_samplesToMilliseconds(countDifference, startEvent->sampleRate);
+
+    int64_t utcTime;
+
+    if (Timestamps_getTimeOfCount(startEvent->triggerStartCount, &utcTime)) startTime = ROUNDED_DIV(utcTime, MICROSECONDS_IN_MILLISECOND);
+
+    puts("[AUTOSAVE] Triggered segment");
+
+    return writeAutosaveSegment(startIndex, startTime, startEvent->sampleRate, autosaveTriggerDeviceCommentName, numberOfSamples);
+
+}
+
+static bool makeSegmentTransitionRecording() {
+
+    /* Generate complete segment */
+
+    bool success = writeContinuousSegment(autosaveFileSegmentLength);
+
+    /* Update for next segment transition */
+
+    autosaveFileStartIndex = (autosaveFileStartIndex + autosaveFileSegmentLength) % AUDIO_BUFFER_SIZE;
+
+    autosaveFileStartCount += autosaveFileSegmentLength;
+
+    Atomic_store64(&autosaveTargetCount, autosaveFileStartCount + autosaveFileSegmentLength);
+
+    return success;
+
+}
+
+static bool makeTransitionRecording() {
+
+    return autosaveFileSegmentLength > 0 ? makeSegmentTransitionRecording() : makeMinuteTransitionRecording();
+
+}
+
+static bool writeAutosaveFileUntil(int64_t sampleCount) {
+
+    /* Write samples since the start of the current file */
+
+    if (autosaveFileSegmentLength > 0) return writeContinuousSegment((int32_t)(sampleCount - autosaveFileStartCount));
+
+    int32_t duration = (int32_t)(sampleCount - autosaveFileStartCount) / autosaveFileSampleRate;
+
+    return writeAutosaveFile(duration);
+
+}
+
+static void updateSchedule(int64_t currentSampleCount) {
+
+    static bool previousActive = true;
+
+    bool active = true;
+
+    int64_t transitionCount = INT64_MAX;
+
+    if (autosaveWaitingForStartEvent == false && Schedule_isEnabled()) {
+
+        /* Calculate the current time from the sample clock */
+
+        int32_t localTimeOffset = Atomic_load32(&useLocalTime) ? Time_getLocalTimeOffset() : 0;
+
+        int64_t countDifference = currentSampleCount - autosaveFileReferenceCount;
+
+        int64_t currentTime = autosaveFileReferenceTime + Timing_samplesToMilliseconds(countDifference, autosaveFileSampleRate);
+
+        int64_t time = currentTime / MILLISECONDS_IN_SECOND + localTimeOffset;
+
+        active = Schedule_isActive(time);
+
+        if (active != previousActive) puts(active ? "[AUTOSAVE] Schedule active" : "[AUTOSAVE] Schedule inactive");
+
+        /* Convert the next transition to a sample count so the capture path can wake this thread */
+
+        int64_t secondsUntilTransition = Schedule_getSecondsUntilTransition(time);
+
+        if (secondsUntilTransition < INT64_MAX) {
+
+            int64_t millisecondsUntilTransition = secondsUntilTransition * MILLISECONDS_IN_SECOND - currentTime % MILLISECONDS_IN_SECOND;
+
+            transitionCount = currentSampleCount + ROUNDED_DIV(millisecondsUntilTransition * autosaveFileSampleRate, MILLISECONDS_IN_SECOND);
+
+        }
+
+    }
+
+    previousActive = active;
+
+    pthread_mutex_lock(&autosaveMutex);
+
+    bool suspend = scheduleSuspendsProcessing && active == false;
+
+    pthread_mutex_unlock(&autosaveMutex);
+
+    Atomic_store32(&processingSuspended, suspend);
+
+    Atomic_store64(&scheduleTransitionCount, transitionCount);
+
+}
+
+static void *backgroundThreadBody(void *ptr) {
+
+    puts("[BACKGROUND] Started");
+    
+    while (true) {
+
+        /* Check for AudioMoth */
+
+        pthread_mutex_lock(&backgroundDeviceCheckMutex);
+
+        device_check_t device_check = checkForAudioMoth(&deviceCheckContext, false);
+
+        bool audioMothFound = device_check.audioMothFound;
+
+        bool oldAudioMothFound = device_check.oldAudioMothFound;
+
+        pthread_mutex_unlock(&backgroundDeviceCheckMutex);
+
+        pthread_mutex_lock(&backgroundMutex);
+
+        if (backgroundDeviceCheckFoundAudioMoth != audioMothFound) puts(audioMothFound ? "[BACKGROUND] AudioMoth connected" : "[BACKGROUND] AudioMoth disconnected");
+
+        backgroundDeviceCheckTime = ma_timer_get_time_in_seconds(&timer);
+
+        backgroundDeviceCheckFoundAudioMoth = audioMothFound;
+
+        backgroundDeviceCheckFoundOldAudioMoth = oldAudioMothFound;
+
+        pthread_mutex_unlock(&backgroundMutex);
+
+        /* Calculate delay period to wait for next update */
+
+        uint32_t microseconds = Time_getMicroseconds();
+
+        uint32_t delay = DEVICE_CHECK_INTERVAL - microseconds % DEVICE_CHECK_INTERVAL;
+
+        usleep(delay);
+
+    }
+
+    return NULL;
+
+}
+
+static void *autosaveThreadBody(void *ptr) {
+
+    static AS_event_t event;
+
+    puts("[AUTOSAVE] Started");
+    
+    while (true) {
+
+        /* Sleep until an event is added or the capture path reaches the target count */
+
+        pthread_mutex_lock(&autosaveWakeMutex);
+
+        while (autosaveWakePending == false) pthread_cond_wait(&autosaveWakeCondition, &autosaveWakeMutex);
+
+        autosaveWakePending = false;
+
+        pthread_mutex_unlock(&autosaveWakeMutex);
+
+        /* Get current sample count and autosave duration */
+
+        pthread_mutex_lock(&audioBufferMutex);
+
+        int64_t currentSampleCount = autosaveSampleCount;
+
+        pthread_mutex_unlock(&audioBufferMutex);
+
+        /* Process autosave events */
+
+        bool success = true;
+
+        while (Autosave_hasEvents()) {
+
+            /* Copy and remove first event */
+
+            Autosave_getFirstEvent(&event);
+
+            /* Process event */
+
+            if (autosaveWaitingForStartEvent && event.type == AS_START) {
+
+                puts("[AUTOSAVE] Start");
+
+                /* Set sample rate and device */
+
+                autosaveFileSampleRate = event.sampleRate;
+
+                Autosave_getDeviceName(event.deviceNameID, autosaveInputDeviceCommentName);
+
+                /* Read the segment length and trigger mode for this run */
+
+                pthread_mutex_lock(&autosaveMutex);
+
+                autosaveFileSegmentLength = autosaveSegmentLength;
+
+                pthread_mutex_unlock(&autosaveMutex);
+
+                autosaveFileTriggered = Trigger_isEnabled();
+
+                /* Adjust start time to match current count and index */
+
+                int64_t countDifference = event.currentCount - event.startCount;
+
+                int64_t updatedStartTime = event.startTime + Timing_samplesToMilliseconds(countDifference, autosaveFileSampleRate);
+
+                int32_t milliseconds = updatedStartTime % MILLISECONDS_IN_SECOND;
+
+                autosaveFileStartTime = updatedStartTime / MILLISECONDS_IN_SECOND;
+
+                autosaveFileStartCount = event.currentCount;
+
+                autosaveFileStartIndex = event.currentIndex;
+
+                autosaveFileReferenceTime = event.startTime;
+
+                autosaveFileReferenceCount = event.startCount;
+
+                /* Segments start immediately, otherwise update start time, count and index for millisecond offset */
+
+                if (autosaveFileSegmentLength > 0) {
+
+                    Atomic_store64(&autosaveTargetCount, autosaveFileStartCount + autosaveFileSegmentLength);
+
+                } else {
+
+                    updateForMillisecondOffset(milliseconds); 
+
+                }
+
+                /* Reset flag */
+                
+                autosaveWaitingForStartEvent = false;
+
+            }
+
+            /* Catch up on every transition passed before the event, stopping if one fails */
+
+            while (currentSampleCount >= autosaveTargetCount && autosaveTargetCount < event.currentCount) {
+
+                bool transitionSuccess = makeTransitionRecording();
+
+                success &= transitionSuccess;
+
+                if (transitionSuccess == false) break;
+
+            }
+
+            if (event.type == AS_RESTART && autosaveWaitingForStartEvent == false) {
+
+                /* Write samples since last start to file */
+
+                success &= writeAutosaveFileUntil(event.startCount);
+
+                /* Set sample rate and device */
+
+                autosaveFileSampleRate = event.sampleRate;
+
+                Autosave_getDeviceName(event.deviceNameID, autosaveInputDeviceCommentName);
+
+                /* Adjust current index to match start time and count */
+
+                int32_t milliseconds = event.startTime % MILLISECONDS_IN_SECOND;
+
+                autosaveFileStartTime = event.startTime / MILLISECONDS_IN_SECOND;
+
+                autosaveFileStartCount = event.startCount;
+
+                int64_t countDifference = (event.currentCount - event.startCount);
+
+                autosaveFileStartIndex = (AUDIO_BUFFER_SIZE + event.currentIndex - countDifference) % AUDIO_BUFFER_SIZE;
+
+                autosaveFileReferenceTime = event.startTime;
+
+                autosaveFileReferenceCount = event.startCount;
+
+                /* Segments restart immediately, otherwise update start time, count and index for millisecond offset */
+
+                if (autosaveFileSegmentLength > 0) {
+
+                    Atomic_store64(&autosaveTargetCount, autosaveFileStartCount + autosaveFileSegmentLength);
+
+                } else {
+
+                    updateForMillisecondOffset(milliseconds);
+
+                }
+
+            }
+
+            if (event.type == AS_TRIGGER_START && autosaveWaitingForStartEvent == false && autosaveFileTriggered) {
+
+                memcpy(&autosaveTriggerStartEvent, &event, sizeof(AS_event_t));
+
+                /* Resolve the device name now as the segment may stay open while other devices come and go */
+
+                Autosave_getDeviceName(event.deviceNameID, autosaveTriggerDeviceCommentName);
+
+                autosaveTriggerOpen = true;
+
+            }
+
+            if (event.type == AS_TRIGGER_STOP && autosaveTriggerOpen) {
+
+                success &= writeTriggeredSegment(&autosaveTriggerStartEvent, event.currentCount, event.currentIndex);
+
+                autosaveTriggerOpen = false;
+
+            }
+
+            if ((event.type == AS_STOP || event.type == AS_SHUTDOWN) && autosaveTriggerOpen) {
+
+                /* Write the open triggered segment up to the current sample */
+
+                success &= writeTriggeredSegment(&autosaveTriggerStartEvent, event.currentCount, event.currentIndex);
+
+                autosaveTriggerOpen = false;
+
+            }
+
+            if (event.type == AS_STOP) {
+
+                puts("[AUTOSAVE] Stop");
+
+                /* Write samples since last start to file */
+
+                success &= writeAutosaveFileUntil(event.currentCount);
+
+                /* Reset flags */
+
+                autosaveWaitingForStartEvent = true;
+
+                Atomic_store64(&autosaveTargetCount, INT64_MAX);
+
+            }
+
+            if (event.type == AS_SHUTDOWN) {
+
+                puts("[AUTOSAVE] Shutdown starting");
+
+                if (autosaveWaitingForStartEvent == false) {
+
+                    /* Write samples since last start to file */
+
+                    writeAutosaveFileUntil(event.currentCount);
+
+                }
+
+                pthread_mutex_lock(&autosaveMutex);
+
+                autosaveShutdownCompleted = true;
+
+                pthread_mutex_unlock(&autosaveMutex);
+
+                /* Reset flags */
+
+                autosaveWaitingForStartEvent = true;
+
+                Atomic_store64(&autosaveTargetCount, INT64_MAX);
+
+            }
+
+        }
+
+        while (currentSampleCount >= autosaveTargetCount) {
+
+            bool transitionSuccess = makeTransitionRecording();
+
+            success &= transitionSuccess;
+
+            if (transitionSuccess == false) break;
+
+        }
+
+        /* Update the schedule state and next transition */
+
+        updateSchedule(currentSampleCount);
+
+        Atomic_store64(&autosaveProcessedCount, currentSampleCount);
+
+        /* Report the failure */
+
+        if (success == false) {
+
+            puts("[AUTOSAVE] Could not write WAV file");
+
+            if (autosaveErrorCallback != NULL) autosaveErrorCallback();
+
+        }
+
+        /* Report events dropped from the full queue as they may have left files missing or incomplete */
+
+        if (Atomic_compareExchange32(&autosaveEventDropped, true, false)) {
+
+            puts("[AUTOSAVE] Events were dropped from the full queue");
+
+            if (autosaveErrorCallback != NULL) autosaveErrorCallback();
+
+        }
+
+    }
+
+    return NULL;
+
+}
+
+/* Simulation configuration. Offline processing plays the playlist once from the given start time, or from now */
+
+static void configureSimulation(bool offline, double startTime) {
+
+    Simulator_setLooping(offline == false);
+
+    simulationOffline = offline;
+
+    offlineRequested = offline;
+
+    offlineRequestedStartTime = startTime > 0.0 ? (int64_t)startTime : Time_getMillisecondUTC();
+
+    if (offline) printf("[BACKSTAGE] Offline processing from %lld\n", (long long)offlineRequestedStartTime);
+
+}
+
+/* Schedule configuration */
+
+static void setScheduleSuspendsProcessing(bool suspend) {
+
+    pthread_mutex_lock(&autosaveMutex);
+
+    scheduleSuspendsProcessing = suspend;
+
+    pthread_mutex_unlock(&autosaveMutex);
+
+    /* Wake the autosave thread to evaluate the new schedule */
+
+    signalAutosaveThread();
+
+}
+
+/* Public functions */
+
+bool Engine_initialise(int16_t *audio, float *stft, int32_t backend) {
+
+    bool success = true;
+
+    puts(backend == BACKEND_VIRTUAL ? "[BACKSTAGE] initialise - virtual backend" : "[BACKSTAGE] initialise");
+
+    /* The caller owns the audio and STFT buffers */
+
+    audioBuffer = audio;
+
+    stftBuffer = stft;
+
+    /* Initialise timers */
+
+    ma_timer_init(&timer);
+
+    /* Initialise the contexts. The virtual backend only offers the null devices, which are paced by a timer */
+
+    virtualBackend = backend == BACKEND_VIRTUAL;
+
+    ma_backend nullBackend = ma_backend_null;
+
+    ma_backend *backends = virtualBackend ? &nullBackend : NULL;
+
+    ma_uint32 numberOfBackends = virtualBackend ? 1 : 0;
+
+    ma_result result = ma_context_init(backends, numberOfBackends, NULL, &deviceCheckContext);
+
+    if (result != MA_SUCCESS) {
+
+        puts("[BACKSTAGE] Could not initialise device check context");
+
+        success = false;
+
+    }
+
+    result = ma_context_init(backends, numberOfBackends, NULL, &playbackContext);
+
+    if (result != MA_SUCCESS) {
+
+        puts("[BACKSTAGE] Could not initialise playback context");
+
+        success = false;
+
+    }
+
+    /* Initialise autosave queue */
+
+    bool initialised = Autosave_initialise(AUTOSAVE_EVENT_QUEUE_SIZE);
+
+    if (initialised == false) {
+
+        puts("[BACKSTAGE] Could not initialise autosave queue");
+
+        success = false;
+
+    }
+
+    /* Initialise STFT and trigger */
+
+    STFT_initialise();
+
+    Trigger_initialise();
+
+    Prefilter_initialise();
+
+    Timestamps_initialise();
+
+    /* Initialise recording schedule */
+
+    Schedule_initialise();
+
+    /* Initialise the heterodyne mixer */
+
+    Heterodyne_initialise(MAXIMUM_SAMPLE_RATE, DEFAULT_HETERODYNE_FREQUENCY);
+
+    /* Initialise the frequency divider */
+
+    FrequencyDivider_initialise();
+
+    /* Precompute the playback resampler filter banks */
+
+    int32_t resamplerSampleRates[NUMBER_OF_VALID_SAMPLE_RATES * NUMBER_OF_TIME_EXPANSIONS];
+
+    for (int32_t i = 0; i < NUMBER_OF_VALID_SAMPLE_RATES; i += 1) {
+
+        for (int32_t j = 0; j < NUMBER_OF_TIME_EXPANSIONS; j += 1) resamplerSampleRates[i * NUMBER_OF_TIME_EXPANSIONS + j] = validSampleRates[i] / validTimeExpansions[j];
+
+    }
+
+    if (Resampler_designFilterBanks(resamplerSampleRates, NUMBER_OF_VALID_SAMPLE_RATES * NUMBER_OF_TIME_EXPANSIONS, PLAYBACK_SAMPLE_RATE) == false) puts("[BACKSTAGE] Failed to design resampler filter banks");
+
+    /* Initialise mutexes */
+
+    pthread_mutex_init(&playbackMutex, NULL);
+
+    pthread_mutex_init(&autosaveMutex, NULL);
+
+
+    pthread_mutex_init(&stopStartMutex, NULL);
+
+    pthread_mutex_init(&backgroundMutex, NULL);
+
+    pthread_mutex_init(&audioBufferMutex, NULL);
+
+    pthread_mutex_init(&fileDestinationMutex, NULL);
+
+    pthread_mutex_init(&simulationRunningMutex, NULL);
+
+    pthread_mutex_init(&backgroundDeviceCheckMutex, NULL);
+
+    pthread_mutex_init(&autosaveWakeMutex, NULL);
+
+    pthread_mutex_init(&sinkMutex, NULL);
+
+    pthread_cond_init(&autosaveWakeCondition, NULL);
+
+    /* Start the background and autosave threads */
+
+    pthread_create(&backgroundThread, NULL, backgroundThreadBody, NULL);
+
+    pthread_create(&autosaveThread, NULL, autosaveThreadBody, NULL);
+
+    /* Reset the start flag */
+
+    pthread_mutex_lock(&stopStartMutex);
+
+    started = false;
+
+    pthread_mutex_unlock(&stopStartMutex);
+
+    /* Start device */
+
+    pthread_mutex_lock(&backgroundDeviceCheckMutex);
+
+    device_check_t device_check = checkForAudioMoth(&deviceCheckContext, true);
+
+    usingAudioMoth = device_check.audioMothFound;
+
+    bool startedMicrophone = startMicrophone(&deviceCheckContext, usingAudioMoth);
+
+    pthread_mutex_unlock(&backgroundDeviceCheckMutex);
+
+    puts(usingAudioMoth ? "[BACKSTAGE] Started AudioMoth" : "[BACKSTAGE] Started default device");
+
+    if (startedMicrophone == false) {
+
+        puts("[BACKSTAGE] Failed to start capture");
+
+        success = false;
+
+    }
+
+    /* Wait for device to start */
+
+    bool threadStarted = false;
+
+    double startTime = ma_timer_get_time_in_seconds(&timer);
+
+    while (threadStarted == false) {
+
+        double currentTime = ma_timer_get_time_in_seconds(&timer);
+
+        if (currentTime - startTime > DEVICE_STOP_START_TIMEOUT) {
+
+            puts("[BACKSTAGE] Timed out waiting for device to start");
+
+            break;
+
+        }
+
+        pthread_mutex_lock(&stopStartMutex);
+
+        threadStarted = started;
+
+        pthread_mutex_unlock(&stopStartMutex);
+
+    }
+
+    success &= threadStarted;
+
+    return success;
+
+}
+
+void Engine_changeSampleRate(int32_t sampleRate) {
+
+    printf("[BACKSTAGE] changeSampleRate - %d\n", sampleRate);
+
+    for (uint32_t i = 0; i < NUMBER_OF_VALID_SAMPLE_RATES; i += 1) {
+
+        if (sampleRate == validSampleRates[i] && sampleRate != requestedSampleRate) {
+
+            requestedSampleRate = sampleRate;
+
+            requestedSampleRateChanged = true;
+
+            break;
+
+        }
+
+    }
+
+}
+
+void Engine_getFrame(EN_frame_t *frame) {
+
+    /* Determine the offset and length for update and all data */
+
+    pthread_mutex_lock(&audioBufferMutex);
+
+    int32_t audioIndex = frontEndPaused ? captureBufferWriteIndex : audioBufferWriteIndex;
+
+    int64_t audioCount = frontEndPaused ? captureBufferSampleCount : audioBufferSampleCount;
+
+    int64_t unpausedAudioCount = audioBufferSampleCount;
+
+    int64_t audioTime = audioBufferStartTime;
+
+    /* The capture thread switches rate together with the count and time so all three are read together */
+
+    int32_t audioSampleRate = currentSampleRate;
+
+    pthread_mutex_unlock(&audioBufferMutex);
+
+    /* Calculate unpaused audio time */
+
+    int64_t unpausedAudioTime = audioTime + Timing_samplesToMilliseconds(unpausedAudioCount, audioSampleRate);
+
+    /* Apply time corrections */
+
+    int64_t localTimeOffset = Atomic_load32(&useLocalTime) ? Time_getLocalTimeOffset() : 0;
+
+    audioTime += Timing_samplesToMilliseconds(audioCount, audioSampleRate);
+
+    audioTime += localTimeOffset * MILLISECONDS_IN_SECOND;
+
+    /* Read the simulation state */
+
+    pthread_mutex_lock(&simulationRunningMutex);
+
+    bool simulationFlag = simulationRunning;
+
+    pthread_mutex_unlock(&simulationRunningMutex);
+
+    /* Check the drift corrected audio time against the current time */
+
+    int64_t currentTime = Time_getMillisecondUTC();
+
+    bool timeMismatch = simulationFlag == false && (ABS(currentTime - unpausedAudioTime) > TIME_MISMATCH_LIMIT || Timing_isDiscontinuous());
+
+    /* Check if the device has changed */
+
+    bool deviceChanged = false;
+
+    bool setOldAudioMothFoundFlag = false;
+
+    static bool oldAudioMothFound = false;
+
+    pthread_mutex_lock(&backgroundMutex);
+
+    if (backgroundDeviceCheckTime - timeDeviceStarted > DEVICE_CHANGE_INTERVAL) {
+
+        if (backgroundDeviceCheckFoundAudioMoth == true && usingAudioMoth == false) deviceChanged = true;
+
+        if (backgroundDeviceCheckFoundAudioMoth == false && usingAudioMoth == true) deviceChanged = true;
+
+        if (backgroundDeviceCheckFoundOldAudioMoth && oldAudioMothFound == false) setOldAudioMothFoundFlag = true;
+
+        oldAudioMothFound = backgroundDeviceCheckFoundOldAudioMoth;
+
+    }
+
+    pthread_mutex_unlock(&backgroundMutex);
+
+    /* Check if sample rate has changed */
+
+    bool sampleRateChanged = false;
+
+    if (requestedSampleRateChanged) {
+
+        sampleRateChanged = currentSampleRate != MIN(requestedSampleRate, inputDeviceSampleRate);
+
+        requestedSampleRateChanged = false;
+
+    }
+
+    /* Restart the simulation when the playlist moves to a file at a different sample rate. The playlist continues from that file */
+
+    if (Atomic_compareExchange32(&simulationSampleRateChanged, true, false) && simulationFlag) shouldStartSimulation = true;
+
+    /* Write out everything processed and return to the input device once offline processing reaches the end of the playlist */
+
+    bool offlineComplete = Atomic_compareExchange32(&offlineFinished, true, false) && simulationFlag;
+
+    if (offlineComplete) {
+
+        puts("[BACKSTAGE] Offline processing complete");
+
+        pthread_mutex_lock(&autosaveMutex);
+
+        int32_t currentDuration = autosaveDuration;
+
+        pthread_mutex_unlock(&autosaveMutex);
+
+        if (currentDuration > 0) {
+
+            addAutosaveEvent(AS_STOP);
+
+            addAutosaveEvent(AS_START);
+
+        }
+
+        shouldStopSimulation = true;
+
+    }
+
+    /* The capture path switches rate at the next frame boundary while the device keeps running */
+
+    if (sampleRateChanged && simulationFlag == false) {
+
+        Atomic_store32(&pendingSampleRate, (uint32_t)MIN(requestedSampleRate, inputDeviceSampleRate));
+
+        sampleRateChanged = false;
+
+    }
+
+    if (Atomic_compareExchange32(&sampleRateSwitched, true, false)) {
+
+        /* Samples before the switch are at the old rate so restart monitoring from the switch */
+
+        pthread_mutex_lock(&playbackMutex);
+
+        playbackBufferCount = 0;
+
+        playbackReadIndex = (int32_t)Atomic_load32(&monitorBufferWriteIndex);
+
+        pthread_mutex_unlock(&playbackMutex);
+
+        shouldSetRedrawFlag = true;
+
+    }
+
+    /* Fill in the frame */
+
+    frame->redrawRequired = !frontEndPaused && shouldSetRedrawFlag;
+
+    frame->simulationRunning = simulationFlag;
+
+    frame->offlineComplete = offlineComplete;
+
+    frame->oldAudioMothFound = setOldAudioMothFoundFlag;
+
+    frame->triggered = Trigger_isTriggered();
+
+    frame->processingSuspended = Atomic_load32(&processingSuspended);
+
+    /* Report the review cursor and release the playback device once review has finished */
+
+    frame->reviewPosition = -1.0;
+
+    if (Atomic_load32(&reviewState) != REVIEW_IDLE) frame->reviewPosition = (double)Atomic_load32(&reviewCursor) * MILLISECONDS_IN_SECOND / (double)captureBufferSampleRate;
+
+    updatePlaybackDevice();
+
+    frame->deviceName = inputDeviceName;
+
+    frame->maximumSampleRate = usingAudioMoth ? audioMothSampleRate : maximumDefaultSampleRate;
+
+    frame->currentSampleRate = audioSampleRate;
+
+    frame->audioTime = audioTime;
+
+    frame->audioIndex = audioIndex;
+
+    frame->audioCount = audioCount;
+
+    /* Actions to take this frame */
+
+    bool shouldRestart = false;
+
+    bool shouldStopDevice = false;
+
+    bool shouldStartDevice = false;
+
+    bool shouldStopSimulationThread = false;
+
+    bool shouldStartSimulationThread = false;
+
+    if (!frontEndPaused) shouldSetRedrawFlag = false;
+
+    /* Determine actions to take */
+
+    if (deviceChanged && simulationFlag == false) {
+
+        shouldStopDevice = true;
+
+        shouldRestart = true;
+
+        shouldStartDevice = true;
+
+        deviceChanged = false;
+
+    } else if (timeMismatch || sampleRateChanged) {
+
+        if (timeMismatch) puts("[BACKSTAGE] Restarting due to time mismatch");
+
+        if (simulationFlag == false) {
+
+            shouldStopDevice = true;
+
+        } else {
+
+            shouldStopSimulationThread = true;
+
+        }
+
+        shouldRestart = true;
+
+        if (simulationFlag == false) {
+
+            shouldStartDevice = true;
+
+        } else {
+
+            shouldStartSimulationThread = true;
+
+        }
+
+    } else if (maximumDefaultSampleRateChanged) {
+
+        bool sampleRateChanged = requestedMaximumDefaultSampleRate != maximumDefaultSampleRate;
+
+        maximumDefaultSampleRate = requestedMaximumDefaultSampleRate;
+
+        if (usingAudioMoth == false && simulationFlag == false && sampleRateChanged) {
+
+            shouldStopDevice = true;
+
+            shouldRestart = true;
+
+            shouldStartDevice = true;
+
+        }
+
+        maximumDefaultSampleRateChanged = false;
+
+    } else if (latencyProfileChanged) {
+
+        lowLatencyEnabled = requestedLowLatency;
+
+        exclusiveModeEnabled = requestedExclusiveMode;
+
+        Atomic_store32(&targetPlaybackLagMilliseconds, lowLatencyEnabled ? LOW_LATENCY_TARGET_PLAYBACK_LAG : TARGET_PLAYBACK_LAG_MILLISECONDS);
+
+        Atomic_store32(&playbackCallbacksPerSecond, lowLatencyEnabled ? LOW_LATENCY_CALLBACKS_PER_SECOND : CALLBACKS_PER_SECOND);
+
+        if (simulationFlag == false) {
+
+            shouldStopDevice = true;
+
+            shouldRestart = true;
+
+            shouldStartDevice = true;
+
+        }
+
+        if (playbackDeviceRunning) pthread_create(&startPlaybackThread, NULL, restartPlaybackThreadBody, NULL);
+
+        latencyProfileChanged = false;
+
+    } else if (shouldStartSimulation) {
+
+        if (simulationFlag == false) {
+
+            shouldStopDevice = true;
+
+        } else {
+
+            shouldStopSimulationThread = true;
+
+        }
+
+        shouldRestart = true;
+
+        shouldStartSimulationThread = true;
+
+        shouldStartSimulation = false;
+
+    } else if (shouldStopSimulation) {
+
+        if (simulationFlag) {
+
+            shouldStopSimulationThread = true;
+
+            shouldRestart = true;
+
+            shouldStartDevice = true;
+
+        }
+
+        shouldStopSimulation = false;
+
+    }
+
+    /* Implement the actions determined above */
+
+    if (shouldStopDevice && shouldStartDevice) Atomic_store64(&deviceRestartRequestTime, Time_getMonotonicMicroseconds());
+
+    if (shouldStopDevice || shouldStopSimulationThread) {
+
+        /* Reset the stopped flag */
+
+        pthread_mutex_lock(&stopStartMutex);
+
+        stopped = false;
+
+        pthread_mutex_unlock(&stopStartMutex);
+
+        /* Stop the device or simulation */
+
+        if (shouldStopDevice) {
+
+            puts(usingAudioMoth ? "[BACKSTAGE] Stop AudioMoth" : "[BACKSTAGE] Stop default device");
+
+            pthread_mutex_lock(&backgroundDeviceCheckMutex);
+
+            stopMicrophone();
+
+            pthread_mutex_unlock(&backgroundDeviceCheckMutex);
+
+        }
+
+        if (shouldStopSimulationThread) {
+
+            puts("[BACKSTAGE] Stop simulation thread");
+
+            pthread_mutex_lock(&simulationRunningMutex);
+
+            simulationRunning = false;
+
+            pthread_mutex_unlock(&simulationRunningMutex);
+
+        }
+
+        /* Wait for device to stop */
+
+        bool threadStopped = false;
+
+        double startTime = ma_timer_get_time_in_seconds(&timer);
+
+        while (threadStopped == false) {
+
+            double currentTime = ma_timer_get_time_in_seconds(&timer);
+
+            if (currentTime - startTime > DEVICE_STOP_START_TIMEOUT) {
+
+                if (IS_WINDOWS == false && shouldStopDevice) puts("[BACKSTAGE] Timed out waiting for device to stop");
+
+                if (shouldStopSimulationThread) puts("[BACKSTAGE] Timed out waiting for simulation thread to stop");
+
+                break;
+
+            }
+
+            pthread_mutex_lock(&stopStartMutex);
+
+            threadStopped = stopped;
+
+            pthread_mutex_unlock(&stopStartMutex);
+
+        }
+
+    }
+
+    if (shouldRestart) {
+
+        /* Reset buffer indices */
+
+        pthread_mutex_lock(&audioBufferMutex);
+
+        audioBufferSampleCount = 0;
+
+        audioBufferIndex -= audioBufferIndex % STFT_INPUT_SAMPLES;
+
+        Atomic_store32(&monitorBufferWriteIndex, (uint32_t)audioBufferIndex);
+
+        pthread_mutex_unlock(&audioBufferMutex);
+
+        /* Reset playback indices */
+
+        pthread_mutex_lock(&playbackMutex);
+
+        playbackBufferCount = 0;
+
+        playbackReadIndex = audioBufferWriteIndex;
+
+        pthread_mutex_unlock(&playbackMutex);
+
+        /* Set redraw flags */
+
+        shouldSetRedrawFlag = true;
+
+    }
+
+    if (shouldStartDevice || shouldStartSimulationThread) {
+
+        /* Reset the start flag */
+
+        pthread_mutex_lock(&stopStartMutex);
+
+        started = false;
+
+        pthread_mutex_unlock(&stopStartMutex);
+
+        /* Start the device or simulation */
+
+        if (shouldStartDevice) {
+
+            pthread_mutex_lock(&backgroundDeviceCheckMutex);
+
+            device_check_t device_check = checkForAudioMoth(&deviceCheckContext, true);
+
+            usingAudioMoth = device_check.audioMothFound;
+
+            Atomic_store32(&offlineProcessing, false);
+
+            startMicrophone(&deviceCheckContext, usingAudioMoth);
+
+            pthread_mutex_unlock(&backgroundDeviceCheckMutex);
+
+            puts(usingAudioMoth ? "[BACKSTAGE] Start AudioMoth" : "[BACKSTAGE] Start default device");
+
+            timeDeviceStarted = ma_timer_get_time_in_seconds(&timer);
+
+        }
+
+        if (shouldStartSimulationThread) {
+
+            Simulator_initialiseExample();
+
+            inputDeviceSampleRate = Simulator_getSampleRate();
+
+            snprintf(inputDeviceName, DEVICE_NAME_SIZE, "Simulated %dkHz AudioMoth USB Microphone", inputDeviceSampleRate / HERTZ_IN_KILOHERTZ);
+
+            snprintf(inputDeviceCommentName, DEVICE_NAME_SIZE, "a simulated %dkHz AudioMoth USB Microphone", inputDeviceSampleRate / HERTZ_IN_KILOHERTZ);
+
+            inputDeviceCommentNameID = Autosave_internDeviceName(inputDeviceCommentName);
+
+            currentSampleRate = inputDeviceSampleRate;
+
+            /* A new offline run starts its sample clock while a restart within the run carries it on */
+
+            if (offlineRequested) {
+
+                offlineClockTime = offlineRequestedStartTime * MICROSECONDS_IN_MILLISECOND;
+
+                Atomic_store64(&offlineSamplesProcessed, 0);
+
+                Atomic_store32(&offlineThroughput, 0);
+
+                Atomic_store32(&offlineFinished, false);
+
+                offlineRequested = false;
+
+            }
+
+            bool offline = simulationOffline;
+
+            Atomic_store32(&offlineProcessing, offline);
+
+            puts(offline ? "[BACKSTAGE] Start offline processing thread" : "[BACKSTAGE] Start simulation thread");
+
+            pthread_mutex_lock(&simulationRunningMutex);
+
+            simulationRunning = true;
+
+            pthread_mutex_unlock(&simulationRunningMutex);
+
+            pthread_create(&simulationThread, NULL, offline ? offlineThreadBody : simulationThreadBody, NULL);
+
+        }
+
+        /* Wait for device to start */
+
+        bool threadStarted = false;
+
+        double startTime = ma_timer_get_time_in_seconds(&timer);
+
+        while (threadStarted == false) {
+
+            double currentTime = ma_timer_get_time_in_seconds(&timer);
+
+            if (currentTime - startTime > DEVICE_STOP_START_TIMEOUT) {
+
+                if (shouldStartDevice) puts("[BACKSTAGE] Timed out waiting for device to start");
+
+                if (shouldStartSimulationThread) puts("[BACKSTAGE] Timed out waiting for simulation thread to start");
+
+                break;
+
+            }
+
+            pthread_mutex_lock(&stopStartMutex);
+
+            threadStarted = started;
+
+            pthread_mutex_unlock(&stopStartMutex);
+
+        }
+
+        /* Add autosave event */
+
+        pthread_mutex_lock(&autosaveMutex);
+
+        int32_t currentDuration = autosaveDuration;
+
+        pthread_mutex_unlock(&autosaveMutex);
+
+        if (threadStarted && currentDuration > 0) addAutosaveEvent(AS_RESTART);
+
+    }
+
+}
+
+void Engine_clear(void) {
+
+    puts("[BACKSTAGE] clear");
+
+    /* Reset buffer indices */
+
+    pthread_mutex_lock(&audioBufferMutex);
+
+    int64_t milliseconds = Timing_samplesToMilliseconds(audioBufferSampleCount, currentSampleRate);
+
+    audioBufferStartTime += milliseconds;
+
+    audioBufferSampleCount = 0;
+
+    pthread_mutex_unlock(&audioBufferMutex);
+
+    /* Set the reset flag */
+
+    shouldSetRedrawFlag = true;
+
+}
+
+void Engine_capture(int32_t duration, void (*callback)(bool success)) {
+
+    printf("[BACKSTAGE] capture - %d\n", duration);
+
+    captureBufferCallback = callback;
+
+    /* Start thread */
+
+    if (!frontEndPaused) {
+
+        duration = MAX(0, MIN(MAXIMUM_RECORD_DURATION, duration));
+
+        captureAudioBuffer(duration);
+
+    }
+
+    pthread_create(&captureBufferThread, NULL, captureBufferThreadBody, NULL);
+
+}
+
+void Engine_setPause(bool enable, int32_t duration, EN_pause_t *pause) {
+
+    printf("[BACKSTAGE] setPause - %s, %d\n", enable ? "true" : "false", duration);
+
+    if (enable && !frontEndPaused) {
+
+        duration = MAX(0, MIN(MAXIMUM_RECORD_DURATION, duration));
+
+        Atomic_store32(&reviewState, REVIEW_IDLE);
+
+        captureAudioBuffer(duration);
+
+        frontEndPaused = true;
+
+    }
+
+    if (!enable && frontEndPaused) {
+
+        Atomic_store32(&reviewState, REVIEW_IDLE);
+
+        updatePlaybackDevice();
+
+        frontEndPaused = false;
+
+        shouldSetRedrawFlag = true;
+
+    }
+
+    /* Fill in the paused audio details */
+
+    pause->paused = frontEndPaused;
+
+    pause->audioStartTime = captureBufferStartTime;
+
+    pause->audioIndex = captureBufferWriteIndex;
+
+    pause->audioCount = captureBufferSampleCount;
+
+}
+
+bool Engine_setReview(bool enable, int32_t expansion, double startTime, double stopTime) {
+
+    printf("[BACKSTAGE] setReview - %s, %d, %.0f, %.0f\n", enable ? "true" : "false", expansion, startTime, stopTime);
+
+    /* Stop any current review */
+
+    Atomic_store32(&reviewState, REVIEW_IDLE);
+
+    bool success = true;
+
+    if (enable) {
+
+        /* Check the expansion factor and that there is paused audio to review */
+
+        bool validExpansion = false;
+
+        for (int32_t i = 0; i < NUMBER_OF_TIME_EXPANSIONS; i += 1) validExpansion |= expansion == validTimeExpansions[i];
+
+        success = validExpansion && frontEndPaused && captureBufferLength > 0;
+
+        if (success) {
+
+            /* Convert the selection in milliseconds from the start of the paused audio to sample indices */
+
+            int32_t startIndex = (int32_t)MAX(0, MIN(captureBufferLength, (int64_t)(startTime * captureBufferSampleRate / MILLISECONDS_IN_SECOND)));
+
+            int32_t stopIndex = (int32_t)MAX(0, MIN(captureBufferLength, (int64_t)(stopTime * captureBufferSampleRate / MILLISECONDS_IN_SECOND)));
+
+            reviewStartIndex = startIndex;
+
+            reviewStopIndex = stopIndex > startIndex ? stopIndex : captureBufferLength;
+
+            reviewExpansion = expansion;
+
+            Atomic_store32(&reviewCursor, (uint32_t)reviewStartIndex);
+
+            Atomic_store32(&reviewState, REVIEW_STARTING);
+
+        }
+
+    }
+
+    updatePlaybackDevice();
+
+    return success;
+
+}
+
+void Engine_setFileDestination(char *destination) {
+
+    printf("[BACKSTAGE] setFileDestination - %s\n", destination);
+
+    pthread_mutex_lock(&fileDestinationMutex);
+
+    strncpy(fileDestination, destination, FILEPATH_SIZE - 1);
+
+    fileDestination[FILEPATH_SIZE - 1] = 0;
+
+    fileDestinationSet = true;
+
+    pthread_mutex_unlock(&fileDestinationMutex);
+
+}
+
+void Engine_setAutoSaveCallback(void (*callback)(void)) {
+
+    puts("[BACKSTAGE] setAutoSaveCallback");
+
+    autosaveErrorCallback = callback;
+
+}
+
+void Engine_setAutoSave(int32_t duration, int32_t segmentLength) {
+
+    segmentLength = segmentLength > 0 ? MAX(MINIMUM_SEGMENT_LENGTH, MIN(MAXIMUM_SEGMENT_LENGTH, segmentLength)) : 0;
+
+    printf("[BACKSTAGE] setAutoSave - %d, %d\n", duration, segmentLength);
+
+    pthread_mutex_lock(&autosaveMutex);
+
+    int32_t currentDuration = autosaveDuration;
+
+    int32_t currentSegmentLength = autosaveSegmentLength;
+
+    pthread_mutex_unlock(&autosaveMutex);
+
+    /* Restart a running autosave so the new segment length takes effect */
+
+    bool segmentLengthChanged = currentDuration > 0 && duration > 0 && currentSegmentLength != segmentLength;
+
+    if (currentDuration > 0 && (duration == 0 || segmentLengthChanged)) addAutosaveEvent(AS_STOP);
+
+    pthread_mutex_lock(&autosaveMutex);
+
+    autosaveDuration = duration;
+
+    autosaveSegmentLength = segmentLength;
+
+    pthread_mutex_unlock(&autosaveMutex);
+
+    if ((currentDuration == 0 || segmentLengthChanged) && duration > 0) addAutosaveEvent(AS_START);
+
+}
+
+void Engine_setTrigger(bool enable, int32_t minimumFrequency, int32_t maximumFrequency, double threshold, double hysteresis, int32_t preTrigger, int32_t postTrigger) {
+
+    preTrigger = MAX(0, MIN(MAXIMUM_TRIGGER_PERIOD, preTrigger));
+
+    postTrigger = MAX(0, MIN(MAXIMUM_TRIGGER_PERIOD, postTrigger));
+
+    if (enable) {
+
+        printf("[BACKSTAGE] setTrigger - true, %d, %d, %.1f, %.1f, %d, %d\n", minimumFrequency, maximumFrequency, threshold, hysteresis, preTrigger, postTrigger);
+
+    } else {
+
+        puts("[BACKSTAGE] setTrigger - false");
+
+    }
+
+    bool enableChanged = enable != Trigger_isEnabled();
+
+    /* Restart a running autosave so the mode change takes effect */
+
+    pthread_mutex_lock(&autosaveMutex);
+
+    int32_t currentDuration = autosaveDuration;
+
+    pthread_mutex_unlock(&autosaveMutex);
+
+    if (currentDuration > 0 && enableChanged) addAutosaveEvent(AS_STOP);
+
+    Trigger_configure(enable, minimumFrequency, maximumFrequency, threshold, hysteresis, preTrigger, postTrigger);
+
+    if (currentDuration > 0 && enableChanged) addAutosaveEvent(AS_START);
+
+}
+
+void Engine_setDutyCycleSchedule(int32_t recordDuration, int32_t period, bool suspend) {
+
+    printf("[BACKSTAGE] setSchedule - 1, %d, %d, %s\n", recordDuration, period, suspend ? "true" : "false");
+
+    Schedule_setDutyCycle(recordDuration, period * SECONDS_IN_MINUTE);
+
+    setScheduleSuspendsProcessing(suspend);
+
+}
+
+void Engine_setWindowSchedule(int32_t numberOfWindows, int32_t *startMinutes, int32_t *stopMinutes, bool suspend) {
+
+    numberOfWindows = MAX(0, MIN(MAXIMUM_NUMBER_OF_WINDOWS, numberOfWindows));
+
+    printf("[BACKSTAGE] setSchedule - 2, %d windows, %s\n", numberOfWindows, suspend ? "true" : "false");
+
+    Schedule_setWindows(numberOfWindows, startMinutes, stopMinutes);
+
+    setScheduleSuspendsProcessing(suspend);
+
+}
+
+void Engine_clearSchedule(void) {
+
+    puts("[BACKSTAGE] setSchedule - 0");
+
+    Schedule_clear();
+
+    setScheduleSuspendsProcessing(false);
+
+}
+
+void Engine_setFilter(int32_t type, int32_t frequency1, int32_t frequency2) {
+
+    if (type == PF_LOW_PASS || type == PF_HIGH_PASS) {
+
+        printf("[BACKSTAGE] setFilter - %d, %d\n", type, frequency1);
+
+    } else if (type == PF_BAND_PASS || type == PF_NOTCH) {
+
+        printf("[BACKSTAGE] setFilter - %d, %d, %d\n", type, frequency1, frequency2);
+
+    } else {
+
+        type = PF_NONE;
+
+        puts("[BACKSTAGE] setFilter - 0");
+
+    }
+
+    Prefilter_configure(type, frequency1, frequency2);
+
+}
+
+void Engine_setSimulationPath(char *path) {
+
+    printf("[BACKSTAGE] getSimulationInfo - %s\n", path);
+
+    Simulator_setPath(path);
+
+}
+
+bool Engine_startSimulationExample(int32_t index) {
+
+    printf("[BACKSTAGE] setSimulation - true, %d\n", index);
+
+    bool success = Simulator_loadExample(index);
+
+    if (success) {
+
+        configureSimulation(false, 0.0);
+
+        shouldStartSimulation = true;
+
+    }
+
+    return success;
+
+}
+
+void Engine_clearSimulationPlaylist(void) {
+
+    Simulator_clearPlaylist();
+
+    simulationPlaylistLength = 0;
+
+}
+
+bool Engine_addToSimulationPlaylist(char *filename) {
+
+    bool success = Simulator_addToPlaylist(filename);
+
+    if (success == false) printf("[BACKSTAGE] Could not add %s to the simulation playlist\n", filename);
+
+    if (success) simulationPlaylistLength += 1;
+
+    return success;
+
+}
+
+bool Engine_startSimulationPlaylist(bool offline, double startTime) {
+
+    printf("[BACKSTAGE] setSimulation - true, %d files\n", simulationPlaylistLength);
+
+    bool success = simulationPlaylistLength > 0;
+
+    if (success) {
+
+        configureSimulation(offline, startTime);
+
+        shouldStartSimulation = true;
+
+    }
+
+    return success;
+
+}
+
+bool Engine_startGenerator(GN_settings_t *settings, bool offline, double startTime) {
+
+    printf("[BACKSTAGE] setSimulation - true, %s at %d Hz\n", Generator_getName(settings->signal), settings->sampleRate);
+
+    bool success = Simulator_loadGenerator(settings);
+
+    if (success) {
+
+        configureSimulation(offline, startTime);
+
+        shouldStartSimulation = true;
+
+    }
+
+    /* Files added afterwards start a new playlist */
+
+    simulationPlaylistLength = 0;
+
+    return success;
+
+}
+
+void Engine_stopSimulation(void) {
+
+    puts("[BACKSTAGE] setSimulation - false");
+
+    shouldStopSimulation = true;
+
+}
+
+void Engine_setMonitor(int32_t mode, int32_t numberOfChannels, int32_t *frequencies, float *pans, int32_t division) {
+
+    numberOfChannels = MAX(1, MIN(HETERODYNE_MAXIMUM_CHANNELS, numberOfChannels));
+
+    if (mode == MONITOR_HETERODYNE) {
+
+        printf("[BACKSTAGE] setMonitor - 2");
+
+        for (int32_t i = 0; i < numberOfChannels; i += 1) printf(", %d (%.2f)", frequencies[i], pans[i]);
+
+        printf("\n");
+
+    } else if (mode == MONITOR_FREQUENCY_DIVISION) {
+
+        frequencyDivision = MAX(1, MIN(MAXIMUM_FREQUENCY_DIVISION, division));
+
+        printf("[BACKSTAGE] setMonitor - 3, %d\n", frequencyDivision);
+
+    } else {
+
+        printf("[BACKSTAGE] setMonitor - %d\n", mode);
+
+    }
+
+    /* Update heterodyne */
+
+    if (mode == MONITOR_HETERODYNE) {
+
+        Atomic_store32(&heterodyneSettingsSequence, Atomic_load32(&heterodyneSettingsSequence) + 1);
+
+        Atomic_releaseFence();
+
+        heterodyneNumberOfChannels = numberOfChannels;
+
+        memset(heterodyneFrequencies, 0, sizeof(heterodyneFrequencies));
+
+        memset(heterodynePans, 0, sizeof(heterodynePans));
+
+        memcpy(heterodyneFrequencies, frequencies, numberOfChannels * sizeof(int32_t));
+
+        memcpy(heterodynePans, pans, numberOfChannels * sizeof(float));
+
+        Atomic_store32(&heterodyneSettingsSequence, Atomic_load32(&heterodyneSettingsSequence) + 1);
+
+    }
+
+    heterodyneEnabled = mode == MONITOR_HETERODYNE;
+
+    frequencyDivisionEnabled = mode == MONITOR_FREQUENCY_DIVISION;
+
+    /* Stop and start monitor */
+
+    if (!monitorEnabled && (mode == MONITOR_PLAYTHROUGH || mode == MONITOR_HETERODYNE || mode == MONITOR_FREQUENCY_DIVISION)) {
+
+        playbackBufferCount = 0;
+
+        playbackReadIndex = (int32_t)Atomic_load32(&monitorBufferWriteIndex);
+
+        monitorEnabled = true;
+
+    } else if (monitorEnabled && mode == MONITOR_OFF) {
+
+        monitorEnabled = false;
+
+    }
+
+    updatePlaybackDevice();
+
+}
+
+void Engine_setHighDefaultSampleRate(bool enable) {
+
+    printf("[BACKSTAGE] setHighDefaultSampleRate - %s\n", enable ? "true" : "false");
+
+    requestedMaximumDefaultSampleRate = enable ? MAXIMUM_SAMPLE_RATE : DEFAULT_SAMPLE_RATE;
+
+    maximumDefaultSampleRateChanged = true;
+
+}
+
+void Engine_setLocalTime(bool enable) {
+
+    printf("[BACKSTAGE] setLocalTime - %s\n", enable ? "true" : "false");
+
+    Atomic_store32(&useLocalTime, enable);
+
+    /* Treat the call as a prompt that the time zone may have changed */
+
+    Time_invalidateLocalTimeOffset();
+
+}
+
+void Engine_forceAutoSaveToStop(void) {
+
+    puts("[BACKSTAGE] forceAutoSaveToStop");
+
+    /* Set shutdown flag */
+
+    pthread_mutex_lock(&autosaveMutex);
+
+    autosaveShutdownCompleted = false;
+
+    pthread_mutex_unlock(&autosaveMutex);
+
+    /* Send shutdown message */
+
+    addAutosaveEvent(AS_SHUTDOWN);
+
+    /* Wait for shutdown to complete */
+
+    bool shutdownCompleted = false;
+
+    double startTime = ma_timer_get_time_in_seconds(&timer);
+
+    while (shutdownCompleted == false) {
+
+        double currentTime = ma_timer_get_time_in_seconds(&timer);
+
+        if (currentTime - startTime > DEVICE_SHUTDOWN_TIMEOUT) {
+
+            puts("[BACKSTAGE] Timed out waiting for shutdown to complete");
+
+            break;
+
+        }
+
+        pthread_mutex_lock(&autosaveMutex);
+
+        shutdownCompleted = autosaveShutdownCompleted;
+
+        pthread_mutex_unlock(&autosaveMutex);
+
+    }
+
+    puts("[BACKSTAGE] Autosave shutdown complete");
+
+}
+
+void Engine_setLowLatency(bool enable, bool exclusive) {
+
+    printf("[BACKSTAGE] setLowLatency - %s, %s\n", enable ? "true" : "false", exclusive ? "exclusive" : "shared");
+
+    requestedLowLatency = enable;
+
+    requestedExclusiveMode = exclusive;
+
+    latencyProfileChanged = requestedLowLatency != lowLatencyEnabled || requestedExclusiveMode != exclusiveModeEnabled;
+
+}
+
+bool Engine_measureLatency(void) {
+
+    puts("[BACKSTAGE] measureLatency");
+
+    /* The click is only played while monitoring */
+
+    return monitorEnabled && Atomic_compareExchange32(&latencyMeasurementState, LATENCY_IDLE, LATENCY_REQUESTED);
+
+}
+
+void Engine_getStats(EN_stats_t *stats) {
+
+    /* Read playback statistics */
+
+    pthread_mutex_lock(&playbackMutex);
+
+    double lag = playbackLagMilliseconds;
+
+    double adjustment = playbackDriftAdjustment;
+
+    double loopbackLatency = measuredLoopbackLatency;
+
+    pthread_mutex_unlock(&playbackMutex);
+
+    /* Estimate latency from the device periods and the playback lag */
+
+    double capturePeriod = captureDevice.capture.internalSampleRate == 0 ? 0.0 : (double)MILLISECONDS_IN_SECOND * captureDevice.capture.internalPeriodSizeInFrames / captureDevice.capture.internalSampleRate;
+
+    double playbackBuffer = playbackDeviceRunning == false || playbackDevice.playback.internalSampleRate == 0 ? 0.0 : (double)MILLISECONDS_IN_SECOND * playbackDevice.playback.internalPeriodSizeInFrames * playbackDevice.playback.internalPeriods / playbackDevice.playback.internalSampleRate;
+
+    stats->lowLatency = lowLatencyEnabled;
+
+    stats->exclusiveMode = exclusiveModeEnabled;
+
+    stats->capturePeriod = capturePeriod;
+
+    stats->playbackBuffer = playbackBuffer;
+
+    stats->playbackLag = lag;
+
+    stats->targetPlaybackLag = (double)Atomic_load32(&targetPlaybackLagMilliseconds);
+
+    stats->driftAdjustment = adjustment * PARTS_PER_MILLION;
+
+    stats->clockDrift = Timing_getRateError();
+
+    /* Simulation thread wakeup jitter in milliseconds and offline processing throughput in input samples per second */
+
+    pthread_mutex_lock(&simulationRunningMutex);
+
+    bool simulating = simulationRunning;
+
+    pthread_mutex_unlock(&simulationRunningMutex);
+
+    bool offline = Atomic_load32(&offlineProcessing);
+
+    stats->simulationJitterValid = simulating && offline == false;
+
+    stats->simulationJitter = (double)Atomic_load32(&simulationMeanJitter) / MICROSECONDS_IN_MILLISECOND;
+
+    stats->simulationMaximumJitter = (double)Atomic_load32(&simulationMaximumJitter) / MICROSECONDS_IN_MILLISECOND;
+
+    stats->offlineThroughputValid = simulating && offline;
+
+    stats->offlineThroughput = (double)Atomic_load32(&offlineThroughput);
+
+    stats->offlineSamplesProcessed = Atomic_load64(&offlineSamplesProcessed);
+
+    stats->estimatedLatency = capturePeriod + lag + playbackBuffer;
+
+    stats->loopbackLatency = loopbackLatency;
+
+    stats->monitorLatency = loopbackLatency >= 0.0 ? loopbackLatency + lag : -1.0;
+
+    int64_t restartLatency = Atomic_load64(&deviceRestartLatency);
+
+    stats->deviceRestartLatency = restartLatency < 0 ? -1.0 : (double)restartLatency / MICROSECONDS_IN_MILLISECOND;
+
+}
+
+bool Engine_setVirtualAudioMoth(bool connected, int32_t sampleRate) {
+
+    printf("[BACKSTAGE] setVirtualAudioMoth - %s, %d\n", connected ? "true" : "false", sampleRate);
+
+    if (virtualBackend == false) return false;
+
+    /* The background device check picks up the change as it would a real hotplug */
+
+    Atomic_store32(&virtualAudioMothSampleRate, (uint32_t)sampleRate);
+
+    Atomic_store32(&virtualAudioMothConnected, connected);
+
+    return true;
+
+}
+
+bool Engine_writePlaybackSink(char *filename) {
+
+    printf("[BACKSTAGE] writePlaybackSink - %s\n", filename);
+
+    if (virtualBackend == false) return false;
+
+    /* Copy the most recent output out of the ring in order */
+
+    static int16_t samples[SINK_BUFFER_SIZE];
+
+    pthread_mutex_lock(&sinkMutex);
+
+    int32_t numberOfSamples = (int32_t)MIN(sinkSampleCount, SINK_BUFFER_SIZE);
+
+    int32_t startIndex = (SINK_BUFFER_SIZE + sinkWriteIndex - numberOfSamples) % SINK_BUFFER_SIZE;
+
+    int32_t firstPart = MIN(numberOfSamples, SINK_BUFFER_SIZE - startIndex);
+
+    memcpy(samples, sinkBuffer + startIndex, firstPart * sizeof(int16_t));
+
+    memcpy(samples + firstPart, sinkBuffer, (numberOfSamples - firstPart) * sizeof(int16_t));
+
+    pthread_mutex_unlock(&sinkMutex);
+
+    static WAV_header_t header;
+
+    WavFile_initialiseHeader(&header);
+
+    WavFile_setHeaderDetails(&header, PLAYBACK_SAMPLE_RATE, numberOfSamples);
+
+    WavFile_setHeaderChannels(&header, PLAYBACK_NUMBER_OF_CHANNELS);
+
+    return WavFile_writeFile(&header, filename, samples, numberOfSamples, NULL, 0);
+
+}
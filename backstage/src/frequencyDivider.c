@@ -0,0 +1,155 @@
+/****************************************************************************
+ * frequencyDivider.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "frequencyDivider.h"
+
+/* Maths constants */
+
+#ifndef M_PI
+#define M_PI                            3.14159265358979323846
+#endif
+
+/* High pass filter constant to keep audible noise away from the zero-crossing detector */
+
+#define HIGH_PASS_FILTER_FREQUENCY      15000
+
+/* Zero-crossing hysteresis constant */
+
+#define HYSTERESIS_THRESHOLD            64.0f
+
+/* Envelope constants */
+
+#define ENVELOPE_DECAY_TIME             0.005
+
+/* Global state variables */
+
+static int32_t currentSampleRate;
+
+static float highPassCoefficient;
+
+static float envelopeDecay;
+
+static float previousInput;
+
+static float highPassOutput;
+
+static float envelope;
+
+static bool positive;
+
+static int32_t crossingCounter;
+
+static float outputLevel = 1.0f;
+
+static float decimationAccumulator;
+
+static int32_t decimationCounter;
+
+/* Private functions */
+
+static void updateCoefficients(int32_t sampleRate) {
+
+    double RC = 1.0 / (2.0 * M_PI * HIGH_PASS_FILTER_FREQUENCY);
+
+    double dt = 1.0 / (double)sampleRate;
+
+    highPassCoefficient = (float)(RC / (RC + dt));
+
+    envelopeDecay = (float)exp(-dt / ENVELOPE_DECAY_TIME);
+
+    currentSampleRate = sampleRate;
+
+}
+
+/* Public functions */
+
+void FrequencyDivider_initialise(void) {
+
+    currentSampleRate = 0;
+
+    previousInput = 0.0f;
+
+    highPassOutput = 0.0f;
+
+    envelope = 0.0f;
+
+    positive = false;
+
+    crossingCounter = 0;
+
+    outputLevel = 1.0f;
+
+    decimationAccumulator = 0.0f;
+
+    decimationCounter = 0;
+
+}
+
+void FrequencyDivider_processBlock(float *input, int32_t numberOfSamples, int32_t sampleRate, int32_t division, int32_t decimation, float *output) {
+
+    if (sampleRate != currentSampleRate) updateCoefficients(sampleRate);
+
+    int32_t outputIndex = 0;
+
+    for (int32_t i = 0; i < numberOfSamples; i += 1) {
+
+        /* First order high pass filter */
+
+        float sample = input[i];
+
+        highPassOutput = highPassCoefficient * (highPassOutput + sample - previousInput);
+
+        previousInput = sample;
+
+        /* Peak envelope follower */
+
+        float magnitude = fabsf(highPassOutput);
+
+        envelope = magnitude > envelope ? magnitude : envelope * envelopeDecay;
+
+        /* Count zero crossings with hysteresis and toggle the output every division crossings so the output period is division input periods */
+
+        bool crossing = positive ? highPassOutput < -HYSTERESIS_THRESHOLD : highPassOutput > HYSTERESIS_THRESHOLD;
+
+        if (crossing) {
+
+            positive = !positive;
+
+            crossingCounter += 1;
+
+            if (crossingCounter >= division) {
+
+                outputLevel = -outputLevel;
+
+                crossingCounter = 0;
+
+            }
+
+        }
+
+        /* Boxcar decimate to the output rate */
+
+        decimationAccumulator += outputLevel * envelope;
+
+        decimationCounter += 1;
+
+        if (decimationCounter >= decimation) {
+
+            output[outputIndex++] = decimationAccumulator / (float)decimationCounter;
+
+            decimationAccumulator = 0.0f;
+
+            decimationCounter = 0;
+
+        }
+
+    }
+
+}
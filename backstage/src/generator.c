@@ -0,0 +1,295 @@
+/****************************************************************************
+ * generator.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "macros.h"
+#include "generator.h"
+
+/* Maths constants */
+
+#ifndef M_PI
+#define M_PI                                3.14159265358979323846
+#endif
+
+/* Sample rate constants */
+
+#define NUMBER_OF_VALID_SAMPLE_RATES        8
+#define MINIMUM_SAMPLE_RATE                 8000
+#define MAXIMUM_SAMPLE_RATE                 384000
+
+/* Level constants */
+
+#define MAXIMUM_LEVEL                       0.0
+#define MINIMUM_LEVEL                       -120.0
+#define FULL_SCALE                          32767.0
+
+/* Chirp constant */
+
+#define CHIRP_DURATION                      1.0
+
+/* Bat call constants. Calls sweep down from the second frequency to the first */
+
+#define BAT_CALL_DURATION                   0.005
+#define BAT_CALL_INTERVAL                   0.1
+
+/* Noise constants. The seed is fixed so every run produces the same samples */
+
+#define NOISE_SEED                          0x2545F491
+#define PINK_NOISE_GAIN                     0.125
+
+/* Valid sample rates. Generated input must use one of the capture rates so the monitor resampler has a filter bank for it */
+
+static int32_t validSampleRates[NUMBER_OF_VALID_SAMPLE_RATES] = {8000, 16000, 32000, 48000, 96000, 192000, 250000, 384000};
+
+/* Signal names and default frequencies */
+
+static char *names[NUMBER_OF_GENERATOR_SIGNALS] = {"sine", "chirp", "bat-call", "white-noise", "pink-noise", "impulse"};
+
+static int32_t defaultFrequencies[NUMBER_OF_GENERATOR_SIGNALS][2] = {{10000, 0}, {1000, MAXIMUM_SAMPLE_RATE / 2}, {45000, 80000}, {0, 0}, {0, 0}, {1, 0}};
+
+/* Generator state variables */
+
+static GN_settings_t currentSettings = {GN_SINE, MINIMUM_SAMPLE_RATE, 0, 0, MAXIMUM_LEVEL, 0.0};
+
+static double amplitude;
+
+static double frequency1;
+
+static double frequency2;
+
+static int64_t periodLength;
+
+static int64_t callLength;
+
+static int64_t totalLength;
+
+static int64_t sampleIndex;
+
+static uint32_t noiseState;
+
+static double pinkState[3];
+
+/* Private functions */
+
+static double nextWhiteNoise(void) {
+
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+
+    return (double)(int32_t)noiseState / 2147483648.0;
+
+}
+
+static double nextPinkNoise(void) {
+
+    /* Three pole approximation of a 1/f spectrum */
+
+    double white = nextWhiteNoise();
+
+    pinkState[0] = 0.99765 * pinkState[0] + white * 0.0990460;
+    pinkState[1] = 0.96300 * pinkState[1] + white * 0.2965164;
+    pinkState[2] = 0.57000 * pinkState[2] + white * 1.0526913;
+
+    return PINK_NOISE_GAIN * (pinkState[0] + pinkState[1] + pinkState[2] + white * 0.1848);
+
+}
+
+static double phaseToSample(double phase) {
+
+    /* Wrap the phase in cycles before scaling so precision does not fall as the phase grows */
+
+    return sin(2.0 * M_PI * (phase - floor(phase)));
+
+}
+
+static double nextSample(void) {
+
+    int32_t sampleRate = currentSettings.sampleRate;
+
+    switch (currentSettings.signal) {
+
+    case GN_SINE: {
+
+        /* Integer frequencies give an exact phase from the sample index */
+
+        int64_t cycles = ((int64_t)frequency1 * sampleIndex) % sampleRate;
+
+        return phaseToSample((double)cycles / (double)sampleRate);
+
+    }
+
+    case GN_CHIRP: {
+
+        double time = (double)(sampleIndex % periodLength) / (double)sampleRate;
+
+        return phaseToSample(frequency1 * time + (frequency2 - frequency1) * time * time / (2.0 * CHIRP_DURATION));
+
+    }
+
+    case GN_BAT_CALL: {
+
+        int64_t position = sampleIndex % periodLength;
+
+        if (position >= callLength) return 0.0;
+
+        /* Exponential sweep from the start frequency to the end frequency under a Hann envelope */
+
+        double time = (double)position / (double)sampleRate;
+
+        double rate = log(frequency1 / frequency2) / BAT_CALL_DURATION;
+
+        double phase = rate == 0.0 ? frequency2 * time : frequency2 * (exp(rate * time) - 1.0) / rate;
+
+        double envelope = 0.5 * (1.0 - cos(2.0 * M_PI * (double)position / (double)callLength));
+
+        return envelope * phaseToSample(phase);
+
+    }
+
+    case GN_WHITE_NOISE:
+
+        return nextWhiteNoise();
+
+    case GN_PINK_NOISE:
+
+        return nextPinkNoise();
+
+    case GN_IMPULSE:
+
+        return sampleIndex % periodLength == 0 ? 1.0 : 0.0;
+
+    default:
+
+        return 0.0;
+
+    }
+
+}
+
+/* Public functions */
+
+char* Generator_getName(int32_t signal) {
+
+    return signal >= 0 && signal < NUMBER_OF_GENERATOR_SIGNALS ? names[signal] : "";
+
+}
+
+bool Generator_findSignal(char *name, int32_t *signal) {
+
+    for (int32_t i = 0; i < NUMBER_OF_GENERATOR_SIGNALS; i += 1) {
+
+        if (strcmp(names[i], name) == 0) {
+
+            *signal = i;
+
+            return true;
+
+        }
+
+    }
+
+    return false;
+
+}
+
+bool Generator_isValid(GN_settings_t *settings) {
+
+    bool valid = settings->signal >= 0 && settings->signal < NUMBER_OF_GENERATOR_SIGNALS;
+
+    bool validSampleRate = false;
+
+    for (int32_t i = 0; i < NUMBER_OF_VALID_SAMPLE_RATES; i += 1) validSampleRate |= settings->sampleRate == validSampleRates[i];
+
+    valid &= validSampleRate;
+
+    valid &= settings->frequency1 >= 0 && settings->frequency2 >= 0 && settings->duration >= 0.0;
+
+    return valid;
+
+}
+
+void Generator_configure(GN_settings_t *settings) {
+
+    currentSettings = *settings;
+
+    int32_t sampleRate = currentSettings.sampleRate;
+
+    int32_t signal = currentSettings.signal;
+
+    /* Fill in the default frequencies and keep tones below the Nyquist frequency */
+
+    int32_t requestedFrequency1 = currentSettings.frequency1 > 0 ? currentSettings.frequency1 : defaultFrequencies[signal][0];
+
+    int32_t requestedFrequency2 = currentSettings.frequency2 > 0 ? currentSettings.frequency2 : defaultFrequencies[signal][1];
+
+    frequency1 = MAX(1, MIN(requestedFrequency1, sampleRate / 2));
+
+    frequency2 = MAX(1, MIN(requestedFrequency2, sampleRate / 2));
+
+    double level = MAX(MINIMUM_LEVEL, MIN(MAXIMUM_LEVEL, currentSettings.level));
+
+    amplitude = FULL_SCALE * pow(10.0, level / 20.0);
+
+    /* Lengths of the repeating parts of each signal in samples */
+
+    if (signal == GN_CHIRP) periodLength = (int64_t)round(CHIRP_DURATION * sampleRate);
+
+    if (signal == GN_BAT_CALL) periodLength = (int64_t)round(BAT_CALL_INTERVAL * sampleRate);
+
+    if (signal == GN_IMPULSE) periodLength = MAX(1, (int64_t)round((double)sampleRate / frequency1));
+
+    callLength = MAX(1, (int64_t)round(BAT_CALL_DURATION * sampleRate));
+
+    totalLength = (int64_t)round(currentSettings.duration * sampleRate);
+
+    Generator_restart();
+
+}
+
+void Generator_restart(void) {
+
+    sampleIndex = 0;
+
+    noiseState = NOISE_SEED;
+
+    memset(pinkState, 0, sizeof(pinkState));
+
+}
+
+int32_t Generator_getSampleRate(void) {
+
+    return currentSettings.sampleRate;
+
+}
+
+bool Generator_isFinished(void) {
+
+    return totalLength > 0 && sampleIndex >= totalLength;
+
+}
+
+int32_t Generator_read(int16_t *destination, int32_t numberOfFrames) {
+
+    if (totalLength > 0) numberOfFrames = (int32_t)MAX(0, MIN((int64_t)numberOfFrames, totalLength - sampleIndex));
+
+    for (int32_t i = 0; i < numberOfFrames; i += 1) {
+
+        double sample = round(amplitude * nextSample());
+
+        destination[i] = (int16_t)MAX(-FULL_SCALE - 1.0, MIN(FULL_SCALE, sample));
+
+        sampleIndex += 1;
+
+    }
+
+    return numberOfFrames;
+
+}
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 
 #include "biquad.h"
+#include "macros.h"
 #include "heterodyne.h"
 
 /* Maths constants */
@@ -17,10 +18,15 @@
 #define M_PI            3.14159265358979323846
 #endif
 
-/* Low pass filter constant */
+/* Low pass filter constants. The cutoff is kept below the Nyquist frequency of low sample rates which are not decimated */
 
 #define LOW_PASS_FILTER_FREQUENCY       5000
 #define LOW_PASS_FILTER_BANDWIDTH       1.0
+#define LOW_PASS_FILTER_MAXIMUM_RATIO   0.4
+
+/* Block oscillator constant */
+
+#define NUMBER_OF_LANES                 8
 
 /* Global state variable */
 
@@ -34,27 +40,211 @@ static double waveY = 0.0;
 static double dX;
 static double dY;
 
+/* Block state variables */
+
+static int32_t blockSampleRate;
+
+static int32_t blockNumberOfChannels = 1;
+
+static int32_t blockFrequencies[HETERODYNE_MAXIMUM_CHANNELS];
+
+static int32_t blockDecimation;
+
+static int32_t blockOutputRate;
+
+static volatile bool blockUpdateRequired = true;
+
+static float laneX[HETERODYNE_MAXIMUM_CHANNELS][NUMBER_OF_LANES];
+static float laneY[HETERODYNE_MAXIMUM_CHANNELS][NUMBER_OF_LANES];
+
+static float stepX[HETERODYNE_MAXIMUM_CHANNELS][NUMBER_OF_LANES + 1];
+static float stepY[HETERODYNE_MAXIMUM_CHANNELS][NUMBER_OF_LANES + 1];
+
+static float decimationAccumulator[HETERODYNE_MAXIMUM_CHANNELS];
+static float decimationCarry[HETERODYNE_MAXIMUM_CHANNELS];
+
+static int32_t decimationCounter;
+
+/* Output rate low pass filter state stored across channels so each filter step vectorises over the bank */
+
+static float filterB0, filterB1, filterB2, filterA1, filterA2;
+
+static float filterX1[HETERODYNE_MAXIMUM_CHANNELS];
+static float filterX2[HETERODYNE_MAXIMUM_CHANNELS];
+static float filterY1[HETERODYNE_MAXIMUM_CHANNELS];
+static float filterY2[HETERODYNE_MAXIMUM_CHANNELS];
+
+/* Private functions */
+
+static void designLowPassFilter(BQ_filterCoefficients_t *coefficients, int32_t sampleRate) {
+
+    int32_t frequency = MIN(LOW_PASS_FILTER_FREQUENCY, (int32_t)(LOW_PASS_FILTER_MAXIMUM_RATIO * sampleRate));
+
+    Biquad_designLowPassFilter(coefficients, sampleRate, frequency, LOW_PASS_FILTER_BANDWIDTH);
+
+}
+
+static void updateBlockOscillators(int32_t decimation) {
+
+    for (int32_t c = 0; c < blockNumberOfChannels; c += 1) {
+
+        double angle = 2.0 * M_PI * (double)blockFrequencies[c] / (double)blockSampleRate;
+
+        /* Each lane runs the oscillator offset by one sample and steps by the lane count */
+
+        double phase = laneX[c][0] == 0.0f && laneY[c][0] == 0.0f ? 0.0 : atan2(laneY[c][0], laneX[c][0]);
+
+        for (int32_t i = 0; i < NUMBER_OF_LANES; i += 1) {
+
+            laneX[c][i] = (float)cos(phase + angle * i);
+            laneY[c][i] = (float)sin(phase + angle * i);
+
+        }
+
+        for (int32_t i = 0; i <= NUMBER_OF_LANES; i += 1) {
+
+            stepX[c][i] = (float)cos(angle * i);
+            stepY[c][i] = (float)sin(angle * i);
+
+        }
+
+    }
+
+    /* The low pass filters run after decimation so are redesigned whenever the output rate changes */
+
+    int32_t outputRate = blockSampleRate / decimation;
+
+    if (decimation != blockDecimation || outputRate != blockOutputRate) {
+
+        BQ_filterCoefficients_t coefficients;
+
+        designLowPassFilter(&coefficients, outputRate);
+
+        filterB0 = (float)coefficients.B0_A0;
+        filterB1 = (float)coefficients.B1_A0;
+        filterB2 = (float)coefficients.B2_A0;
+        filterA1 = (float)coefficients.A1_A0;
+        filterA2 = (float)coefficients.A2_A0;
+
+        for (int32_t c = 0; c < HETERODYNE_MAXIMUM_CHANNELS; c += 1) {
+
+            filterX1[c] = filterX2[c] = filterY1[c] = filterY2[c] = 0.0f;
+
+            decimationAccumulator[c] = decimationCarry[c] = 0.0f;
+
+        }
+
+        decimationCounter = 0;
+
+        blockDecimation = decimation;
+
+        blockOutputRate = outputRate;
+
+    }
+
+}
+
+static inline void advanceLanes(int32_t channel, int32_t steps) {
+
+    const float sX = stepX[channel][steps];
+    const float sY = stepY[channel][steps];
+
+    float *x = laneX[channel];
+    float *y = laneY[channel];
+
+    for (int32_t i = 0; i < NUMBER_OF_LANES; i += 1) {
+
+        float newX = sX * x[i] - sY * y[i];
+        float newY = sX * y[i] + sY * x[i];
+
+        x[i] = newX;
+        y[i] = newY;
+
+    }
+
+}
+
+static void normaliseLanes(void) {
+
+    for (int32_t c = 0; c < blockNumberOfChannels; c += 1) {
+
+        for (int32_t i = 0; i < NUMBER_OF_LANES; i += 1) {
+
+            float correction = 1.0f - (laneX[c][i] * laneX[c][i] + laneY[c][i] * laneY[c][i] - 1.0f) / 2.0f;
+
+            laneX[c][i] *= correction;
+            laneY[c][i] *= correction;
+
+        }
+
+    }
+
+}
+
+static inline void applyFilters(float *output) {
+
+    /* The triangular decimation weights sum to the square of the decimation factor */
+
+    const float scale = 1.0f / ((float)blockDecimation * (float)blockDecimation);
+
+    for (int32_t c = 0; c < HETERODYNE_MAXIMUM_CHANNELS; c += 1) {
+
+        float x = decimationAccumulator[c] * scale;
+
+        float y = filterB0 * x + filterB1 * filterX1[c] + filterB2 * filterX2[c] - filterA1 * filterY1[c] - filterA2 * filterY2[c];
+
+        filterX2[c] = filterX1[c];
+        filterX1[c] = x;
+
+        filterY2[c] = filterY1[c];
+        filterY1[c] = y;
+
+        decimationAccumulator[c] = decimationCarry[c];
+
+        decimationCarry[c] = 0.0f;
+
+    }
+
+    for (int32_t c = 0; c < blockNumberOfChannels; c += 1) output[c] = filterY1[c];
+
+}
+
 /* Public functions */
 
 void Heterodyne_initialise(int32_t sampleRate, int32_t frequency) {
 
     Heterodyne_updateFrequencies(sampleRate, frequency);
 
-    Biquad_designLowPassFilter(&lowPassFilterCoefficients, sampleRate, LOW_PASS_FILTER_FREQUENCY, LOW_PASS_FILTER_BANDWIDTH);
+    designLowPassFilter(&lowPassFilterCoefficients, sampleRate);
 
     Biquad_initialise(&lowPassFilter);
+
     
 }
 
 void Heterodyne_updateFrequencies(int32_t sampleRate, int32_t frequency) {
 
-    Biquad_designLowPassFilter(&lowPassFilterCoefficients, sampleRate, LOW_PASS_FILTER_FREQUENCY, LOW_PASS_FILTER_BANDWIDTH);
+    designLowPassFilter(&lowPassFilterCoefficients, sampleRate);
 
     double angle = 2.0 * M_PI * (double)frequency / (double)sampleRate;
     
     dX = cos(angle);
     dY = sin(angle);
 
+    Heterodyne_updateChannels(sampleRate, 1, &frequency);
+
+}
+
+void Heterodyne_updateChannels(int32_t sampleRate, int32_t numberOfChannels, int32_t *frequencies) {
+
+    blockSampleRate = sampleRate;
+
+    blockNumberOfChannels = MAX(1, MIN(HETERODYNE_MAXIMUM_CHANNELS, numberOfChannels));
+
+    for (int32_t c = 0; c < blockNumberOfChannels; c += 1) blockFrequencies[c] = frequencies[c];
+
+    blockUpdateRequired = true;
+
 }
 
 double Heterodyne_nextOutput(double sample) {
@@ -82,6 +272,68 @@ void Heterodyne_normalise(void) {
 
 }
 
+void Heterodyne_processBlock(float *input, int32_t numberOfSamples, int32_t decimation, float *output) {
 
+    static float mixerOutput[HETERODYNE_MAXIMUM_CHANNELS][NUMBER_OF_LANES];
 
+    if (blockUpdateRequired || decimation != blockDecimation) {
 
+        blockUpdateRequired = false;
+
+        updateBlockOscillators(decimation);
+
+    }
+
+    normaliseLanes();
+
+    const int32_t numberOfChannels = blockNumberOfChannels;
+
+    int32_t outputIndex = 0;
+
+    for (int32_t i = 0; i < numberOfSamples; i += NUMBER_OF_LANES) {
+
+        int32_t count = MIN(NUMBER_OF_LANES, numberOfSamples - i);
+
+        /* Mix a full set of lanes at once for each channel in the bank */
+
+        for (int32_t c = 0; c < numberOfChannels; c += 1) {
+
+            for (int32_t j = 0; j < NUMBER_OF_LANES; j += 1) mixerOutput[c][j] = (j < count ? input[i + j] : 0.0f) * laneX[c][j];
+
+            advanceLanes(c, count);
+
+        }
+
+        /* Second order CIC decimate before applying the low pass filters at the output rate. The triangular window spans two output periods so each sample is split between the current and next output */
+
+        for (int32_t j = 0; j < count; j += 1) {
+
+            const float weightCurrent = (float)(decimation - decimationCounter);
+
+            const float weightNext = (float)decimationCounter;
+
+            for (int32_t c = 0; c < numberOfChannels; c += 1) {
+
+                decimationAccumulator[c] += weightCurrent * mixerOutput[c][j];
+
+                decimationCarry[c] += weightNext * mixerOutput[c][j];
+
+            }
+
+            decimationCounter += 1;
+
+            if (decimationCounter == decimation) {
+
+                applyFilters(output + outputIndex * numberOfChannels);
+
+                outputIndex += 1;
+
+                decimationCounter = 0;
+
+            }
+
+        }
+
+    }
+
+}
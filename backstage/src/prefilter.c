@@ -0,0 +1,199 @@
+/****************************************************************************
+ * prefilter.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "macros.h"
+#include "biquad.h"
+#include "threads.h"
+#include "prefilter.h"
+
+/* Maths constants */
+
+#ifndef M_PI
+#define M_PI                            3.14159265358979323846
+#endif
+
+/* Section quality factors of a fourth order Butterworth response */
+
+#define BUTTERWORTH_Q1                  0.54119610014619698
+#define BUTTERWORTH_Q2                  1.30656296487637652
+
+/* Prefilter settings */
+
+typedef struct {
+    int32_t type;
+    int32_t frequency1;
+    int32_t frequency2;
+} PF_settings_t;
+
+/* Settings are written by the frontend and read by the capture path under a sequence lock */
+
+static volatile uint32_t settingsSequence;
+
+static PF_settings_t sharedSettings;
+
+/* Filter state variables */
+
+static BQ_cascade_t cascade;
+
+static uint32_t sequenceInUse;
+
+static int32_t sampleRateInUse;
+
+/* Private functions */
+
+static void copySettings(PF_settings_t *copy) {
+
+    uint32_t sequence;
+
+    do {
+
+        sequence = Atomic_load32(&settingsSequence);
+
+        *copy = sharedSettings;
+
+        Atomic_acquireFence();
+
+    } while ((sequence & 1) || sequence != Atomic_load32(&settingsSequence));
+
+}
+
+static double bandwidthFromQ(double Q, int32_t sampleRate, int32_t frequency) {
+
+    /* Invert the bandwidth to alpha relationship used by the biquad design functions */
+
+    double omega = 2.0 * M_PI * (double)frequency / (double)sampleRate;
+
+    return 2.0 / log(2.0) * asinh(1.0 / (2.0 * Q)) * sin(omega) / omega;
+
+}
+
+static void designCascade(PF_settings_t *settings, int32_t sampleRate) {
+
+    Biquad_initialiseCascade(&cascade);
+
+    BQ_filterCoefficients_t coefficients;
+
+    int32_t nyquistFrequency = sampleRate / 2;
+
+    int32_t frequency1 = MIN(settings->frequency1, settings->frequency2);
+
+    int32_t frequency2 = MAX(settings->frequency1, settings->frequency2);
+
+    /* Filters with edges outside the current band are bypassed */
+
+    if (settings->type == PF_LOW_PASS || settings->type == PF_HIGH_PASS) {
+
+        int32_t frequency = settings->frequency1;
+
+        if (frequency <= 0 || frequency >= nyquistFrequency) return;
+
+        double Q[2] = {BUTTERWORTH_Q1, BUTTERWORTH_Q2};
+
+        for (int32_t i = 0; i < 2; i += 1) {
+
+            double bandwidth = bandwidthFromQ(Q[i], sampleRate, frequency);
+
+            if (settings->type == PF_LOW_PASS) {
+
+                Biquad_designLowPassFilter(&coefficients, sampleRate, frequency, bandwidth);
+
+            } else {
+
+                Biquad_designHighPassFilter(&coefficients, sampleRate, frequency, bandwidth);
+
+            }
+
+            Biquad_addSection(&cascade, &coefficients);
+
+        }
+
+    } else if (settings->type == PF_BAND_PASS || settings->type == PF_NOTCH) {
+
+        if (frequency1 <= 0 || frequency1 == frequency2 || frequency2 >= nyquistFrequency) return;
+
+        if (settings->type == PF_BAND_PASS) {
+
+            Biquad_designBandPassFilter(&coefficients, sampleRate, frequency1, frequency2);
+
+        } else {
+
+            Biquad_designNotchFilter(&coefficients, sampleRate, frequency1, frequency2);
+
+        }
+
+        Biquad_addSection(&cascade, &coefficients);
+
+    }
+
+}
+
+/* Public functions */
+
+void Prefilter_initialise(void) {
+
+    Atomic_store32(&settingsSequence, 0);
+
+    sharedSettings.type = PF_NONE;
+
+    sequenceInUse = 0;
+
+    sampleRateInUse = 0;
+
+    Biquad_initialiseCascade(&cascade);
+
+}
+
+void Prefilter_configure(int32_t type, int32_t frequency1, int32_t frequency2) {
+
+    uint32_t sequence = Atomic_load32(&settingsSequence);
+
+    Atomic_store32(&settingsSequence, sequence + 1);
+
+    Atomic_releaseFence();
+
+    sharedSettings.type = type;
+    sharedSettings.frequency1 = MAX(0, frequency1);
+    sharedSettings.frequency2 = MAX(0, frequency2);
+
+    Atomic_store32(&settingsSequence, sequence + 2);
+
+}
+
+void Prefilter_reset(void) {
+
+    Biquad_resetCascade(&cascade);
+
+}
+
+void Prefilter_processBlock(int16_t *samples, int32_t numberOfSamples, int32_t sampleRate) {
+
+    /* Redesign the cascade when the settings or the sample rate change */
+
+    uint32_t sequence = Atomic_load32(&settingsSequence);
+
+    if (sequence != sequenceInUse || sampleRate != sampleRateInUse) {
+
+        PF_settings_t settings;
+
+        copySettings(&settings);
+
+        designCascade(&settings, sampleRate);
+
+        sequenceInUse = sequence;
+
+        sampleRateInUse = sampleRate;
+
+    }
+
+    if (cascade.numberOfSections == 0) return;
+
+    Biquad_applyCascadeInt16(&cascade, samples, numberOfSamples, samples);
+
+}
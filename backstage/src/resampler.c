@@ -0,0 +1,492 @@
+/****************************************************************************
+ * resampler.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "macros.h"
+#include "resampler.h"
+
+/* Maths constants */
+
+#ifndef M_PI
+#define M_PI                            3.14159265358979323846
+#endif
+
+/* Filter design constants */
+
+#define TAPS_PER_ZERO_CROSSING          32
+#define CUTOFF_FRACTION                 0.85
+
+/* Independent partial sums let the dot product vectorise without reassociating floats. The number of taps is always a multiple of this */
+
+#define NUMBER_OF_PARTIAL_SUMS          8
+
+/* Every bank has at least this many phases so the ratio can be trimmed in steps of a fraction of an input sample */
+
+#define MINIMUM_NUMBER_OF_PHASES        64
+
+/* Filter bank storage constants */
+
+#define MAXIMUM_NUMBER_OF_BANKS         32
+#define BANK_POOL_SIZE                  131072
+
+/* Filter bank structure */
+
+typedef struct {
+    int32_t inputSampleRate;
+    int32_t outputSampleRate;
+    int32_t upsample;
+    int32_t downsample;
+    int32_t numberOfTaps;
+    const float *bank;
+} RS_filterBank_t;
+
+/* Filter bank state variables */
+
+static float bankPool[BANK_POOL_SIZE];
+
+static int32_t bankPoolIndex;
+
+static RS_filterBank_t filterBanks[MAXIMUM_NUMBER_OF_BANKS];
+
+static int32_t numberOfFilterBanks;
+
+/* Private functions */
+
+static int32_t greatestCommonDivisor(int32_t a, int32_t b) {
+
+    while (b != 0) {
+
+        int32_t remainder = a % b;
+
+        a = b;
+
+        b = remainder;
+
+    }
+
+    return a;
+
+}
+
+static bool designFilterBank(RS_filterBank_t *filterBank, int32_t inputSampleRate, int32_t outputSampleRate) {
+
+    int32_t divisor = greatestCommonDivisor(inputSampleRate, outputSampleRate);
+
+    int32_t upsample = outputSampleRate / divisor;
+
+    int32_t downsample = inputSampleRate / divisor;
+
+    /* The number of taps per phase grows with the decimation ratio so the transition band stays fixed at the output rate */
+
+    int32_t ratio = (downsample + upsample - 1) / upsample;
+
+    int32_t oversample = (MINIMUM_NUMBER_OF_PHASES + upsample - 1) / upsample;
+
+    upsample *= oversample;
+
+    downsample *= oversample;
+
+    int32_t numberOfTaps = MIN(MAXIMUM_NUMBER_OF_RESAMPLER_TAPS, TAPS_PER_ZERO_CROSSING * MAX(1, ratio));
+
+    int32_t length = upsample * numberOfTaps;
+
+    if (bankPoolIndex + length > BANK_POOL_SIZE) return false;
+
+    float *bank = bankPool + bankPoolIndex;
+
+    /* Windowed sinc prototype at the upsampled rate */
+
+    double cutoff = CUTOFF_FRACTION * (double)MIN(inputSampleRate, outputSampleRate) / 2.0 / ((double)upsample * (double)inputSampleRate);
+
+    double centre = (double)(length - 1) / 2.0;
+
+    for (int32_t n = 0; n < length; n += 1) {
+
+        double x = (double)n - centre;
+
+        double sinc = x == 0.0 ? 1.0 : sin(2.0 * M_PI * cutoff * x) / (2.0 * M_PI * cutoff * x);
+
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * n / (length - 1)) + 0.08 * cos(4.0 * M_PI * n / (length - 1));
+
+        double coefficient = 2.0 * cutoff * (double)upsample * sinc * window;
+
+        /* Store each phase contiguously and reversed so the dot product runs forward through the history */
+
+        int32_t phase = n % upsample;
+
+        int32_t tap = n / upsample;
+
+        bank[phase * numberOfTaps + numberOfTaps - 1 - tap] = (float)coefficient;
+
+    }
+
+    bankPoolIndex += length;
+
+    filterBank->inputSampleRate = inputSampleRate;
+    filterBank->outputSampleRate = outputSampleRate;
+    filterBank->upsample = upsample;
+    filterBank->downsample = downsample;
+    filterBank->numberOfTaps = numberOfTaps;
+    filterBank->bank = bank;
+
+    return true;
+
+}
+
+static inline int32_t nextPosition(RS_resampler_t *resampler, int32_t position, double *fraction) {
+
+    position += resampler->downsample;
+
+    /* Accumulate the ratio adjustment and apply it in whole phases */
+
+    *fraction += resampler->adjustment * (double)resampler->downsample;
+
+    while (*fraction >= 1.0) {
+
+        position += 1;
+
+        *fraction -= 1.0;
+
+    }
+
+    while (*fraction <= -1.0) {
+
+        position -= 1;
+
+        *fraction += 1.0;
+
+    }
+
+    return position;
+
+}
+
+static RS_filterBank_t *findFilterBank(int32_t inputSampleRate, int32_t outputSampleRate) {
+
+    for (int32_t i = 0; i < numberOfFilterBanks; i += 1) {
+
+        RS_filterBank_t *filterBank = &filterBanks[i];
+
+        if (filterBank->inputSampleRate == inputSampleRate && filterBank->outputSampleRate == outputSampleRate) return filterBank;
+
+    }
+
+    return NULL;
+
+}
+
+/* Public functions */
+
+bool Resampler_designFilterBanks(int32_t *inputSampleRates, int32_t numberOfInputSampleRates, int32_t outputSampleRate) {
+
+    bankPoolIndex = 0;
+
+    numberOfFilterBanks = 0;
+
+    for (int32_t i = 0; i < numberOfInputSampleRates; i += 1) {
+
+        if (findFilterBank(inputSampleRates[i], outputSampleRate)) continue;
+
+        if (numberOfFilterBanks == MAXIMUM_NUMBER_OF_BANKS) return false;
+
+        if (!designFilterBank(&filterBanks[numberOfFilterBanks], inputSampleRates[i], outputSampleRate)) return false;
+
+        numberOfFilterBanks += 1;
+
+    }
+
+    return true;
+
+}
+
+bool Resampler_initialise(RS_resampler_t *resampler, int32_t inputSampleRate, int32_t outputSampleRate, bool adjustable) {
+
+    resampler->inputSampleRate = inputSampleRate;
+    resampler->outputSampleRate = outputSampleRate;
+
+    resampler->upsample = 1;
+    resampler->downsample = 1;
+    resampler->numberOfTaps = 0;
+    resampler->bank = NULL;
+
+    resampler->historyIndex = 0;
+
+    resampler->adjustment = 0.0;
+
+    resampler->fraction = 0.0;
+
+    memset(resampler->history, 0, sizeof(resampler->history));
+
+    /* Identity resampler needs no filter bank unless the ratio will be trimmed */
+
+    if (inputSampleRate == outputSampleRate && adjustable == false) {
+
+        resampler->position = 0;
+
+        return true;
+
+    }
+
+    RS_filterBank_t *filterBank = findFilterBank(inputSampleRate, outputSampleRate);
+
+    if (filterBank == NULL) return false;
+
+    resampler->upsample = filterBank->upsample;
+    resampler->downsample = filterBank->downsample;
+    resampler->numberOfTaps = filterBank->numberOfTaps;
+    resampler->bank = filterBank->bank;
+
+    /* Start with one input sample pending so the first output is aligned with the first input */
+
+    resampler->position = resampler->upsample;
+
+    return true;
+
+}
+
+int32_t Resampler_getNumberOfInputSamples(RS_resampler_t *resampler, int32_t numberOfOutputSamples) {
+
+    if (resampler->bank == NULL) return numberOfOutputSamples;
+
+    if (numberOfOutputSamples == 0) return 0;
+
+    if (resampler->adjustment == 0.0) {
+
+        int64_t position = (int64_t)resampler->position + (int64_t)(numberOfOutputSamples - 1) * resampler->downsample;
+
+        return (int32_t)(position / resampler->upsample);
+
+    }
+
+    /* Step through the positions exactly as the process function will */
+
+    int32_t position = resampler->position;
+
+    double fraction = resampler->fraction;
+
+    int32_t numberOfInputSamples = 0;
+
+    for (int32_t i = 0; i < numberOfOutputSamples; i += 1) {
+
+        while (position >= resampler->upsample) {
+
+            numberOfInputSamples += 1;
+
+            position -= resampler->upsample;
+
+        }
+
+        if (i < numberOfOutputSamples - 1) position = nextPosition(resampler, position, &fraction);
+
+    }
+
+    return numberOfInputSamples;
+
+}
+
+void Resampler_setAdjustment(RS_resampler_t *resampler, double adjustment) {
+
+    resampler->adjustment = adjustment;
+
+}
+
+void Resampler_process(RS_resampler_t *resampler, const float *input, int32_t numberOfOutputSamples, float *output) {
+
+    /* Identity fast path */
+
+    if (resampler->bank == NULL) {
+
+        memcpy(output, input, numberOfOutputSamples * sizeof(float));
+
+        return;
+
+    }
+
+    const int32_t numberOfTaps = resampler->numberOfTaps;
+
+    const int32_t upsample = resampler->upsample;
+
+    int32_t position = resampler->position;
+
+    int32_t historyIndex = resampler->historyIndex;
+
+    double fraction = resampler->fraction;
+
+    float *history = resampler->history;
+
+    int32_t inputIndex = 0;
+
+    for (int32_t i = 0; i < numberOfOutputSamples; i += 1) {
+
+        /* Push input samples into the doubled history so the window is always contiguous */
+
+        while (position >= upsample) {
+
+            float sample = input[inputIndex++];
+
+            history[historyIndex] = sample;
+
+            history[historyIndex + numberOfTaps] = sample;
+
+            historyIndex = historyIndex + 1 == numberOfTaps ? 0 : historyIndex + 1;
+
+            position -= upsample;
+
+        }
+
+        /* Apply the filter phase for this output sample */
+
+        const float *coefficients = resampler->bank + position * numberOfTaps;
+
+        const float *window = history + historyIndex;
+
+        float partial[NUMBER_OF_PARTIAL_SUMS] = {0};
+
+        for (int32_t j = 0; j < numberOfTaps; j += NUMBER_OF_PARTIAL_SUMS) {
+
+            for (int32_t k = 0; k < NUMBER_OF_PARTIAL_SUMS; k += 1) partial[k] += coefficients[j + k] * window[j + k];
+
+        }
+
+        float accumulator = 0.0f;
+
+        for (int32_t k = 0; k < NUMBER_OF_PARTIAL_SUMS; k += 1) accumulator += partial[k];
+
+        output[i] = accumulator;
+
+        position = nextPosition(resampler, position, &fraction);
+
+    }
+
+    resampler->position = position;
+
+    resampler->fraction = fraction;
+
+    resampler->historyIndex = historyIndex;
+
+}
+
+void Resampler_initialiseCapture(RS_captureResampler_t *resampler, int32_t inputSampleRate, int32_t outputSampleRate) {
+
+    resampler->counter = 0;
+
+    resampler->currentSample = 0.0;
+
+    resampler->nextSample = 0.0;
+
+    resampler->accumulator = 0.0;
+
+    /* Start with an input sample pending so the first interpolated sample is taken at the first input */
+
+    resampler->position = 1.0;
+
+    resampler->advancePending = false;
+
+    Resampler_setCaptureSampleRates(resampler, inputSampleRate, outputSampleRate);
+
+}
+
+void Resampler_setCaptureSampleRates(RS_captureResampler_t *resampler, int32_t inputSampleRate, int32_t outputSampleRate) {
+
+    resampler->divider = MAX(1, inputSampleRate / outputSampleRate);
+
+    resampler->step = (double)inputSampleRate / (double)(resampler->divider * outputSampleRate);
+
+}
+
+int32_t Resampler_processCapture(RS_captureResampler_t *resampler, const int16_t *input, int32_t numberOfInputSamples, int32_t maximumNumberOfOutputSamples, int16_t *output, int32_t *numberOfInputSamplesUsed) {
+
+    const int32_t divider = resampler->divider;
+
+    const double step = resampler->step;
+
+    int32_t counter = resampler->counter;
+
+    double position = resampler->position;
+
+    double currentSample = resampler->currentSample;
+
+    double nextSample = resampler->nextSample;
+
+    double accumulator = resampler->accumulator;
+
+    bool advancePending = resampler->advancePending;
+
+    int32_t inputIndex = 0;
+
+    int32_t outputIndex = 0;
+
+    /* Stop early at the output limit so the caller can act on block boundaries. The step after the last output is deferred so a new rate set in between takes effect from there */
+
+    while (outputIndex < maximumNumberOfOutputSamples) {
+
+        if (advancePending) {
+
+            position += step;
+
+            advancePending = false;
+
+        }
+
+        if (position >= 1.0) {
+
+            if (inputIndex == numberOfInputSamples) break;
+
+            currentSample = nextSample;
+
+            nextSample = input[inputIndex];
+
+            inputIndex += 1;
+
+            position -= 1.0;
+
+            continue;
+
+        }
+
+        accumulator += currentSample + position * (nextSample - currentSample);
+
+        counter += 1;
+
+        advancePending = true;
+
+        if (counter == divider) {
+
+            double sample = MAX(INT16_MIN, MIN(INT16_MAX, round(accumulator / (double)divider)));
+
+            output[outputIndex] = (int16_t)sample;
+
+            outputIndex += 1;
+
+            accumulator = 0.0;
+
+            counter = 0;
+
+        }
+
+    }
+
+    resampler->counter = counter;
+
+    resampler->position = position;
+
+    resampler->currentSample = currentSample;
+
+    resampler->nextSample = nextSample;
+
+    resampler->accumulator = accumulator;
+
+    resampler->advancePending = advancePending;
+
+    *numberOfInputSamplesUsed = inputIndex;
+
+    return outputIndex;
+
+}
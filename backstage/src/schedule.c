@@ -0,0 +1,226 @@
+/****************************************************************************
+ * schedule.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "macros.h"
+#include "threads.h"
+#include "schedule.h"
+
+/* Time constants */
+
+#define SECONDS_IN_MINUTE               60
+#define MINUTES_IN_DAY                  1440
+#define SECONDS_IN_DAY                  (SECONDS_IN_MINUTE * MINUTES_IN_DAY)
+
+/* Schedule modes */
+
+typedef enum {SC_OFF, SC_DUTY_CYCLE, SC_WINDOWS} SC_mode_t;
+
+/* Global schedule variables */
+
+static SC_mode_t mode;
+
+static int32_t recordDuration;
+
+static int32_t period;
+
+static int32_t numberOfWindows;
+
+static int32_t windowStartTimes[MAXIMUM_NUMBER_OF_WINDOWS];
+
+static int32_t windowStopTimes[MAXIMUM_NUMBER_OF_WINDOWS];
+
+static pthread_mutex_t scheduleMutex;
+
+/* Private functions */
+
+static int32_t positiveModulo(int64_t value, int32_t divisor) {
+
+    int32_t result = (int32_t)(value % divisor);
+
+    return result < 0 ? result + divisor : result;
+
+}
+
+static bool isInWindow(int32_t secondOfDay, int32_t start, int32_t stop) {
+
+    if (start <= stop) return secondOfDay >= start && secondOfDay < stop;
+
+    return secondOfDay >= start || secondOfDay < stop;
+
+}
+
+static bool isActive(int64_t time) {
+
+    if (mode == SC_DUTY_CYCLE) return positiveModulo(time, period) < recordDuration;
+
+    if (mode == SC_WINDOWS) {
+
+        int32_t secondOfDay = positiveModulo(time, SECONDS_IN_DAY);
+
+        for (int32_t i = 0; i < numberOfWindows; i += 1) {
+
+            if (isInWindow(secondOfDay, windowStartTimes[i], windowStopTimes[i])) return true;
+
+        }
+
+        return false;
+
+    }
+
+    return true;
+
+}
+
+static int64_t getSecondsUntilTransition(int64_t time) {
+
+    if (mode == SC_DUTY_CYCLE) {
+
+        int32_t position = positiveModulo(time, period);
+
+        return position < recordDuration ? recordDuration - position : period - position;
+
+    }
+
+    if (mode == SC_WINDOWS && numberOfWindows > 0) {
+
+        /* The next transition is the nearest window edge where the state changes */
+
+        int32_t secondOfDay = positiveModulo(time, SECONDS_IN_DAY);
+
+        bool active = isActive(time);
+
+        int64_t minimum = INT64_MAX;
+
+        for (int32_t i = 0; i < numberOfWindows; i += 1) {
+
+            int32_t edges[2] = {windowStartTimes[i], windowStopTimes[i]};
+
+            for (int32_t j = 0; j < 2; j += 1) {
+
+                int32_t difference = positiveModulo(edges[j] - secondOfDay, SECONDS_IN_DAY);
+
+                if (difference == 0) difference = SECONDS_IN_DAY;
+
+                if (difference < minimum && isActive(time + difference) != active) minimum = difference;
+
+            }
+
+        }
+
+        return minimum;
+
+    }
+
+    return INT64_MAX;
+
+}
+
+/* Public functions */
+
+void Schedule_initialise(void) {
+
+    pthread_mutex_init(&scheduleMutex, NULL);
+
+    mode = SC_OFF;
+
+}
+
+void Schedule_clear(void) {
+
+    pthread_mutex_lock(&scheduleMutex);
+
+    mode = SC_OFF;
+
+    pthread_mutex_unlock(&scheduleMutex);
+
+}
+
+void Schedule_setDutyCycle(int32_t newRecordDuration, int32_t newPeriod) {
+
+    pthread_mutex_lock(&scheduleMutex);
+
+    period = MAX(1, newPeriod);
+
+    recordDuration = MAX(0, MIN(period, newRecordDuration));
+
+    mode = recordDuration < period ? SC_DUTY_CYCLE : SC_OFF;
+
+    pthread_mutex_unlock(&scheduleMutex);
+
+}
+
+void Schedule_setWindows(int32_t newNumberOfWindows, int32_t *startMinutes, int32_t *stopMinutes) {
+
+    pthread_mutex_lock(&scheduleMutex);
+
+    newNumberOfWindows = MAX(0, MIN(MAXIMUM_NUMBER_OF_WINDOWS, newNumberOfWindows));
+
+    numberOfWindows = 0;
+
+    for (int32_t i = 0; i < newNumberOfWindows; i += 1) {
+
+        int32_t startTime = positiveModulo(startMinutes[i], MINUTES_IN_DAY) * SECONDS_IN_MINUTE;
+
+        int32_t stopTime = positiveModulo(stopMinutes[i], MINUTES_IN_DAY) * SECONDS_IN_MINUTE;
+
+        /* A window which starts where it stops is empty rather than the whole day so it is dropped */
+
+        if (startTime == stopTime) continue;
+
+        windowStartTimes[numberOfWindows] = startTime;
+
+        windowStopTimes[numberOfWindows] = stopTime;
+
+        numberOfWindows += 1;
+
+    }
+
+    /* With no windows at all the schedule is cleared, while windows which were all empty never record */
+
+    mode = newNumberOfWindows > 0 ? SC_WINDOWS : SC_OFF;
+
+    pthread_mutex_unlock(&scheduleMutex);
+
+}
+
+bool Schedule_isEnabled(void) {
+
+    pthread_mutex_lock(&scheduleMutex);
+
+    bool enabled = mode != SC_OFF;
+
+    pthread_mutex_unlock(&scheduleMutex);
+
+    return enabled;
+
+}
+
+bool Schedule_isActive(int64_t time) {
+
+    pthread_mutex_lock(&scheduleMutex);
+
+    bool active = isActive(time);
+
+    pthread_mutex_unlock(&scheduleMutex);
+
+    return active;
+
+}
+
+int64_t Schedule_getSecondsUntilTransition(int64_t time) {
+
+    pthread_mutex_lock(&scheduleMutex);
+
+    int64_t seconds = getSecondsUntilTransition(time);
+
+    pthread_mutex_unlock(&scheduleMutex);
+
+    return seconds;
+
+}
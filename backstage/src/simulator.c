@@ -10,13 +10,30 @@
 #include <string.h>
 #include <stdbool.h>
 
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#include "macros.h"
+#include "generator.h"
 #include "simulator.h"
 
 /* WAV header constants */
 
 #define NUMBER_OF_BYTES_IN_SAMPLE               2
 #define RIFF_ID_LENGTH                          4
-#define WAV_HEADER_SEARCH                       1024
+#define RIFF_CHUNK_HEADER_SIZE                  8
+#define WAV_FORMAT_PCM                          0x0001
+#define WAV_FORMAT_EXTENSIBLE                   0xFFFE
+#define WAV_FORMAT_MINIMUM_SIZE                 16
+#define WAV_FORMAT_EXTENSIBLE_SIZE              26
+#define WAV_FORMAT_SUBFORMAT_OFFSET             24
+#define MAXIMUM_NUMBER_OF_CHANNELS              2
 
 /* Example file constant */
 
@@ -24,182 +41,658 @@
 
 /* Simulation constant */
 
-#define CALLBACKS_PER_SECOND                    100
-#define MICROSECONDS_IN_SECOND                  1000000
-#define MAXIMUM_SAMPLE_RATE                     384000
-#define MAXIMUM_BUFFER_LENGTH                   (MAXIMUM_SAMPLE_RATE / CALLBACKS_PER_SECOND)
+#define NUMBER_OF_VALID_SAMPLE_RATES            8
+
+/* Mapping window constants. The alignment is the Windows allocation granularity which is also a multiple of the page size elsewhere */
+
+#define MAPPING_ALIGNMENT                       65536
+#define MAPPING_WINDOW_SIZE                     (64 * MAPPING_ALIGNMENT)
 
 /* Cross platform macros */
 
 #if defined(_WIN32) || defined(_WIN64)
     #define FILE_SEPARATOR "\\"
+    #define fseeko _fseeki64
+    #define ftello _ftelli64
 #else
     #define FILE_SEPARATOR "/"
 #endif
 
-/* Global variables */
+/* Valid sample rates. Files must use one of the capture rates so the monitor resampler has a filter bank for them */
 
-static uint32_t offset;
+static int32_t validSampleRates[NUMBER_OF_VALID_SAMPLE_RATES] = {8000, 16000, 32000, 48000, 96000, 192000, 250000, 384000};
 
-static uint32_t length;
+/* Playlist entry structure */
 
-static uint32_t loadedLength;
+typedef struct {
+    char filename[FILEPATH_SIZE];
+    int32_t sampleRate;
+    int32_t numberOfChannels;
+    int64_t dataOffset;
+    int64_t dataSize;
+} SM_entry_t;
 
-static int16_t *audioData;
+/* Playlist variables */
 
-static int16_t *loadedAudioData;
+static SM_entry_t playlist[MAXIMUM_PLAYLIST_LENGTH];
 
-static char buffer[RIFF_ID_LENGTH + 1];
+static int32_t playlistLength;
 
-static char filepath[FILEPATH_SIZE];
+static int32_t playlistIndex;
+
+static bool playlistLooping;
+
+static bool playlistFinished;
+
+static SM_entry_t loadedPlaylist[MAXIMUM_PLAYLIST_LENGTH];
+
+static int32_t loadedPlaylistLength;
+
+static bool loadedPlaylistPending;
+
+static bool loadedPlaylistLooping = true;
+
+/* Generator variables. A selected generator replaces the playlist as the source of input */
+
+static bool generatorSelected;
+
+static bool loadedGeneratorSelected;
+
+static GN_settings_t loadedGeneratorSettings;
+
+/* Open file variables */
+
+#if defined(_WIN32) || defined(_WIN64)
 
-static int32_t sampleRates[NUMBER_OF_SIMULATION_EXAMPLES] = {192000};
+    static HANDLE fileHandle = INVALID_HANDLE_VALUE;
+
+    static HANDLE mappingHandle;
+
+#else
+
+    static int fileDescriptor = -1;
+
+#endif
+
+static int64_t fileSize;
+
+static uint8_t *window;
+
+static size_t windowLength;
+
+static int64_t windowOffset;
+
+/* Read position variables. Samples are little-endian in the file and copied directly so the host is assumed to be little-endian */
+
+static int64_t position;
+
+static int64_t dataEnd;
+
+static int32_t frameSize;
+
+/* Example variables */
+
+static char filepath[FILEPATH_SIZE];
 
 static char *filenames[NUMBER_OF_SIMULATION_EXAMPLES] = {"BAT.WAV"};
 
 static char *descriptions[NUMBER_OF_SIMULATION_EXAMPLES] = {"Bat - Pipistrellus pipistrellus"};
 
-/* Public functions */
+/* Private functions */
 
-int32_t Simulator_getSampleRate(int32_t index) {
+static uint16_t readUint16(const uint8_t *bytes) {
 
-    return sampleRates[index];
+    return (uint16_t)(bytes[0] | bytes[1] << 8);
 
 }
 
-char* Simulator_getDescription(int32_t index) {
+static uint32_t readUint32(const uint8_t *bytes) {
 
-    return descriptions[index];
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
 
 }
 
-bool Simulator_loadExample(int32_t index) {
+static bool parseHeader(const char *filename, SM_entry_t *entry) {
 
-    if (index < 0) index = 0;
+    FILE *inputFile = fopen(filename, "rb");
 
-    if (index > NUMBER_OF_SIMULATION_EXAMPLES - 2) index = NUMBER_OF_SIMULATION_EXAMPLES - 1;
+    if (inputFile == NULL) {
 
-    /* Open the file */
+        puts("[SIMULATOR] Could not open input file");
 
-    static char filename[FILEPATH_SIZE];
+        return false;
 
-    sprintf(filename, "%s%s%s", filepath, FILE_SEPARATOR, filenames[index]);
-    
-    FILE *inputFile = fopen(filename, "rb");
+    }
 
-    if (inputFile == NULL) {
+    /* Check the RIFF header */
 
-        puts("[SIMULATOR] Could not open input file");
+    uint8_t header[RIFF_CHUNK_HEADER_SIZE + RIFF_ID_LENGTH];
+
+    if (fread(header, 1, sizeof(header), inputFile) != sizeof(header) || memcmp(header, "RIFF", RIFF_ID_LENGTH) != 0 || memcmp(header + RIFF_CHUNK_HEADER_SIZE, "WAVE", RIFF_ID_LENGTH) != 0) {
+
+        puts("[SIMULATOR] Input file is not a WAV file");
+
+        fclose(inputFile);
 
         return false;
 
     }
 
-    /* Find the data */
-    
-    int32_t counter = 0;
+    /* Walk the chunks until the format and data have both been found */
+
+    bool formatFound = false;
+
+    bool dataFound = false;
+
+    int64_t chunkOffset = sizeof(header);
+
+    while (dataFound == false) {
+
+        uint8_t chunkHeader[RIFF_CHUNK_HEADER_SIZE];
+
+        if (fseeko(inputFile, chunkOffset, SEEK_SET) != 0 || fread(chunkHeader, 1, RIFF_CHUNK_HEADER_SIZE, inputFile) != RIFF_CHUNK_HEADER_SIZE) break;
+
+        int64_t chunkSize = readUint32(chunkHeader + RIFF_ID_LENGTH);
+
+        if (memcmp(chunkHeader, "fmt ", RIFF_ID_LENGTH) == 0) {
+
+            uint8_t format[WAV_FORMAT_EXTENSIBLE_SIZE];
+
+            size_t formatSize = (size_t)MIN(chunkSize, WAV_FORMAT_EXTENSIBLE_SIZE);
+
+            if (chunkSize < WAV_FORMAT_MINIMUM_SIZE || fread(format, 1, formatSize, inputFile) != formatSize) break;
+
+            uint16_t formatTag = readUint16(format);
+
+            if (formatTag == WAV_FORMAT_EXTENSIBLE && chunkSize >= WAV_FORMAT_EXTENSIBLE_SIZE) formatTag = readUint16(format + WAV_FORMAT_SUBFORMAT_OFFSET);
+
+            entry->numberOfChannels = readUint16(format + 2);
+
+            entry->sampleRate = (int32_t)readUint32(format + 4);
+
+            uint16_t blockAlign = readUint16(format + 12);
+
+            uint16_t bitsPerSample = readUint16(format + 14);
+
+            bool supported = formatTag == WAV_FORMAT_PCM && bitsPerSample == 8 * NUMBER_OF_BYTES_IN_SAMPLE;
+
+            supported &= entry->numberOfChannels >= 1 && entry->numberOfChannels <= MAXIMUM_NUMBER_OF_CHANNELS && blockAlign == entry->numberOfChannels * NUMBER_OF_BYTES_IN_SAMPLE;
+
+            if (supported == false) {
+
+                puts("[SIMULATOR] Only mono or stereo 16-bit PCM WAV files are supported");
+
+                fclose(inputFile);
+
+                return false;
+
+            }
 
-    while (counter < WAV_HEADER_SEARCH) {
+            bool validSampleRate = false;
 
-        fseek(inputFile, counter, SEEK_SET);
+            for (int32_t i = 0; i < NUMBER_OF_VALID_SAMPLE_RATES; i += 1) validSampleRate |= entry->sampleRate == validSampleRates[i];
 
-        uint32_t numberOfBytes = fread(buffer, 1, RIFF_ID_LENGTH, inputFile);
+            if (validSampleRate == false) {
 
-        if (numberOfBytes != RIFF_ID_LENGTH) {
+                printf("[SIMULATOR] Sample rate of %d Hz is not supported\n", entry->sampleRate);
 
-            puts("[SIMULATOR] Could read from file while finding data");
+                fclose(inputFile);
+
+                return false;
+
+            }
+
+            formatFound = true;
+
+        } else if (memcmp(chunkHeader, "data", RIFF_ID_LENGTH) == 0) {
+
+            entry->dataOffset = chunkOffset + RIFF_CHUNK_HEADER_SIZE;
+
+            entry->dataSize = chunkSize;
+
+            dataFound = true;
+
+        }
+
+        /* Chunks are padded to an even number of bytes */
+
+        chunkOffset += RIFF_CHUNK_HEADER_SIZE + chunkSize + (chunkSize & 1);
+
+    }
+
+    /* Find the file size so a data chunk with an unfinished size can still be played */
+
+    fseeko(inputFile, 0, SEEK_END);
+
+    int64_t size = ftello(inputFile);
+
+    fclose(inputFile);
+
+    if (formatFound == false || dataFound == false) {
+
+        puts("[SIMULATOR] Could not find format and data");
+
+        return false;
+
+    }
+
+    if (entry->dataOffset + entry->dataSize > size) entry->dataSize = size - entry->dataOffset;
+
+    entry->dataSize -= entry->dataSize % (entry->numberOfChannels * NUMBER_OF_BYTES_IN_SAMPLE);
+
+    if (entry->dataSize <= 0) {
+
+        puts("[SIMULATOR] Input file contains no samples");
+
+        return false;
+
+    }
+
+    strncpy(entry->filename, filename, FILEPATH_SIZE - 1);
+
+    entry->filename[FILEPATH_SIZE - 1] = 0;
+
+    return true;
+
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+    static void unmapWindow(void) {
+
+        if (window != NULL) UnmapViewOfFile(window);
+
+        window = NULL;
+
+    }
+
+    static void closeFile(void) {
+
+        unmapWindow();
+
+        if (fileHandle != INVALID_HANDLE_VALUE) {
+
+            CloseHandle(mappingHandle);
+
+            CloseHandle(fileHandle);
+
+        }
+
+        fileHandle = INVALID_HANDLE_VALUE;
+
+    }
+
+    static bool openFile(const char *filename) {
+
+        fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+        if (mappingHandle == NULL || GetFileSizeEx(fileHandle, &size) == false) {
+
+            if (mappingHandle != NULL) CloseHandle(mappingHandle);
+
+            CloseHandle(fileHandle);
+
+            fileHandle = INVALID_HANDLE_VALUE;
 
             return false;
 
         }
 
-        if (strcmp(buffer, "data") == 0) break;
+        fileSize = size.QuadPart;
 
-        counter += 1;
+        return true;
 
     }
 
-    /* Catch error */
+    static bool mapWindow(int64_t offset, size_t length) {
+
+        window = (uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, (DWORD)(offset >> 32), (DWORD)(offset & 0xFFFFFFFF), length);
+
+        return window != NULL;
+
+    }
+
+#else
+
+    static void unmapWindow(void) {
+
+        if (window != NULL) munmap(window, windowLength);
+
+        window = NULL;
+
+    }
+
+    static void closeFile(void) {
+
+        unmapWindow();
 
-    if (counter == WAV_HEADER_SEARCH) {
+        if (fileDescriptor >= 0) close(fileDescriptor);
 
-        puts("[SIMULATOR] Could not find data");
+        fileDescriptor = -1;
+
+    }
+
+    static bool openFile(const char *filename) {
+
+        fileDescriptor = open(filename, O_RDONLY);
+
+        if (fileDescriptor < 0) return false;
+
+        struct stat status;
+
+        if (fstat(fileDescriptor, &status) != 0) {
+
+            close(fileDescriptor);
+
+            fileDescriptor = -1;
+
+            return false;
+
+        }
+
+        fileSize = status.st_size;
+
+        return true;
+
+    }
+
+    static bool mapWindow(int64_t offset, size_t length) {
+
+        void *address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileDescriptor, (off_t)offset);
+
+        if (address == MAP_FAILED) return false;
+
+        madvise(address, length, MADV_SEQUENTIAL);
+
+        window = (uint8_t*)address;
+
+        return true;
+
+    }
+
+#endif
+
+static bool moveWindow(int64_t offset) {
+
+    /* Only a fixed window of the file is ever mapped so memory use does not grow with the file size */
+
+    unmapWindow();
+
+    windowOffset = offset - offset % MAPPING_ALIGNMENT;
+
+    int64_t length = fileSize - windowOffset;
+
+    if (length > MAPPING_WINDOW_SIZE) length = MAPPING_WINDOW_SIZE;
+
+    windowLength = (size_t)length;
+
+    if (mapWindow(windowOffset, windowLength)) return true;
+
+    windowLength = 0;
+
+    return false;
+
+}
+
+static bool openEntry(int32_t index) {
+
+    closeFile();
+
+    SM_entry_t *entry = &playlist[index];
+
+    if (openFile(entry->filename) == false) {
+
+        puts("[SIMULATOR] Could not open input file");
 
         return false;
 
     }
 
-    /* Calculate data size */
+    position = entry->dataOffset;
+
+    dataEnd = MIN(entry->dataOffset + entry->dataSize, fileSize);
+
+    frameSize = entry->numberOfChannels * NUMBER_OF_BYTES_IN_SAMPLE;
 
-    uint32_t numberOfBytes = fread(&loadedLength, 1, sizeof(uint32_t), inputFile);
+    if (moveWindow(position) == false) {
 
-    if (numberOfBytes != sizeof(uint32_t)) {
+        puts("[SIMULATOR] Could not map input file");
 
-        puts("[SIMULATOR] Could not read size of data");
+        closeFile();
 
         return false;
 
     }
 
-    /* Allocate space for the contents */
+    playlistIndex = index;
+
+    return true;
+
+}
+
+static void nextEntry(void) {
+
+    /* Move through the playlist, looping back to the start if required, and skip files which can no longer be opened */
+
+    for (int32_t i = 1; i <= playlistLength; i += 1) {
+
+        int32_t index = playlistIndex + i;
+
+        if (index >= playlistLength && playlistLooping == false) break;
+
+        if (openEntry(index % playlistLength)) return;
+
+    }
+
+    closeFile();
+
+    playlistFinished = true;
+
+}
+
+/* Public functions */
+
+int32_t Simulator_getSampleRate(void) {
+
+    if (generatorSelected) return Generator_getSampleRate();
+
+    return playlistLength > 0 ? playlist[playlistIndex].sampleRate : 0;
+
+}
+
+char* Simulator_getDescription(int32_t index) {
+
+    return descriptions[index];
+
+}
+
+bool Simulator_loadExample(int32_t index) {
+
+    if (index < 0) index = 0;
+
+    if (index > NUMBER_OF_SIMULATION_EXAMPLES - 1) index = NUMBER_OF_SIMULATION_EXAMPLES - 1;
+
+    static char filename[FILEPATH_SIZE];
+
+    snprintf(filename, FILEPATH_SIZE, "%s%s%s", filepath, FILE_SEPARATOR, filenames[index]);
+
+    Simulator_clearPlaylist();
+
+    return Simulator_addToPlaylist(filename);
+
+}
+
+void Simulator_clearPlaylist(void) {
+
+    loadedPlaylistLength = 0;
+
+    loadedPlaylistPending = false;
+
+    loadedPlaylistLooping = true;
 
-    loadedAudioData = (int16_t*)malloc(loadedLength);
+    loadedGeneratorSelected = false;
 
-    if (loadedAudioData == NULL) {
+}
+
+void Simulator_setLooping(bool looping) {
+
+    loadedPlaylistLooping = looping;
+
+}
 
-        puts("[SIMULATOR] Could not allocate memory for data");
+bool Simulator_isFinished(void) {
+
+    return playlistFinished;
+
+}
+
+bool Simulator_addToPlaylist(char *filename) {
+
+    if (loadedPlaylistLength == MAXIMUM_PLAYLIST_LENGTH) {
+
+        puts("[SIMULATOR] Playlist is full");
 
         return false;
 
     }
 
-    loadedLength /= NUMBER_OF_BYTES_IN_SAMPLE;
+    if (parseHeader(filename, &loadedPlaylist[loadedPlaylistLength]) == false) return false;
+
+    loadedPlaylistLength += 1;
 
-    /* Read the data */
+    loadedPlaylistPending = true;
 
-    uint32_t numberOfSamples = fread(loadedAudioData, sizeof(int16_t), loadedLength, inputFile);
+    loadedGeneratorSelected = false;
 
-    if (numberOfSamples != loadedLength) {
+    return true;
+
+}
 
-        puts("[SIMULATOR] Could not read data");
+bool Simulator_loadGenerator(GN_settings_t *settings) {
+
+    if (Generator_isValid(settings) == false) {
+
+        puts("[SIMULATOR] Generator settings are not supported");
 
         return false;
 
     }
 
-    /* Close file */
+    Simulator_clearPlaylist();
 
-    fclose(inputFile);
+    loadedGeneratorSettings = *settings;
 
-    /* Return */
+    loadedGeneratorSelected = true;
+
+    loadedPlaylistPending = true;
 
     return true;
 
 }
 
-void Simulator_initialiseExample() {
+void Simulator_initialiseExample(void) {
+
+    /* Continue from the current position unless a new playlist has been loaded */
+
+    if (loadedPlaylistPending == false && (playlistLength > 0 || generatorSelected)) return;
+
+    closeFile();
+
+    generatorSelected = loadedGeneratorSelected;
+
+    if (generatorSelected) Generator_configure(&loadedGeneratorSettings);
 
-    if (audioData != NULL) free(audioData);
+    memcpy(playlist, loadedPlaylist, loadedPlaylistLength * sizeof(SM_entry_t));
 
-    audioData = loadedAudioData;
+    playlistLength = loadedPlaylistLength;
 
-    length = loadedLength;
+    playlistLooping = loadedPlaylistLooping;
 
-    offset = 0;
+    playlistFinished = false;
+
+    loadedPlaylistPending = false;
+
+    playlistIndex = -1;
+
+    if (playlistLength > 0) nextEntry();
 
 }
 
-int16_t Simulator_nextSample() {
+int32_t Simulator_read(int16_t *destination, int32_t numberOfFrames) {
+
+    if (generatorSelected) {
+
+        if (playlistFinished) return 0;
+
+        int32_t numberOfFramesGenerated = Generator_read(destination, numberOfFrames);
+
+        /* A generator with a fixed duration repeats like a single file playlist */
+
+        if (Generator_isFinished()) {
+
+            if (playlistLooping) Generator_restart(); else playlistFinished = true;
+
+        }
+
+        return numberOfFramesGenerated;
+
+    }
+
+    if (playlistLength == 0 || playlistFinished) return 0;
+
+    int32_t numberOfFramesRead = 0;
+
+    /* Copy contiguous spans from the mapped window, stopping at the end of the file */
+
+    while (numberOfFramesRead < numberOfFrames && position < dataEnd) {
+
+        int64_t windowEnd = MIN(windowOffset + (int64_t)windowLength, dataEnd);
 
-    if (audioData == NULL) return 0;
+        int32_t span = (int32_t)MIN((int64_t)(numberOfFrames - numberOfFramesRead), (windowEnd - position) / frameSize);
 
-    int16_t sample = audioData[offset++];
+        if (span == 0) {
 
-    if (offset == length) offset = 0;
+            if (moveWindow(position) == false) break;
 
-    return sample;
+            continue;
 
-};
+        }
+
+        const uint8_t *frames = window + (position - windowOffset);
+
+        int16_t *output = destination + numberOfFramesRead;
+
+        if (frameSize == NUMBER_OF_BYTES_IN_SAMPLE) {
+
+            memcpy(output, frames, span * NUMBER_OF_BYTES_IN_SAMPLE);
+
+        } else {
+
+            const int16_t *samples = (const int16_t*)frames;
+
+            for (int32_t i = 0; i < span; i += 1) output[i] = (int16_t)(((int32_t)samples[2 * i] + (int32_t)samples[2 * i + 1]) / 2);
+
+        }
+
+        numberOfFramesRead += span;
+
+        position += (int64_t)span * frameSize;
+
+    }
+
+    /* Move on through the playlist at the end of the file or if it can no longer be read */
+
+    if (position >= dataEnd || numberOfFramesRead < numberOfFrames) nextEntry();
+
+    return numberOfFramesRead;
+
+}
 
 void Simulator_setPath(char *path) {
 
@@ -7,9 +7,11 @@
 #include <math.h>
 #include <stdint.h>
 
+#include "stft.h"
+
 /* Global constants */
 
-#define SIZE                512
+#define SIZE                STFT_INPUT_SAMPLES
 #define CSIZE               (SIZE << 1)
 
 #define BITS_IN_UINT32      32
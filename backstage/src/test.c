@@ -0,0 +1,339 @@
+/****************************************************************************
+ * test.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stft.h"
+#include "engine.h"
+#include "macros.h"
+#include "threads.h"
+#include "wavFile.h"
+#include "generator.h"
+
+#if IS_WINDOWS == false
+    #include <unistd.h>
+#endif
+
+/* Maths constants */
+
+#ifndef M_PI
+#define M_PI                                3.14159265358979323846
+#endif
+
+/* Frame timer constants */
+
+#define FRAME_INTERVAL                      10000
+#define MAXIMUM_NUMBER_OF_FRAMES            6000
+
+/* Offline run constants. The start time is 12:00:00 on 1st January 2026 UTC */
+
+#define START_TIME                          1767268800000.0
+#define SAMPLE_RATE                         384000
+#define GENERATOR_DURATION                  2.1
+#define GENERATOR_LEVEL                     -6.0
+#define AUTOSAVE_DURATION                   1
+
+/* STFT constants */
+
+#define STFT_OUTPUT_SAMPLES                 (STFT_INPUT_SAMPLES / STFT_INPUT_OUTPUT_RATIO)
+#define STFT_BIN_TOLERANCE                  1
+
+/* Sine constant. The frequency falls exactly on the 60th STFT bin */
+
+#define SINE_FREQUENCY                      45000
+
+/* Chirp constants. Each sweep lasts one second, which is a whole number of STFT blocks */
+
+#define CHIRP_START_FREQUENCY               1000
+#define CHIRP_STOP_FREQUENCY                101000
+
+/* Golden autosave values for the sine. Autosave files hold whole seconds so the 2.1 second run saves two */
+
+#define GOLDEN_FILENAME                     "20260101_120000.WAV"
+#define GOLDEN_COMMENT                      "Recorded at 12:00:00 01/01/2026 (UTC) by AudioMoth Live using "
+#define GOLDEN_NUMBER_OF_SAMPLES            (2 * SAMPLE_RATE)
+#define GOLDEN_DATA_HASH                    0xC461A842
+#define SAMPLE_TOLERANCE                    1
+
+/* FNV-1a hash constants */
+
+#define FNV_OFFSET_BASIS                    2166136261u
+#define FNV_PRIME                           16777619u
+
+/* Buffer constant */
+
+#define FILENAME_SIZE                       (FILEPATH_SIZE + 32)
+
+/* Test state variables */
+
+static int16_t *audioBuffer;
+
+static float *stftBuffer;
+
+static char destination[FILEPATH_SIZE] = ".";
+
+static int32_t numberOfFailures;
+
+/* Private functions */
+
+static void check(bool condition, char *description) {
+
+    printf("[TEST] %s - %s\n", condition ? "PASS" : "FAIL", description);
+
+    if (condition == false) numberOfFailures += 1;
+
+}
+
+static bool runGenerator(GN_settings_t *settings, int32_t autosaveDuration, EN_frame_t *frame) {
+
+    if (Engine_startGenerator(settings, true, START_TIME) == false) return false;
+
+    Engine_setAutoSave(autosaveDuration, 0);
+
+    /* Drive the engine until the generated signal has been processed */
+
+    for (int32_t i = 0; i < MAXIMUM_NUMBER_OF_FRAMES; i += 1) {
+
+        Engine_getFrame(frame);
+
+        if (frame->offlineComplete) return true;
+
+        usleep(FRAME_INTERVAL);
+
+    }
+
+    return false;
+
+}
+
+static int32_t findPeakBin(int32_t blockIndex) {
+
+    float *block = stftBuffer + blockIndex / STFT_INPUT_OUTPUT_RATIO;
+
+    int32_t peakBin = 1;
+
+    for (int32_t k = 1; k < STFT_OUTPUT_SAMPLES; k += 1) if (block[k] > block[peakBin]) peakBin = k;
+
+    return peakBin;
+
+}
+
+static int32_t countBlocksWithPeakBinError(EN_frame_t *frame, int32_t numberOfSamples, double (*expectedFrequency)(int32_t sample)) {
+
+    int32_t numberOfBlocks = numberOfSamples / STFT_INPUT_SAMPLES;
+
+    int32_t firstIndex = (frame->audioIndex - numberOfBlocks * STFT_INPUT_SAMPLES + AUDIO_BUFFER_SIZE) % AUDIO_BUFFER_SIZE;
+
+    int32_t numberOfErrors = 0;
+
+    for (int32_t b = 0; b < numberOfBlocks; b += 1) {
+
+        int32_t blockIndex = (firstIndex + b * STFT_INPUT_SAMPLES) % AUDIO_BUFFER_SIZE;
+
+        double frequency = expectedFrequency(b * STFT_INPUT_SAMPLES + STFT_INPUT_SAMPLES / 2);
+
+        int32_t expectedBin = (int32_t)round(frequency * STFT_INPUT_SAMPLES / SAMPLE_RATE);
+
+        if (ABS(findPeakBin(blockIndex) - expectedBin) > STFT_BIN_TOLERANCE) numberOfErrors += 1;
+
+    }
+
+    return numberOfErrors;
+
+}
+
+static double sineFrequency(int32_t sample) {
+
+    return SINE_FREQUENCY;
+
+}
+
+static double chirpFrequency(int32_t sample) {
+
+    double time = (double)(sample % SAMPLE_RATE) / SAMPLE_RATE;
+
+    return CHIRP_START_FREQUENCY + (CHIRP_STOP_FREQUENCY - CHIRP_START_FREQUENCY) * time;
+
+}
+
+static uint32_t hashSamples(int16_t *samples, int32_t numberOfSamples) {
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    uint8_t *bytes = (uint8_t*)samples;
+
+    for (int32_t i = 0; i < numberOfSamples * NUMBER_OF_BYTES_IN_SAMPLE; i += 1) {
+
+        hash ^= bytes[i];
+
+        hash *= FNV_PRIME;
+
+    }
+
+    return hash;
+
+}
+
+/* Tests */
+
+static void testChirp(void) {
+
+    GN_settings_t settings = {GN_CHIRP, SAMPLE_RATE, CHIRP_START_FREQUENCY, CHIRP_STOP_FREQUENCY, GENERATOR_LEVEL, GENERATOR_DURATION};
+
+    EN_frame_t frame;
+
+    bool completed = runGenerator(&settings, 0, &frame);
+
+    check(completed, "chirp offline run completes");
+
+    if (completed == false) return;
+
+    int32_t numberOfSamples = (int32_t)round(GENERATOR_DURATION * SAMPLE_RATE);
+
+    check(frame.audioCount == numberOfSamples, "chirp sample count matches the generated duration");
+
+    check(countBlocksWithPeakBinError(&frame, numberOfSamples, chirpFrequency) == 0, "chirp STFT peak follows the sweep in every block");
+
+}
+
+static void testSine(void) {
+
+    GN_settings_t settings = {GN_SINE, SAMPLE_RATE, SINE_FREQUENCY, 0, GENERATOR_LEVEL, GENERATOR_DURATION};
+
+    EN_frame_t frame;
+
+    bool completed = runGenerator(&settings, AUTOSAVE_DURATION, &frame);
+
+    check(completed, "sine offline run completes");
+
+    if (completed == false) return;
+
+    int32_t numberOfSamples = (int32_t)round(GENERATOR_DURATION * SAMPLE_RATE);
+
+    check(frame.audioCount == numberOfSamples, "sine sample count matches the generated duration");
+
+    check(frame.audioTime == (int64_t)START_TIME + (int64_t)round(GENERATOR_DURATION * 1000.0), "sine frame time advances from the offline start time");
+
+    check(countBlocksWithPeakBinError(&frame, numberOfSamples, sineFrequency) == 0, "sine STFT peak is at the expected bin in every block");
+
+    /* Write out the autosave file and compare it with the golden values */
+
+    Engine_forceAutoSaveToStop();
+
+    char filename[FILENAME_SIZE];
+
+    snprintf(filename, FILENAME_SIZE, "%s/%s", destination, GOLDEN_FILENAME);
+
+    FILE *file = fopen(filename, "rb");
+
+    check(file != NULL, "autosave file is named from the offline start time");
+
+    if (file == NULL) return;
+
+    WAV_header_t header;
+
+    int16_t *samples = malloc(GOLDEN_NUMBER_OF_SAMPLES * sizeof(int16_t));
+
+    bool headerRead = fread(&header, sizeof(WAV_header_t), 1, file) == 1;
+
+    bool samplesRead = samples != NULL && headerRead && header.data.size == GOLDEN_NUMBER_OF_SAMPLES * NUMBER_OF_BYTES_IN_SAMPLE && fread(samples, NUMBER_OF_BYTES_IN_SAMPLE, GOLDEN_NUMBER_OF_SAMPLES, file) == GOLDEN_NUMBER_OF_SAMPLES;
+
+    fclose(file);
+
+    check(headerRead && header.wavFormat.samplesPerSecond == SAMPLE_RATE, "autosave header has the generated sample rate");
+
+    check(headerRead && strncmp(header.icmt.comment, GOLDEN_COMMENT, strlen(GOLDEN_COMMENT)) == 0, "autosave header comment has the offline start time");
+
+    check(samplesRead, "autosave file holds the whole seconds of the run");
+
+    if (samplesRead) {
+
+        /* The samples should match the ideal sine to within rounding and also match the golden hash exactly. The capture resampler interpolates from the previous input sample so the saved samples lag the generator by one */
+
+        double amplitude = 32767.0 * pow(10.0, GENERATOR_LEVEL / 20.0);
+
+        int32_t numberOfMismatches = 0;
+
+        for (int32_t i = 0; i < GOLDEN_NUMBER_OF_SAMPLES; i += 1) {
+
+            double expected = i == 0 ? 0.0 : amplitude * sin(2.0 * M_PI * (double)((int64_t)SINE_FREQUENCY * (i - 1) % SAMPLE_RATE) / SAMPLE_RATE);
+
+            if (fabs((double)samples[i] - expected) > SAMPLE_TOLERANCE) numberOfMismatches += 1;
+
+        }
+
+        check(numberOfMismatches == 0, "autosave samples match the ideal sine");
+
+        uint32_t hash = hashSamples(samples, GOLDEN_NUMBER_OF_SAMPLES);
+
+        if (hash != GOLDEN_DATA_HASH) printf("[TEST] Sample data hash is 0x%08X\n", hash);
+
+        check(hash == GOLDEN_DATA_HASH, "autosave samples match the golden hash");
+
+    }
+
+    free(samples);
+
+    remove(filename);
+
+}
+
+/* Main function */
+
+int main(int argc, char **argv) {
+
+    for (int32_t i = 1; i < argc; i += 1) {
+
+        if (strcmp(argv[i], "--destination") == 0 && i + 1 < argc) {
+
+            snprintf(destination, FILEPATH_SIZE, "%s", argv[++i]);
+
+        } else {
+
+            puts("Usage: backstage_test [--destination <folder>]");
+
+            return strcmp(argv[i], "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+        }
+
+    }
+
+    /* The engine writes into buffers owned by the caller so the tests can read them directly */
+
+    audioBuffer = malloc(AUDIO_BUFFER_SIZE * sizeof(int16_t));
+
+    stftBuffer = malloc(STFT_BUFFER_SIZE * sizeof(float));
+
+    if (audioBuffer == NULL || stftBuffer == NULL) {
+
+        puts("[TEST] Could not allocate audio buffers");
+
+        return EXIT_FAILURE;
+
+    }
+
+    /* The virtual backend keeps the tests independent of any audio hardware */
+
+    if (Engine_initialise(audioBuffer, stftBuffer, BACKEND_VIRTUAL) == false) puts("[TEST] Engine did not start cleanly");
+
+    Engine_setFileDestination(destination);
+
+    /* The sine runs last as writing out its autosave file shuts autosave down */
+
+    testChirp();
+
+    testSine();
+
+    printf("[TEST] %s\n", numberOfFailures == 0 ? "All tests passed" : "Some tests failed");
+
+    return numberOfFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -117,4 +117,32 @@
 
     }
 
+    int pthread_cond_init(pthread_cond_t *cond, pthread_condattr_t *attr) {
+
+        if (cond == NULL) return 1;
+
+        InitializeConditionVariable(cond);
+
+        return 0;
+
+    }
+
+    int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex) {
+
+        if (cond == NULL || mutex == NULL) return 1;
+
+        return SleepConditionVariableCS(cond, mutex, INFINITE) ? 0 : 1;
+
+    }
+
+    int pthread_cond_signal(pthread_cond_t *cond) {
+
+        if (cond == NULL) return 1;
+
+        WakeConditionVariable(cond);
+
+        return 0;
+
+    }
+
 #endif
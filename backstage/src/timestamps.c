@@ -0,0 +1,172 @@
+/****************************************************************************
+ * timestamps.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stft.h"
+#include "engine.h"
+#include "threads.h"
+#include "timestamps.h"
+
+/* Index constants. There is one entry per STFT block of the audio buffer */
+
+#define BLOCK_SIZE                      STFT_INPUT_SAMPLES
+#define NUMBER_OF_BLOCKS                (AUDIO_BUFFER_SIZE / BLOCK_SIZE)
+
+/* Unit conversion constants */
+
+#define MICROSECONDS_IN_SECOND          1000000
+
+/* Index entry structure */
+
+typedef struct {
+    volatile uint32_t sequence;
+    int32_t sampleRate;
+    int64_t sampleCount;
+    int64_t monotonicTime;
+    int64_t utcTime;
+} TS_entry_t;
+
+/* Entries are written by the capture path and read by the other threads under a sequence lock on each entry */
+
+static TS_entry_t entries[NUMBER_OF_BLOCKS];
+
+static volatile uint32_t latestBlock;
+
+static volatile uint32_t numberOfEntries;
+
+/* Private functions */
+
+static bool readEntry(int32_t block, TS_entry_t *copy) {
+
+    TS_entry_t *entry = &entries[block];
+
+    uint32_t sequence;
+
+    do {
+
+        sequence = Atomic_load32(&entry->sequence);
+
+        copy->sampleRate = entry->sampleRate;
+        copy->sampleCount = entry->sampleCount;
+        copy->monotonicTime = entry->monotonicTime;
+        copy->utcTime = entry->utcTime;
+
+        Atomic_acquireFence();
+
+    } while ((sequence & 1) || sequence != Atomic_load32(&entry->sequence));
+
+    return sequence > 0;
+
+}
+
+static int64_t interpolateTime(TS_entry_t *entry, int64_t offset) {
+
+    return entry->utcTime + offset * MICROSECONDS_IN_SECOND / entry->sampleRate;
+
+}
+
+/* Public functions */
+
+void Timestamps_initialise(void) {
+
+    for (int32_t i = 0; i < NUMBER_OF_BLOCKS; i += 1) Atomic_store32(&entries[i].sequence, 0);
+
+    Atomic_store32(&latestBlock, 0);
+
+    Atomic_store32(&numberOfEntries, 0);
+
+}
+
+void Timestamps_addBlock(int32_t bufferIndex, int64_t sampleCount, int32_t sampleRate, int64_t monotonicTime, int64_t utcTime) {
+
+    int32_t block = bufferIndex / BLOCK_SIZE;
+
+    TS_entry_t *entry = &entries[block];
+
+    uint32_t sequence = Atomic_load32(&entry->sequence);
+
+    Atomic_store32(&entry->sequence, sequence + 1);
+
+    Atomic_releaseFence();
+
+    entry->sampleRate = sampleRate;
+    entry->sampleCount = sampleCount;
+    entry->monotonicTime = monotonicTime;
+    entry->utcTime = utcTime;
+
+    Atomic_store32(&entry->sequence, sequence + 2);
+
+    Atomic_store32(&latestBlock, (uint32_t)block);
+
+    uint32_t count = Atomic_load32(&numberOfEntries);
+
+    if (count < NUMBER_OF_BLOCKS) Atomic_store32(&numberOfEntries, count + 1);
+
+}
+
+bool Timestamps_getTimeOfIndex(int32_t bufferIndex, int64_t *utcTime) {
+
+    TS_entry_t entry;
+
+    if (readEntry(bufferIndex / BLOCK_SIZE, &entry) == false) return false;
+
+    *utcTime = interpolateTime(&entry, bufferIndex % BLOCK_SIZE);
+
+    return true;
+
+}
+
+bool Timestamps_getTimeOfCount(int64_t sampleCount, int64_t *utcTime) {
+
+    int32_t count = (int32_t)Atomic_load32(&numberOfEntries);
+
+    int32_t latest = (int32_t)Atomic_load32(&latestBlock);
+
+    if (count == 0) return false;
+
+    /* Sample counts increase around the ring from the oldest entry, so binary search on the position relative to it */
+
+    int32_t oldest = (latest - count + 1 + NUMBER_OF_BLOCKS) % NUMBER_OF_BLOCKS;
+
+    int32_t low = 0;
+
+    int32_t high = count - 1;
+
+    TS_entry_t entry;
+
+    while (low < high) {
+
+        int32_t middle = low + (high - low + 1) / 2;
+
+        if (readEntry((oldest + middle) % NUMBER_OF_BLOCKS, &entry) == false) return false;
+
+        if (entry.sampleCount <= sampleCount) {
+
+            low = middle;
+
+        } else {
+
+            high = middle - 1;
+
+        }
+
+    }
+
+    /* Only accept the result if the entry still covers the requested sample */
+
+    if (readEntry((oldest + low) % NUMBER_OF_BLOCKS, &entry) == false) return false;
+
+    int64_t offset = sampleCount - entry.sampleCount;
+
+    if (offset < 0 || offset >= BLOCK_SIZE) return false;
+
+    *utcTime = interpolateTime(&entry, offset);
+
+    return true;
+
+}
@@ -0,0 +1,179 @@
+/****************************************************************************
+ * timing.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "macros.h"
+#include "timing.h"
+#include "threads.h"
+
+/* Unit conversion constants */
+
+#define MICROSECONDS_IN_SECOND          1000000.0
+#define MILLISECONDS_IN_SECOND          1000.0
+#define PARTS_PER_MILLION               1000000.0
+#define PARTS_PER_BILLION               1000000000.0
+
+/* Fit constants. The model only corrects timestamps once it has seen enough audio, and larger errors are treated as faults rather than drift */
+
+#define FIT_TIME_CONSTANT               600.0
+#define MINIMUM_FIT_DURATION            30.0
+#define MAXIMUM_RATE_ERROR              0.001
+#define DISCONTINUITY_LIMIT             2.0
+
+/* Model state variables, only written by the capture path */
+
+static int32_t nominalSampleRate;
+
+static int64_t frameCount;
+
+static int64_t firstObservationTime;
+
+static int64_t numberOfObservations;
+
+static double meanFrames;
+
+static double meanTime;
+
+static double varianceFrames;
+
+static double covariance;
+
+/* Fitted sample rate error in parts per billion and discontinuity flag, shared with the other threads */
+
+static volatile int64_t rateError;
+
+static volatile uint32_t discontinuity;
+
+/* Public functions */
+
+void Timing_reset(int32_t sampleRate) {
+
+    nominalSampleRate = sampleRate;
+
+    frameCount = 0;
+
+    numberOfObservations = 0;
+
+    meanFrames = 0.0;
+
+    meanTime = 0.0;
+
+    varianceFrames = 0.0;
+
+    covariance = 0.0;
+
+    Atomic_store64(&rateError, 0);
+
+    Atomic_store32(&discontinuity, false);
+
+}
+
+void Timing_addObservation(int32_t numberOfFrames, int64_t monotonicMicroseconds) {
+
+    if (nominalSampleRate == 0) return;
+
+    if (numberOfObservations == 0) firstObservationTime = monotonicMicroseconds;
+
+    frameCount += numberOfFrames;
+
+    double frames = (double)frameCount;
+
+    double time = (double)(monotonicMicroseconds - firstObservationTime);
+
+    /* Frames lost or a stalled clock show up as an observation far from the fitted line. These are left out of the fit and reported */
+
+    if (numberOfObservations > 0) {
+
+        double error = (double)Atomic_load64(&rateError) / PARTS_PER_BILLION;
+
+        double period = MICROSECONDS_IN_SECOND / ((double)nominalSampleRate * (1.0 + error));
+
+        double residual = time - meanTime - period * (frames - meanFrames);
+
+        if (fabs(residual) > DISCONTINUITY_LIMIT * MICROSECONDS_IN_SECOND) {
+
+            Atomic_store32(&discontinuity, true);
+
+            return;
+
+        }
+
+    }
+
+    numberOfObservations += 1;
+
+    /* Exponentially weighted running fit of monotonic time against frame count, equally weighted until the window has filled */
+
+    double weight = MAX(1.0 / (double)numberOfObservations, (double)numberOfFrames / (double)nominalSampleRate / FIT_TIME_CONSTANT);
+
+    double framesDifference = frames - meanFrames;
+
+    double timeDifference = time - meanTime;
+
+    meanFrames += weight * framesDifference;
+
+    meanTime += weight * timeDifference;
+
+    varianceFrames = (1.0 - weight) * (varianceFrames + weight * framesDifference * framesDifference);
+
+    covariance = (1.0 - weight) * (covariance + weight * framesDifference * timeDifference);
+
+    if (time < MINIMUM_FIT_DURATION * MICROSECONDS_IN_SECOND || varianceFrames <= 0.0) return;
+
+    /* The slope is the measured period of one frame, which gives the true rate of the device clock */
+
+    double measuredSampleRate = MICROSECONDS_IN_SECOND * varianceFrames / covariance;
+
+    double error = measuredSampleRate / (double)nominalSampleRate - 1.0;
+
+    error = MAX(-MAXIMUM_RATE_ERROR, MIN(MAXIMUM_RATE_ERROR, error));
+
+    Atomic_store64(&rateError, (int64_t)llround(error * PARTS_PER_BILLION));
+
+}
+
+bool Timing_getFrameTime(int32_t framesBeforeLatest, int64_t *monotonicMicroseconds) {
+
+    if (numberOfObservations == 0) return false;
+
+    /* Read the time of a recent frame off the fitted line rather than the jittery callback time */
+
+    double error = (double)Atomic_load64(&rateError) / PARTS_PER_BILLION;
+
+    double period = MICROSECONDS_IN_SECOND / ((double)nominalSampleRate * (1.0 + error));
+
+    double frames = (double)(frameCount - framesBeforeLatest);
+
+    *monotonicMicroseconds = firstObservationTime + (int64_t)llround(meanTime + period * (frames - meanFrames));
+
+    return true;
+
+}
+
+bool Timing_isDiscontinuous(void) {
+
+    return Atomic_load32(&discontinuity);
+
+}
+
+double Timing_getRateError(void) {
+
+    return (double)Atomic_load64(&rateError) * PARTS_PER_MILLION / PARTS_PER_BILLION;
+
+}
+
+int64_t Timing_samplesToMilliseconds(int64_t numberOfSamples, int32_t sampleRate) {
+
+    /* Convert a span of samples to elapsed time at the measured rate of the device clock */
+
+    double error = (double)Atomic_load64(&rateError) / PARTS_PER_BILLION;
+
+    return (int64_t)llround((double)numberOfSamples * MILLISECONDS_IN_SECOND / ((double)sampleRate * (1.0 + error)));
+
+}
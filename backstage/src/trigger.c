@@ -0,0 +1,228 @@
+/****************************************************************************
+ * trigger.c
+ * openacousticdevices.info
+ * October 2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stft.h"
+#include "engine.h"
+#include "macros.h"
+#include "threads.h"
+#include "trigger.h"
+
+/* STFT constant */
+
+#define STFT_OUTPUT_BINS                (STFT_INPUT_SAMPLES / 2)
+
+/* Unit conversion constants */
+
+#define MILLISECONDS_IN_SECOND          1000
+
+/* Level conversion constants */
+
+#define DECIBELS_PER_LOG2_POWER         3.01029995664
+#define FULL_SCALE_DECIBELS             90.3089986992
+
+/* Segment length limit so a triggered segment is always written before the audio buffer wraps */
+
+#define MAXIMUM_SEGMENT_DURATION        60
+
+/* Trigger settings */
+
+typedef struct {
+    bool enabled;
+    int32_t minimumFrequency;
+    int32_t maximumFrequency;
+    double threshold;
+    double hysteresis;
+    int32_t preTrigger;
+    int32_t postTrigger;
+} TR_settings_t;
+
+/* Settings are written by the frontend and read by the capture path under a sequence lock */
+
+static volatile uint32_t settingsSequence;
+
+static TR_settings_t sharedSettings;
+
+static TR_settings_t settings;
+
+/* Trigger state variables */
+
+static volatile uint32_t triggered;
+
+static bool segmentOpen;
+
+static int64_t segmentStartCount;
+
+static int64_t holdStopCount;
+
+/* Private functions */
+
+static void copySettings(TR_settings_t *copy) {
+
+    uint32_t sequence;
+
+    do {
+
+        sequence = Atomic_load32(&settingsSequence);
+
+        *copy = sharedSettings;
+
+        Atomic_acquireFence();
+
+    } while ((sequence & 1) || sequence != Atomic_load32(&settingsSequence));
+
+}
+
+static double calculateBandLevel(float *stft, int32_t sampleRate) {
+
+    int32_t minimumBin = MAX(0, settings.minimumFrequency * STFT_INPUT_SAMPLES / sampleRate);
+
+    int32_t maximumBin = MIN(STFT_OUTPUT_BINS - 1, settings.maximumFrequency * STFT_INPUT_SAMPLES / sampleRate);
+
+    if (maximumBin < minimumBin) return -INFINITY;
+
+    /* STFT output is log2 of the magnitude so convert back to power before averaging */
+
+    float sum = 0.0f;
+
+    for (int32_t i = minimumBin; i <= maximumBin; i += 1) sum += exp2f(2.0f * stft[i]);
+
+    return DECIBELS_PER_LOG2_POWER * log2((double)sum / (double)(maximumBin - minimumBin + 1)) - FULL_SCALE_DECIBELS;
+
+}
+
+static int32_t closeSegment(int64_t stopCount, TR_segment_t *segment) {
+
+    segment->stopCount = stopCount;
+
+    segmentOpen = false;
+
+    return TR_SEGMENT_STOPPED;
+
+}
+
+static int32_t openSegment(int64_t startCount, TR_segment_t *segment) {
+
+    segmentStartCount = startCount;
+
+    segment->startCount = startCount;
+
+    segmentOpen = true;
+
+    return TR_SEGMENT_STARTED;
+
+}
+
+/* Public functions */
+
+void Trigger_initialise(void) {
+
+    segmentOpen = false;
+
+    Atomic_store32(&triggered, false);
+
+    Atomic_store32(&settingsSequence, 0);
+
+}
+
+void Trigger_configure(bool enabled, int32_t minimumFrequency, int32_t maximumFrequency, double threshold, double hysteresis, int32_t preTrigger, int32_t postTrigger) {
+
+    uint32_t sequence = Atomic_load32(&settingsSequence);
+
+    Atomic_store32(&settingsSequence, sequence + 1);
+
+    Atomic_releaseFence();
+
+    sharedSettings.enabled = enabled;
+    sharedSettings.minimumFrequency = MIN(minimumFrequency, maximumFrequency);
+    sharedSettings.maximumFrequency = MAX(minimumFrequency, maximumFrequency);
+    sharedSettings.threshold = threshold;
+    sharedSettings.hysteresis = MAX(0.0, hysteresis);
+    sharedSettings.preTrigger = MAX(0, MIN(MAXIMUM_TRIGGER_PERIOD, preTrigger));
+    sharedSettings.postTrigger = MAX(0, MIN(MAXIMUM_TRIGGER_PERIOD, postTrigger));
+
+    Atomic_store32(&settingsSequence, sequence + 2);
+
+}
+
+bool Trigger_isEnabled(void) {
+
+    TR_settings_t copy;
+
+    copySettings(&copy);
+
+    return copy.enabled;
+
+}
+
+bool Trigger_isTriggered(void) {
+
+    return Atomic_load32(&triggered);
+
+}
+
+int32_t Trigger_processFrame(float *stft, int32_t sampleRate, int64_t frameStopCount, TR_segment_t *segment) {
+
+    copySettings(&settings);
+
+    if (settings.enabled == false) return segmentOpen ? closeSegment(frameStopCount, segment) : TR_NONE;
+
+    double level = calculateBandLevel(stft, sampleRate);
+
+    bool active = Atomic_load32(&triggered);
+
+    /* Apply hysteresis to the band level */
+
+    if (active == false && level > settings.threshold) active = true;
+
+    if (active && level < settings.threshold - settings.hysteresis) active = false;
+
+    Atomic_store32(&triggered, active);
+
+    /* Open a segment including the pre-trigger period */
+
+    if (active) {
+
+        holdStopCount = frameStopCount + (int64_t)settings.postTrigger * sampleRate / MILLISECONDS_IN_SECOND;
+
+        if (segmentOpen == false) {
+
+            int64_t preTriggerSamples = (int64_t)settings.preTrigger * sampleRate / MILLISECONDS_IN_SECOND;
+
+            return openSegment(frameStopCount - STFT_INPUT_SAMPLES - preTriggerSamples, segment);
+
+        }
+
+    }
+
+    if (segmentOpen == false) return TR_NONE;
+
+    /* Close the segment once the post-trigger period has elapsed */
+
+    if (active == false && frameStopCount >= holdStopCount) return closeSegment(frameStopCount, segment);
+
+    /* Split long events so each segment can be written before the audio buffer wraps */
+
+    if (frameStopCount - segmentStartCount >= (int64_t)MAXIMUM_SEGMENT_DURATION * sampleRate) {
+
+        return closeSegment(frameStopCount, segment) | openSegment(frameStopCount, segment);
+
+    }
+
+    return TR_NONE;
+
+}
+
+int32_t Trigger_flush(int64_t stopCount, TR_segment_t *segment) {
+
+    Atomic_store32(&triggered, false);
+
+    return segmentOpen ? closeSegment(stopCount, segment) : TR_NONE;
+
+}
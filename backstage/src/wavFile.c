@@ -88,6 +88,16 @@ void WavFile_setHeaderDetails(WAV_header_t *header, uint32_t sampleRate, uint32_
 
 }
 
+void WavFile_setHeaderChannels(WAV_header_t *header, uint16_t numberOfChannels) {
+
+    /* Sample counts passed to the other functions then include every channel */
+
+    header->wavFormat.numberOfChannels = numberOfChannels;
+    header->wavFormat.bytesPerCapture = NUMBER_OF_BYTES_IN_SAMPLE * numberOfChannels;
+    header->wavFormat.bytesPerSecond = NUMBER_OF_BYTES_IN_SAMPLE * numberOfChannels * header->wavFormat.samplesPerSecond;
+
+}
+
 void WavFile_setHeaderComment(WAV_header_t *header, int32_t currentTime, int32_t milliseconds, int32_t timeOffset, char *deviceName) {
 
     struct tm time;
@@ -7,14 +7,37 @@
 #include "string.h"
 
 #include "xtime.h"
+#include "threads.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <errno.h>
+#endif
 
 /* Unit conversion constants */
 
+#define NANOSECONDS_IN_SECOND           1000000000
 #define NANOSECONDS_IN_MILLISECOND      1000000
 #define NANOSECONDS_IN_MICROSECOND      1000
+#define MICROSECONDS_IN_SECOND          1000000
 #define MILLISECONDS_IN_SECOND          1000
 #define SECONDS_IN_MINUTE               60
 
+/* Local time offset cache constants. The offset is packed below the expiry time so both can be read with a single atomic load */
+
+#define OFFSET_BITS                     20
+#define OFFSET_BIAS                     (1 << (OFFSET_BITS - 1))
+#define OFFSET_MASK                     ((1 << OFFSET_BITS) - 1)
+
+/* The cache expires at least once a minute so the time zone is re-read and a change of system time zone is picked up */
+
+#define TIME_ZONE_CHECK_INTERVAL        SECONDS_IN_MINUTE
+
+/* Local time offset cache */
+
+static volatile int64_t localTimeOffsetCache;
+
 /* Public function */
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -45,12 +68,78 @@
 
     }
 
+    int64_t Time_getMicrosecondUTC() {
+
+        struct timespec time;
+
+        timespec_get(&time, TIME_UTC);
+
+        int64_t microseconds = (int64_t)time.tv_sec * MICROSECONDS_IN_SECOND + (int64_t)time.tv_nsec / NANOSECONDS_IN_MICROSECOND;
+
+        return microseconds;
+
+    }
+
+    int64_t Time_getMonotonicMicroseconds(void) {
+
+        LARGE_INTEGER counter, frequency;
+
+        QueryPerformanceCounter(&counter);
+
+        QueryPerformanceFrequency(&frequency);
+
+        /* Split the conversion so the multiplication cannot overflow */
+
+        int64_t seconds = counter.QuadPart / frequency.QuadPart;
+
+        int64_t remainder = counter.QuadPart % frequency.QuadPart;
+
+        return seconds * MICROSECONDS_IN_SECOND + remainder * MICROSECONDS_IN_SECOND / frequency.QuadPart;
+
+    }
+
+    int64_t Time_getMonotonicNanoseconds(void) {
+
+        LARGE_INTEGER counter, frequency;
+
+        QueryPerformanceCounter(&counter);
+
+        QueryPerformanceFrequency(&frequency);
+
+        int64_t seconds = counter.QuadPart / frequency.QuadPart;
+
+        int64_t remainder = counter.QuadPart % frequency.QuadPart;
+
+        return seconds * NANOSECONDS_IN_SECOND + remainder * NANOSECONDS_IN_SECOND / frequency.QuadPart;
+
+    }
+
+    void Time_sleepUntilMonotonicMicroseconds(int64_t deadline) {
+
+        int64_t delay = deadline - Time_getMonotonicMicroseconds();
+
+        if (delay > 0) usleep(delay);
+
+    }
+
     void Time_gmTime(const time_t *timer, struct tm *buf) {
 
         gmtime_s(buf, timer);
 
     }
 
+    static void localTime(const time_t *timer, struct tm *buf) {
+
+        localtime_s(buf, timer);
+
+    }
+
+    static void updateTimeZone(void) {
+
+        _tzset();
+
+    }
+
 #else
 
     uint32_t Time_getMicroseconds(void) {
@@ -77,26 +166,146 @@
 
     }
 
+    int64_t Time_getMicrosecondUTC(void) {
+
+        struct timespec time;
+
+        clock_gettime(CLOCK_REALTIME, &time);
+
+        int64_t microseconds = (int64_t)time.tv_sec * MICROSECONDS_IN_SECOND + (int64_t)time.tv_nsec / NANOSECONDS_IN_MICROSECOND;
+
+        return microseconds;
+
+    }
+
+    int64_t Time_getMonotonicMicroseconds(void) {
+
+        struct timespec time;
+
+        clock_gettime(CLOCK_MONOTONIC, &time);
+
+        int64_t microseconds = (int64_t)time.tv_sec * MICROSECONDS_IN_SECOND + (int64_t)time.tv_nsec / NANOSECONDS_IN_MICROSECOND;
+
+        return microseconds;
+
+    }
+
+    int64_t Time_getMonotonicNanoseconds(void) {
+
+        struct timespec time;
+
+        clock_gettime(CLOCK_MONOTONIC, &time);
+
+        return (int64_t)time.tv_sec * NANOSECONDS_IN_SECOND + (int64_t)time.tv_nsec;
+
+    }
+
+    void Time_sleepUntilMonotonicMicroseconds(int64_t deadline) {
+
+        #if defined(__APPLE__)
+
+            /* No absolute sleep is available so sleep for the remaining interval */
+
+            int64_t delay = deadline - Time_getMonotonicMicroseconds();
+
+            if (delay <= 0) return;
+
+            struct timespec interval = {(time_t)(delay / MICROSECONDS_IN_SECOND), (long)(delay % MICROSECONDS_IN_SECOND) * NANOSECONDS_IN_MICROSECOND};
+
+            while (nanosleep(&interval, &interval) != 0 && errno == EINTR);
+
+        #else
+
+            struct timespec time = {(time_t)(deadline / MICROSECONDS_IN_SECOND), (long)(deadline % MICROSECONDS_IN_SECOND) * NANOSECONDS_IN_MICROSECOND};
+
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, NULL) == EINTR);
+
+        #endif
+
+    }
+
     void Time_gmTime(const time_t *timer, struct tm *buf) {
 
         gmtime_r(timer, buf);
 
     }
 
+    static void localTime(const time_t *timer, struct tm *buf) {
+
+        localtime_r(timer, buf);
+
+    }
+
+    static void updateTimeZone(void) {
+
+        tzset();
+
+    }
+
 #endif
 
+/* Private functions */
+
+static int32_t calculateLocalTimeOffset(time_t t) {
+
+    struct tm local;
+
+    localTime(&t, &local);
+
+    return (int32_t)(timegm(&local) - t);
+
+}
+
+/* Public functions */
+
 int32_t Time_getLocalTimeOffset(void) {
 
-    time_t t  = time (NULL);
+    time_t t = time(NULL);
+
+    /* Serve the cached offset until it expires at the next transition or time zone check */
+
+    int64_t cache = Atomic_load64(&localTimeOffsetCache);
+
+    if (cache != 0 && (int64_t)t < (cache >> OFFSET_BITS)) return (int32_t)(cache & OFFSET_MASK) - OFFSET_BIAS;
+
+    /* Re-read the time zone, recalculate the offset and search until the next check for a transition */
+
+    updateTimeZone();
 
-    struct tm *locg = localtime(&t);
+    int32_t timeOffset = calculateLocalTimeOffset(t);
 
-    struct tm locl;
+    time_t validUntil = t + TIME_ZONE_CHECK_INTERVAL;
 
-    memcpy(&locl, locg, sizeof(struct tm));
+    if (calculateLocalTimeOffset(validUntil) != timeOffset) {
 
-    int timeOffset = (int32_t)(timegm(locg) - mktime (&locl));
+        time_t low = t;
+
+        while (validUntil - low > 1) {
+
+            time_t middle = low + (validUntil - low) / 2;
+
+            if (calculateLocalTimeOffset(middle) == timeOffset) {
+
+                low = middle;
+
+            } else {
+
+                validUntil = middle;
+
+            }
+
+        }
+
+    }
+
+    Atomic_store64(&localTimeOffsetCache, ((int64_t)validUntil << OFFSET_BITS) | (int64_t)(timeOffset + OFFSET_BIAS));
 
     return timeOffset;
 
 }
+
+void Time_invalidateLocalTimeOffset(void) {
+
+    Atomic_store64(&localTimeOffsetCache, 0);
+
+}
@@ -736,7 +736,7 @@ function updateDisplay () {
 
     }
 
-    if (!resizing) plotter.update(audioBuffer, stftBuffer, plotter.UPDATE_BOTH, redraw, result.audioIndex, result.audioCount, displayWidth * currentSampleRate, nightMode.isEnabled(), lowAmpColourScaleEnabled, colourMapIndex);
+    if (!resizing && !result.processingSuspended) plotter.update(audioBuffer, stftBuffer, plotter.UPDATE_BOTH, redraw, result.audioIndex, result.audioCount, displayWidth * currentSampleRate, nightMode.isEnabled(), lowAmpColourScaleEnabled, colourMapIndex);
 
     // Update time display
 